@@ -0,0 +1,174 @@
+#define __STDC_FORMAT_MACROS
+
+// Allocation throughput of the DynamicInstruction/DynamicMicroOp pool allocator.
+//
+// Usage: allocbench [-t <threads>] [-n <allocations per thread>] [-w <window>]
+//
+// Each thread owns an allocator and keeps a window of live objects, similar to a ROB full of micro-ops.
+// In the local pattern, a thread frees its own objects. In the remote pattern, threads are paired up:
+// one allocates and hands its objects to the other one which frees them, as simulate() does in ROB-SMT.
+// TypedAllocator is compared to a pool allocator protected by a Lock (the previous implementation).
+
+#include "allocator.h"
+#include "lock.h"
+#include "bench_util.h"
+
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// About the size of a DynamicMicroOp
+struct BenchObject
+{
+   uint64_t payload[24];
+   BenchObject(uint64_t value) { payload[0] = value; }
+   static void operator delete(void* ptr) { Allocator::dealloc(ptr); }
+};
+
+template <typename T> class LockedAllocator : public Allocator
+{
+   private:
+      FSBAllocator_ElemAllocator<sizeof(DataElement) + sizeof(T), 0, T> m_alloc;
+      Lock m_lock;
+
+   public:
+      virtual void* alloc(size_t bytes)
+      {
+         ScopedLock sl(m_lock);
+         DataElement *elem = (DataElement *)m_alloc.allocate();
+         elem->allocator = this;
+         return elem->data;
+      }
+
+      virtual void _dealloc(void* ptr)
+      {
+         ScopedLock sl(m_lock);
+         m_alloc.deallocate((T*)ptr);
+      }
+};
+
+// Single-producer single-consumer handoff of objects between a pair of threads
+class Ring
+{
+   private:
+      static const size_t SIZE = 4096;
+      BenchObject *m_items[SIZE];
+      std::atomic<size_t> m_head, m_tail;
+
+   public:
+      Ring() : m_head(0), m_tail(0) {}
+
+      void push(BenchObject *item)
+      {
+         size_t tail = m_tail.load(std::memory_order_relaxed);
+         while (tail - m_head.load(std::memory_order_acquire) == SIZE)
+            std::this_thread::yield();
+         m_items[tail % SIZE] = item;
+         m_tail.store(tail + 1, std::memory_order_release);
+      }
+
+      BenchObject *pop()
+      {
+         size_t head = m_head.load(std::memory_order_relaxed);
+         while (m_tail.load(std::memory_order_acquire) == head)
+            std::this_thread::yield();
+         BenchObject *item = m_items[head % SIZE];
+         m_head.store(head + 1, std::memory_order_release);
+         return item;
+      }
+};
+
+static BenchObject *allocate(Allocator *alloc, uint64_t value)
+{
+   return new(alloc->alloc(sizeof(BenchObject))) BenchObject(value);
+}
+
+static void runLocal(Allocator *alloc, uint64_t count, uint64_t window)
+{
+   std::vector<BenchObject*> live(window);
+   for(uint64_t i = 0; i < count; i += window)
+   {
+      for(uint64_t j = 0; j < window; ++j)
+         live[j] = allocate(alloc, i + j);
+      for(uint64_t j = 0; j < window; ++j)
+         delete live[j];
+   }
+}
+
+static void runProducer(Allocator *alloc, Ring *ring, uint64_t count)
+{
+   for(uint64_t i = 0; i < count; ++i)
+      ring->push(allocate(alloc, i));
+}
+
+static void runConsumer(Ring *ring, uint64_t count)
+{
+   for(uint64_t i = 0; i < count; ++i)
+      delete ring->pop();
+}
+
+template <typename A> static double bench(bool remote, int num_threads, uint64_t count, uint64_t window)
+{
+   std::vector<A*> allocators;
+   std::vector<Ring*> rings;
+   std::vector<std::thread> threads;
+
+   double start = now();
+   for(int t = 0; t < num_threads; ++t)
+   {
+      allocators.push_back(new A());
+      if (remote)
+      {
+         rings.push_back(new Ring());
+         threads.push_back(std::thread(runProducer, allocators.back(), rings.back(), count));
+         threads.push_back(std::thread(runConsumer, rings.back(), count));
+      }
+      else
+         threads.push_back(std::thread(runLocal, allocators.back(), count, window));
+   }
+   for(std::thread &thread : threads)
+      thread.join();
+   double elapsed = now() - start;
+
+   for(A *alloc : allocators)
+      delete alloc;
+   for(Ring *ring : rings)
+      delete ring;
+
+   return count / elapsed;
+}
+
+int main(int argc, char* argv[])
+{
+   int num_threads = 1;
+   uint64_t count = 20000000;
+   uint64_t window = 128;
+   for(int i = 1; i < argc; ++i)
+   {
+      if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+         num_threads = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+         count = strtoull(argv[++i], NULL, 0);
+      else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+         window = strtoull(argv[++i], NULL, 0);
+      else
+      {
+         printf("Usage: %s [-t <threads>] [-n <allocations per thread>] [-w <window>]\n", argv[0]);
+         return 1;
+      }
+   }
+   count = (count + window - 1) / window * window;
+
+   printf("%d threads, %" PRIu64 " allocations per thread, window of %" PRIu64 "\n", num_threads, count, window);
+   printf("%-10s %-16s %16s\n", "pattern", "allocator", "Malloc/s/thread");
+   for(int remote = 0; remote < 2; ++remote)
+   {
+      const char *pattern = remote ? "remote" : "local";
+      printf("%-10s %-16s %16.2f\n", pattern, "locked", bench<LockedAllocator<BenchObject> >(remote, num_threads, count, window) / 1e6);
+      printf("%-10s %-16s %16.2f\n", pattern, "TypedAllocator", bench<TypedAllocator<BenchObject> >(remote, num_threads, count, window) / 1e6);
+   }
+}
@@ -0,0 +1,25 @@
+#ifndef __BENCH_UTIL_H
+#define __BENCH_UTIL_H
+
+// Helpers shared by the microbenchmarks in this directory
+
+#include "fixed_types.h"
+
+#include <sys/time.h>
+
+// Wall-clock time, in seconds
+static inline double now()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// Cheap deterministic pseudo-random numbers (64-bit LCG, upper bits only), so runs are repeatable
+static inline UInt64 nextRandom(UInt64 &seed)
+{
+   seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+   return seed >> 16;
+}
+
+#endif // __BENCH_UTIL_H
@@ -0,0 +1,137 @@
+#define __STDC_FORMAT_MACROS
+
+// Tag lookup throughput of the cache set layouts, for the caches of the gainestown.cfg hierarchy.
+//
+// Usage: cachebench [-n <lookups>] [-h <hit ratio>]
+//
+// The pointer layout is how CacheSet used to find a tag: one heap-allocated set per set index,
+// holding pointers to heap-allocated CacheBlockInfo objects whose tags are compared one by one.
+// The contiguous layout keeps the tags of all sets in one array, searched with searchCacheTag().
+
+#include "cache_block_info.h"
+#include "cache_tag_search.h"
+#include "bench_util.h"
+
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct CacheGeometry
+{
+   const char *name;
+   UInt32 size_kb;
+   UInt32 associativity;
+   CacheBase::cache_t cache_type;
+};
+
+// From gainestown.cfg (and nehalem.cfg which it includes), all with 64-byte lines
+static const CacheGeometry caches[] = {
+   { "L1-D", 32,   8,  CacheBase::PR_L1_CACHE },
+   { "L2",   256,  8,  CacheBase::PR_L2_CACHE },
+   { "L3",   8192, 16, CacheBase::SHARED_CACHE },
+};
+static const UInt32 BLOCKSIZE = 64;
+
+struct PointerSet
+{
+   CacheBlockInfo** blocks;
+};
+
+int main(int argc, char* argv[])
+{
+   UInt64 num_lookups = 50000000;
+   double hit_ratio = .9;
+   for(int i = 1; i < argc; ++i)
+   {
+      if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+         num_lookups = strtoull(argv[++i], NULL, 0);
+      else if (strcmp(argv[i], "-h") == 0 && i + 1 < argc)
+         hit_ratio = atof(argv[++i]);
+      else
+      {
+         printf("Usage: %s [-n <lookups>] [-h <hit ratio>]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   printf("%" PRIu64 " lookups per cache, %.0f%% hits\n", num_lookups, 100 * hit_ratio);
+   printf("%-6s %8s %6s %16s %16s %8s\n", "cache", "sets", "ways", "pointer Ml/s", "contiguous Ml/s", "speedup");
+
+   for(const CacheGeometry &geometry : caches)
+   {
+      UInt32 num_sets = geometry.size_kb * 1024 / BLOCKSIZE / geometry.associativity;
+      UInt32 associativity = geometry.associativity;
+
+      // Fill both layouts with the same, distinct, tags
+      std::vector<PointerSet*> pointer_sets(num_sets);
+      std::vector<IntPtr> tags(num_sets * associativity);
+      UInt64 seed = 1;
+      for(UInt32 set = 0; set < num_sets; ++set)
+      {
+         pointer_sets[set] = new PointerSet;
+         pointer_sets[set]->blocks = new CacheBlockInfo*[associativity];
+         for(UInt32 way = 0; way < associativity; ++way)
+         {
+            IntPtr tag = (nextRandom(seed) & ~0xffffull) | (set * associativity + way);
+            pointer_sets[set]->blocks[way] = CacheBlockInfo::create(geometry.cache_type);
+            pointer_sets[set]->blocks[way]->setTag(tag);
+            tags[set * associativity + way] = tag;
+         }
+      }
+
+      // Lookups at random sets, hitting a random way or missing
+      std::vector<std::pair<UInt32, IntPtr> > lookups(1 << 20);
+      for(auto &lookup : lookups)
+      {
+         lookup.first = nextRandom(seed) % num_sets;
+         if (nextRandom(seed) % 1000 < hit_ratio * 1000)
+            lookup.second = tags[lookup.first * associativity + nextRandom(seed) % associativity];
+         else
+            lookup.second = nextRandom(seed) | 0xffff;
+      }
+
+      UInt64 hits_pointer = 0, hits_contiguous = 0;
+
+      double start = now();
+      for(UInt64 i = 0; i < num_lookups; ++i)
+      {
+         const auto &lookup = lookups[i & (lookups.size() - 1)];
+         CacheBlockInfo **blocks = pointer_sets[lookup.first]->blocks;
+         for(SInt32 way = associativity - 1; way >= 0; --way)
+            if (blocks[way]->getTag() == lookup.second)
+            {
+               ++hits_pointer;
+               break;
+            }
+      }
+      double time_pointer = now() - start;
+
+      start = now();
+      for(UInt64 i = 0; i < num_lookups; ++i)
+      {
+         const auto &lookup = lookups[i & (lookups.size() - 1)];
+         if (searchCacheTag(&tags[lookup.first * associativity], associativity, lookup.second) >= 0)
+            ++hits_contiguous;
+      }
+      double time_contiguous = now() - start;
+
+      if (hits_pointer != hits_contiguous)
+      {
+         fprintf(stderr, "%s: layouts disagree, %" PRIu64 " vs %" PRIu64 " hits\n", geometry.name, hits_pointer, hits_contiguous);
+         return 1;
+      }
+
+      printf("%-6s %8u %6u %16.1f %16.1f %7.2fx\n", geometry.name, num_sets, associativity,
+         num_lookups / time_pointer / 1e6, num_lookups / time_contiguous / 1e6, time_pointer / time_contiguous);
+
+      for(PointerSet *set : pointer_sets)
+      {
+         for(UInt32 way = 0; way < associativity; ++way)
+            delete set->blocks[way];
+         delete [] set->blocks;
+         delete set;
+      }
+   }
+}
@@ -0,0 +1,152 @@
+#define __STDC_FORMAT_MACROS
+
+// Message throughput of the SmTransport node queues.
+//
+// Usage: pingpong [-n <messages>] [-s <message size>] [-p <senders>] [-c <spin count>]
+//
+// In the ping-pong pattern, two threads bounce a message back and forth, each receiving on its own queue,
+// like a cache miss request and its reply. In the fan-in pattern, a number of sender threads stream messages
+// to one receiver, like the cores of a coherence-heavy workload sending to one directory tile.
+// MessageRing is compared to a std::queue of heap copies protected by a Lock and ConditionVariable
+// (the previous SmTransport::SmNode implementation).
+
+#include "message_ring.h"
+#include "lock.h"
+#include "cond.h"
+#include "bench_util.h"
+
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class LockedQueue
+{
+   private:
+      std::queue<Byte*> m_queue;
+      Lock m_lock;
+      ConditionVariable m_cond;
+
+   public:
+      void push(const void *buffer, UInt32 length)
+      {
+         Byte *data = new Byte[length];
+         memcpy(data, buffer, length);
+         m_lock.acquire();
+         m_queue.push(data);
+         m_lock.release();
+         m_cond.broadcast();
+      }
+
+      Byte* pop(bool block)
+      {
+         ScopedLock sl(m_lock);
+         while (m_queue.empty())
+            m_cond.wait(m_lock);
+         Byte *data = m_queue.front();
+         m_queue.pop();
+         return data;
+      }
+
+      void release(Byte *buffer)
+      {
+         delete [] buffer;
+      }
+};
+
+static uint64_t spin_count = 1000;
+
+class Ring : public MessageRing
+{
+   public:
+      Ring() : MessageRing(spin_count) {}
+};
+
+template <typename Q> static void runPingPong(Q *inbox, Q *outbox, uint64_t count, uint32_t size, bool serve)
+{
+   std::vector<Byte> message(size, 0);
+   if (!serve)
+      outbox->push(&message[0], size);
+   for(uint64_t i = 0; i < count; ++i)
+   {
+      Byte *data = inbox->pop(true);
+      memcpy(&message[0], data, size);
+      inbox->release(data);
+      if (serve || i + 1 < count)
+         outbox->push(&message[0], size);
+   }
+}
+
+template <typename Q> static void runSender(Q *queue, uint64_t count, uint32_t size)
+{
+   std::vector<Byte> message(size, 0);
+   for(uint64_t i = 0; i < count; ++i)
+      queue->push(&message[0], size);
+}
+
+template <typename Q> static void runReceiver(Q *queue, uint64_t count)
+{
+   for(uint64_t i = 0; i < count; ++i)
+      queue->release(queue->pop(true));
+}
+
+// Returns messages per second
+template <typename Q> static double benchPingPong(uint64_t count, uint32_t size)
+{
+   Q a, b;
+   double start = now();
+   std::thread server(runPingPong<Q>, &b, &a, count, size, true);
+   runPingPong<Q>(&a, &b, count, size, false);
+   server.join();
+   return 2 * count / (now() - start);
+}
+
+template <typename Q> static double benchFanIn(uint64_t count, uint32_t size, int num_senders)
+{
+   Q queue;
+   std::vector<std::thread> threads;
+   double start = now();
+   for(int t = 0; t < num_senders; ++t)
+      threads.push_back(std::thread(runSender<Q>, &queue, count / num_senders, size));
+   runReceiver<Q>(&queue, count / num_senders * num_senders);
+   for(std::thread &thread : threads)
+      thread.join();
+   return count / (now() - start);
+}
+
+int main(int argc, char* argv[])
+{
+   uint64_t count = 2000000;
+   uint32_t size = 160;
+   int num_senders = 4;
+   for(int i = 1; i < argc; ++i)
+   {
+      if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+         count = strtoull(argv[++i], NULL, 0);
+      else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+         size = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+         num_senders = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+         spin_count = strtoull(argv[++i], NULL, 0);
+      else
+      {
+         printf("Usage: %s [-n <messages>] [-s <message size>] [-p <senders>] [-c <spin count>]\n", argv[0]);
+         return 1;
+      }
+   }
+   // As in SmTransport, spinning on a single host core only delays the sender
+   if (std::thread::hardware_concurrency() < 2)
+      spin_count = 0;
+
+   printf("%" PRIu64 " messages of %u bytes, %d senders for fan-in, spin count %" PRIu64 "\n", count, size, num_senders, spin_count);
+   printf("%-10s %12s %12s %9s\n", "pattern", "locked Mm/s", "ring Mm/s", "speedup");
+   double locked = benchPingPong<LockedQueue>(count, size), ring = benchPingPong<Ring>(count, size);
+   printf("%-10s %12.2f %12.2f %8.2fx\n", "ping-pong", locked / 1e6, ring / 1e6, ring / locked);
+   locked = benchFanIn<LockedQueue>(count, size, num_senders);
+   ring = benchFanIn<Ring>(count, size, num_senders);
+   printf("%-10s %12.2f %12.2f %8.2fx\n", "fan-in", locked / 1e6, ring / 1e6, ring / locked);
+}
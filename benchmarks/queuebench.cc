@@ -0,0 +1,222 @@
+#define __STDC_FORMAT_MACROS
+
+// Throughput of the history_list queue model's free interval list.
+//
+// Usage: queuebench [-n <requests>] [-s <max list size>] [-m <min processing time (fs)>] [<recorded stream>...]
+//
+// Each stream of (pkt_time, processing_time) requests is replayed against FreeIntervalList and against
+// the std::list implementation QueueModelHistoryList used before, checking that both compute the same delays.
+// A recorded stream is a sim.log with the HistoryList messages of queue_model_history_list.cc enabled
+// (lines containing "pkt_time(T:<fs>), processing_time(T:<fs>)"), or a text file with one "<pkt_time> <processing_time>"
+// pair of femtosecond values per line. Without recorded streams, synthetic ones are generated: requests from a number
+// of cores that are at most one barrier quantum apart, as seen by a network link or DRAM controller.
+
+#include "free_interval_list.h"
+#include "bench_util.h"
+
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <vector>
+
+typedef std::pair<SubsecondTime, SubsecondTime> Request;
+
+// QueueModelHistoryList::computeUsingHistoryList as it was before FreeIntervalList
+class ListHistory
+{
+   private:
+      typedef std::list<std::pair<SubsecondTime,SubsecondTime> > FreeIntervalList;
+      FreeIntervalList m_free_interval_list;
+      UInt32 m_max_free_interval_list_size;
+      SubsecondTime m_min_processing_time;
+
+   public:
+      ListHistory(UInt32 max_size, SubsecondTime min_processing_time)
+         : m_max_free_interval_list_size(max_size)
+         , m_min_processing_time(min_processing_time)
+      {
+         m_free_interval_list.push_back(std::pair<SubsecondTime,SubsecondTime>(SubsecondTime::Zero(), SubsecondTime::FS() << 63));
+      }
+
+      SubsecondTime allocate(SubsecondTime pkt_time, SubsecondTime processing_time)
+      {
+         SubsecondTime queue_delay = SubsecondTime::MaxTime();
+
+         FreeIntervalList::iterator curr_it;
+         for (curr_it = m_free_interval_list.begin(); curr_it != m_free_interval_list.end(); curr_it ++)
+         {
+            std::pair<SubsecondTime,SubsecondTime> interval = (*curr_it);
+
+            if ((pkt_time >= interval.first) && ((pkt_time + processing_time) <= interval.second))
+            {
+               queue_delay = SubsecondTime::Zero();
+               curr_it = m_free_interval_list.erase(curr_it);
+               if ((pkt_time - interval.first) >= m_min_processing_time)
+                  m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first, pkt_time));
+               if ((interval.second - (pkt_time + processing_time)) >= m_min_processing_time)
+                  m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(pkt_time + processing_time, interval.second));
+               break;
+            }
+            else if (pkt_time < interval.first)
+            {
+               queue_delay = interval.first - pkt_time;
+               curr_it = m_free_interval_list.erase(curr_it);
+               if ((interval.second - (interval.first + processing_time)) >= m_min_processing_time)
+                  m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first + processing_time, interval.second));
+               break;
+            }
+         }
+
+         if (m_free_interval_list.size() > m_max_free_interval_list_size)
+            m_free_interval_list.erase(m_free_interval_list.begin());
+
+         return queue_delay;
+      }
+};
+
+static std::vector<Request> readStream(const char *filename)
+{
+   std::vector<Request> requests;
+   FILE *fp = fopen(filename, "r");
+   if (!fp)
+   {
+      fprintf(stderr, "Cannot open %s\n", filename);
+      exit(1);
+   }
+   char line[4096];
+   while (fgets(line, sizeof(line), fp))
+   {
+      uint64_t pkt_time, processing_time;
+      const char *log = strstr(line, "pkt_time(T:");
+      if ((log && sscanf(log, "pkt_time(T:%" SCNu64 "), processing_time(T:%" SCNu64 ")", &pkt_time, &processing_time) == 2)
+          || (!log && sscanf(line, "%" SCNu64 " %" SCNu64, &pkt_time, &processing_time) == 2))
+         requests.push_back(Request(SubsecondTime::FS(pkt_time), SubsecondTime::FS(processing_time)));
+   }
+   fclose(fp);
+   return requests;
+}
+
+// Requests from num_cores cores, each advancing in time independently but kept within one quantum of each other
+static std::vector<Request> syntheticStream(UInt64 count, UInt32 num_cores, SubsecondTime processing_time, double load, UInt64 seed)
+{
+   std::vector<Request> requests;
+   std::vector<SubsecondTime> core_time(num_cores, SubsecondTime::Zero());
+   SubsecondTime quantum = SubsecondTime::NS(100);
+   SubsecondTime barrier = quantum;
+   // Mean time between requests per core, for the requested utilization of the queue
+   UInt64 gap = processing_time.getFS() * num_cores / load;
+   while (requests.size() < count)
+   {
+      UInt32 core = nextRandom(seed) % num_cores;
+      if (core_time[core] >= barrier)
+      {
+         bool all = true;
+         for(UInt32 i = 0; i < num_cores; ++i)
+            all &= core_time[i] >= barrier;
+         if (all)
+            barrier += quantum;
+         continue;
+      }
+      core_time[core] += SubsecondTime::FS(nextRandom(seed) % (2 * gap + 1));
+      // Mostly minimum-size packets, some longer ones (e.g. data replies)
+      SubsecondTime length = nextRandom(seed) % 4 == 0 ? processing_time * (1 + nextRandom(seed) % 8) : processing_time;
+      requests.push_back(Request(core_time[core], length));
+   }
+   return requests;
+}
+
+static bool replay(const char *name, const std::vector<Request> &requests, UInt64 num_requests, UInt32 max_size, SubsecondTime min_processing_time)
+{
+   // Repeat the stream until we have num_requests, shifting it forward in time each round
+   SubsecondTime span = requests.back().first + requests.back().second;
+   std::vector<SubsecondTime> delays_list, delays_ring;
+   delays_list.reserve(num_requests);
+   delays_ring.reserve(num_requests);
+
+   ListHistory list(max_size, min_processing_time);
+   double start = now();
+   for(UInt64 i = 0; i < num_requests; ++i)
+   {
+      const Request &request = requests[i % requests.size()];
+      delays_list.push_back(list.allocate(request.first + span * (i / requests.size()), request.second));
+   }
+   double time_list = now() - start;
+
+   FreeIntervalList ring(max_size, min_processing_time, FreeIntervalList::Interval(SubsecondTime::Zero(), SubsecondTime::FS() << 63));
+   start = now();
+   for(UInt64 i = 0; i < num_requests; ++i)
+   {
+      const Request &request = requests[i % requests.size()];
+      delays_ring.push_back(ring.allocate(request.first + span * (i / requests.size()), request.second));
+   }
+   double time_ring = now() - start;
+
+   for(UInt64 i = 0; i < num_requests; ++i)
+      if (delays_list[i] != delays_ring[i])
+      {
+         fprintf(stderr, "%s: request %" PRIu64 " has delay %" PRIu64 " fs with std::list, %" PRIu64 " fs with FreeIntervalList\n",
+            name, i, delays_list[i].getFS(), delays_ring[i].getFS());
+         return false;
+      }
+
+   printf("%-24s %12.2f %12.2f %8.2fx\n", name, num_requests / time_list / 1e6, num_requests / time_ring / 1e6, time_list / time_ring);
+   return true;
+}
+
+int main(int argc, char* argv[])
+{
+   UInt64 num_requests = 10000000;
+   UInt32 max_size = 100;
+   SubsecondTime min_processing_time = SubsecondTime::NS(1);
+   std::vector<const char*> filenames;
+   for(int i = 1; i < argc; ++i)
+   {
+      if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+         num_requests = strtoull(argv[++i], NULL, 0);
+      else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+         max_size = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+         min_processing_time = SubsecondTime::FS(strtoull(argv[++i], NULL, 0));
+      else if (argv[i][0] != '-')
+         filenames.push_back(argv[i]);
+      else
+      {
+         printf("Usage: %s [-n <requests>] [-s <max list size>] [-m <min processing time (fs)>] [<recorded stream>...]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   printf("%" PRIu64 " requests per stream, max_list_size = %u, min processing time %" PRIu64 " fs\n", num_requests, max_size, min_processing_time.getFS());
+   printf("%-24s %12s %12s %9s\n", "stream", "list Mreq/s", "ring Mreq/s", "speedup");
+
+   bool ok = true;
+   if (filenames.size())
+   {
+      for(const char *filename : filenames)
+      {
+         std::vector<Request> requests = readStream(filename);
+         if (requests.size() == 0)
+            fprintf(stderr, "%s: no requests found\n", filename);
+         else
+            ok &= replay(filename, requests, num_requests, max_size, min_processing_time);
+      }
+   }
+   else
+   {
+      static const struct { const char *name; UInt32 num_cores; double load; } streams[] = {
+         { "4 cores, 30% load", 4, .3 },
+         { "16 cores, 70% load", 16, .7 },
+         { "64 cores, 95% load", 64, .95 },
+         { "64 cores, 150% load", 64, 1.5 },
+      };
+      for(unsigned int i = 0; i < sizeof(streams) / sizeof(streams[0]); ++i)
+      {
+         std::vector<Request> requests = syntheticStream(1 << 20, streams[i].num_cores, min_processing_time, streams[i].load, i + 1);
+         ok &= replay(streams[i].name, requests, num_requests, max_size, min_processing_time);
+      }
+   }
+
+   return ok ? 0 : 1;
+}
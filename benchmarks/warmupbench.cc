@@ -0,0 +1,200 @@
+#define __STDC_FORMAT_MACROS
+
+// Throughput of the L1-D hit path of batched functional warmup (CacheCntlr::processWarmupFromCore).
+//
+// Usage: warmupbench [-n <accesses>]
+//
+// Only the hit path can be measured outside of a full simulation: misses go through processMemOpFromCore and
+// the rest of the hierarchy, which this benchmark does not model. All accesses hit in a 32 KB, 8-way L1-D
+// (gainestown.cfg) that holds the working set. Each access does what the hit path does: find the tag, check
+// the coherence state, and update LRU. Two ways of protecting it are compared:
+//  - locked: SMT lock and shared set lock around every lookup, unless the previous access was to the same line
+//  - optimistic: SMT lock held across the batch, lock-free lookup validated against the set lock's sequence
+//    number, same-line shortcut validated the same way
+// Access patterns are 8-byte accesses, one in four a store: streaming through the working set (eight accesses
+// per line, so mostly same-line), and random within it.
+
+#include "cache_tag_search.h"
+#include "setlock.h"
+#include "lock.h"
+#include "bench_util.h"
+
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const UInt32 BLOCKSIZE = 64;
+static const UInt32 NUM_SETS = 64;
+static const UInt32 ASSOCIATIVITY = 8;
+static const UInt32 WORKING_SET = 16 * 1024;
+
+struct Access
+{
+   IntPtr address;
+   bool write;
+};
+
+class L1
+{
+   private:
+      std::vector<IntPtr> m_tags;
+      std::vector<UInt8> m_lru;
+      std::vector<bool> m_writable;
+
+   public:
+      L1() : m_tags(NUM_SETS * ASSOCIATIVITY, ~IntPtr(0)), m_lru(NUM_SETS * ASSOCIATIVITY), m_writable(NUM_SETS * ASSOCIATIVITY)
+      {
+         for(UInt32 way = 0; way < NUM_SETS * ASSOCIATIVITY; ++way)
+            m_lru[way] = way % ASSOCIATIVITY;
+      }
+
+      static UInt32 getSet(IntPtr line) { return line % NUM_SETS; }
+
+      void insert(IntPtr line, bool writable)
+      {
+         UInt32 set = getSet(line);
+         for(UInt32 way = 0; way < ASSOCIATIVITY; ++way)
+            if (m_lru[set * ASSOCIATIVITY + way] == ASSOCIATIVITY - 1)
+            {
+               m_tags[set * ASSOCIATIVITY + way] = line;
+               m_writable[set * ASSOCIATIVITY + way] = writable;
+               touch(set, way);
+               return;
+            }
+      }
+
+      // Returns the way, or -1 if the access does not hit (not present, or a store to a read-only line)
+      SInt32 probe(IntPtr line, bool write)
+      {
+         UInt32 set = getSet(line);
+         SInt32 way = searchCacheTag(&m_tags[set * ASSOCIATIVITY], ASSOCIATIVITY, line);
+         if (way < 0 || (write && !m_writable[set * ASSOCIATIVITY + way]))
+            return -1;
+         return way;
+      }
+
+      void touch(UInt32 set, UInt32 way)
+      {
+         UInt8 *lru = &m_lru[set * ASSOCIATIVITY];
+         for(UInt32 i = 0; i < ASSOCIATIVITY; ++i)
+            if (lru[i] < lru[way])
+               ++lru[i];
+         lru[way] = 0;
+      }
+};
+
+static UInt64 runLocked(L1 &l1, Lock &smt_lock, std::vector<SetLock> &setlocks, const std::vector<Access> &accesses)
+{
+   UInt64 hits = 0;
+   IntPtr last_line = ~IntPtr(0);
+   bool last_writable = false;
+   for(const Access &access : accesses)
+   {
+      IntPtr line = access.address / BLOCKSIZE;
+      if (line == last_line && (!access.write || last_writable))
+      {
+         ++hits;
+         continue;
+      }
+      ScopedLock sl_smt(smt_lock);
+      SetLock &setlock = setlocks[L1::getSet(line)];
+      setlock.acquire_shared(0);
+      SInt32 way = l1.probe(line, access.write);
+      if (way >= 0)
+      {
+         l1.touch(L1::getSet(line), way);
+         ++hits;
+         last_line = line;
+         last_writable = l1.probe(line, true) >= 0;
+      }
+      setlock.release_shared(0);
+   }
+   return hits;
+}
+
+static UInt64 runOptimistic(L1 &l1, Lock &smt_lock, std::vector<SetLock> &setlocks, const std::vector<Access> &accesses)
+{
+   UInt64 hits = 0;
+   IntPtr last_line = ~IntPtr(0);
+   bool last_writable = false;
+   SetLock *last_setlock = NULL;
+   UInt32 last_seq = 0;
+   ScopedLock sl_smt(smt_lock);
+   for(const Access &access : accesses)
+   {
+      IntPtr line = access.address / BLOCKSIZE;
+      if (line == last_line && last_setlock->read_validate(last_seq) && (!access.write || last_writable))
+      {
+         ++hits;
+         continue;
+      }
+      SetLock *setlock = &setlocks[L1::getSet(line)];
+      UInt32 seq = setlock->read_begin();
+      SInt32 way = l1.probe(line, access.write);
+      if (way >= 0 && setlock->read_validate(seq))
+      {
+         l1.touch(L1::getSet(line), way);
+         ++hits;
+         last_line = line;
+         last_writable = l1.probe(line, true) >= 0;
+         last_setlock = setlock;
+         last_seq = seq;
+      }
+   }
+   return hits;
+}
+
+int main(int argc, char* argv[])
+{
+   UInt64 num_accesses = 50000000;
+   for(int i = 1; i < argc; ++i)
+   {
+      if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+         num_accesses = strtoull(argv[++i], NULL, 0);
+      else
+      {
+         printf("Usage: %s [-n <accesses>]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   L1 l1;
+   for(IntPtr address = 0; address < WORKING_SET; address += BLOCKSIZE)
+      l1.insert(address / BLOCKSIZE, true);
+   Lock smt_lock;
+   std::vector<SetLock> setlocks(NUM_SETS, SetLock(0, 1));
+
+   const char *patterns[] = { "stream", "random" };
+   printf("%" PRIu64 " accesses, all hits\n", num_accesses);
+   printf("%-8s %16s %16s %8s\n", "pattern", "locked Ma/s", "optimistic Ma/s", "speedup");
+
+   for(UInt32 pattern = 0; pattern < 2; ++pattern)
+   {
+      std::vector<Access> accesses(num_accesses);
+      UInt64 seed = 1;
+      for(UInt64 i = 0; i < num_accesses; ++i)
+      {
+         accesses[i].address = pattern == 0 ? (i * 8) % WORKING_SET : (nextRandom(seed) % WORKING_SET) & ~IntPtr(7);
+         accesses[i].write = i % 4 == 3;
+      }
+
+      double start = now();
+      UInt64 hits_locked = runLocked(l1, smt_lock, setlocks, accesses);
+      double time_locked = now() - start;
+
+      start = now();
+      UInt64 hits_optimistic = runOptimistic(l1, smt_lock, setlocks, accesses);
+      double time_optimistic = now() - start;
+
+      if (hits_locked != num_accesses || hits_optimistic != num_accesses)
+      {
+         fprintf(stderr, "%s: expected only hits, got %" PRIu64 " and %" PRIu64 "\n", patterns[pattern], hits_locked, hits_optimistic);
+         return 1;
+      }
+
+      printf("%-8s %16.1f %16.1f %7.2fx\n", patterns[pattern],
+         num_accesses / time_locked / 1e6, num_accesses / time_optimistic / 1e6, time_locked / time_optimistic);
+   }
+}
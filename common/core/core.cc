@@ -16,6 +16,8 @@
 #include "stats.h"
 #include "topology_info.h"
 #include "cheetah_manager.h"
+#include "reuse_profiler.h"
+#include "pim_profiler.h"
 
 #include <cstring>
 
@@ -71,6 +73,8 @@ Core::Core(SInt32 id)
    , m_bbv(id)
    , m_topology_info(new TopologyInfo(id))
    , m_cheetah_manager(Sim()->getCfg()->getBool("core/cheetah/enabled") ? new CheetahManager(id) : NULL)
+   , m_pim_profiler(PimProfiler::create(id))
+   , m_reuse_profiler(ReuseProfiler::create(this))
    , m_core_state(Core::IDLE)
    , m_icache_last_block(-1)
    , m_spin_loops(0)
@@ -108,6 +112,10 @@ Core::~Core()
 {
    if (m_cheetah_manager)
       delete m_cheetah_manager;
+   if (m_pim_profiler)
+      delete m_pim_profiler;
+   if (m_reuse_profiler)
+      delete m_reuse_profiler;
    delete m_topology_info;
    delete m_memory_manager;
    delete m_shmem_perf_model;
@@ -264,6 +272,8 @@ void Core::accessMemoryFast(bool icache, mem_op_t mem_op_type, IntPtr address)
 {
    if (m_cheetah_manager && icache == false)
       m_cheetah_manager->access(mem_op_type, address);
+   if (m_reuse_profiler && icache == false)
+      m_reuse_profiler->access(address);
 
    SubsecondTime latency = getMemoryManager()->coreInitiateMemoryAccessFast(icache, mem_op_type, address);
 
@@ -271,6 +281,56 @@ void Core::accessMemoryFast(bool icache, mem_op_t mem_op_type, IntPtr address)
       m_performance_model->handleMemoryLatency(latency, HitWhere::MISS);
 }
 
+void Core::profileMemory(IntPtr address)
+{
+   if (m_reuse_profiler)
+      m_reuse_profiler->access(address);
+}
+
+void Core::warmupMemory(const WarmupAccess *accesses, UInt32 count)
+{
+   ScopedLock sl(m_mem_lock);
+
+   // Caches and TLBs use the current time for their replacement state, it doesn't change during the batch
+   getShmemPerfModel()->setElapsedTime(ShmemPerfModel::_USER_THREAD, getPerformanceModel()->getElapsedTime());
+
+   m_warmup_lines.clear();
+   if (m_cheetah_manager || m_reuse_profiler || m_pim_profiler)
+   {
+      UInt32 cache_block_size = getMemoryManager()->getCacheBlockSize();
+      for(UInt32 idx = 0; idx < count; ++idx)
+      {
+         if (accesses[idx].size == 0)
+            continue;
+         IntPtr begin_addr_aligned = accesses[idx].address & ~IntPtr(cache_block_size - 1);
+         IntPtr end_addr_aligned = (accesses[idx].address + accesses[idx].size - 1) & ~IntPtr(cache_block_size - 1);
+         for(IntPtr curr_addr_aligned = begin_addr_aligned; curr_addr_aligned <= end_addr_aligned; curr_addr_aligned += cache_block_size)
+         {
+            if (m_cheetah_manager)
+               m_cheetah_manager->access(accesses[idx].mem_op_type, curr_addr_aligned);
+            if (m_reuse_profiler)
+               m_reuse_profiler->access(curr_addr_aligned);
+            if (m_pim_profiler)
+               m_warmup_lines.push_back(curr_addr_aligned);
+         }
+      }
+   }
+
+   if (m_pim_profiler)
+   {
+      // The memory manager reports where each line was found, in the same order
+      m_warmup_hit_where.resize(m_warmup_lines.size());
+      getMemoryManager()->coreWarmupMemory(accesses, count, m_warmup_hit_where.data());
+
+      // Warmup accesses are not timed, as with MEM_MODELED_COUNT through initiateMemoryAccess
+      SubsecondTime now = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+      for(UInt32 idx = 0; idx < m_warmup_lines.size(); ++idx)
+         m_pim_profiler->access(m_warmup_lines[idx], m_warmup_hit_where[idx], now, SubsecondTime::Zero());
+   }
+   else
+      getMemoryManager()->coreWarmupMemory(accesses, count);
+}
+
 MemoryResult
 Core::initiateMemoryAccess(MemComponent::component_t mem_component,
       lock_signal_t lock_signal,
@@ -361,6 +421,14 @@ Core::initiateMemoryAccess(MemComponent::component_t mem_component,
 
       if (m_cheetah_manager)
          m_cheetah_manager->access(mem_op_type, curr_addr_aligned);
+      if (m_reuse_profiler && mem_component == MemComponent::L1_DCACHE)
+         m_reuse_profiler->access(curr_addr_aligned);
+
+      // Only read the clock when the PIM profiler wants this line's latency
+      bool pim_profile = m_pim_profiler && mem_component == MemComponent::L1_DCACHE && modeled != MEM_MODELED_NONE;
+      SubsecondTime line_start = SubsecondTime::Zero();
+      if (pim_profile)
+         line_start = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
 
       HitWhere::where_t this_hit_where = getMemoryManager()->coreInitiateMemoryAccess(
                mem_component,
@@ -370,6 +438,10 @@ Core::initiateMemoryAccess(MemComponent::component_t mem_component,
                data_buf ? curr_data_buffer_head : NULL, curr_size,
                modeled);
 
+      if (pim_profile)
+         m_pim_profiler->access(curr_addr_aligned, this_hit_where, line_start,
+                                getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD) - line_start);
+
       if (hit_where != (HitWhere::where_t)mem_component)
       {
          // If it is a READ or READ_EX operation,
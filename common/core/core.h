@@ -11,6 +11,8 @@ class ClockSkewMinimizationClient;
 class ShmemPerfModel;
 class TopologyInfo;
 class CheetahManager;
+class PimProfiler;
+class ReuseProfiler;
 
 #include "mem_component.h"
 #include "fixed_types.h"
@@ -21,6 +23,8 @@ class CheetahManager;
 #include "cpuid.h"
 #include "hit_where.h"
 
+#include <vector>
+
 struct MemoryResult {
    HitWhere::where_t hit_where;
    subsecond_time_t latency;
@@ -78,6 +82,14 @@ class Core
          MEM_MODELED_RETURN,    /* Count + time + return data to construct DynamicInstruction */
       };
 
+      /* Data access for functional cache warmup, see warmupMemory() */
+      struct WarmupAccess
+      {
+         IntPtr address;
+         UInt32 size;
+         mem_op_t mem_op_type;
+      };
+
       static const char * CoreStateString(State state);
 
       Core(SInt32 id);
@@ -93,6 +105,11 @@ class Core
       MemoryResult nativeMemOp(lock_signal_t lock_signal, mem_op_t mem_op_type, IntPtr d_addr, char* data_buffer, UInt32 data_size);
 
       void accessMemoryFast(bool icache, mem_op_t mem_op_type, IntPtr address);
+      // Functional warmup of the TLBs and data caches with a batch of accesses, in order (cache-only mode).
+      // Counts the accesses like MEM_MODELED_COUNT would, but no latency is computed or reported.
+      void warmupMemory(const WarmupAccess *accesses, UInt32 count);
+      // Data access in fast-forward mode, only seen by the reuse profiler (if any)
+      void profileMemory(IntPtr address);
 
       void logMemoryHit(bool icache, mem_op_t mem_op_type, IntPtr address, MemModeled modeled = MEM_MODELED_NONE, IntPtr eip = 0);
       bool countInstructions(IntPtr address, UInt32 count);
@@ -113,6 +130,7 @@ class Core
       TopologyInfo* getTopologyInfo() { return m_topology_info; }
       const TopologyInfo* getTopologyInfo() const { return m_topology_info; }
       const CheetahManager* getCheetahManager() const { return m_cheetah_manager; }
+      ReuseProfiler* getReuseProfiler() { return m_reuse_profiler; }
 
       State getState() const { return m_core_state; }
       void setState(State core_state) { m_core_state = core_state; }
@@ -146,6 +164,11 @@ class Core
       BbvCount m_bbv;
       TopologyInfo *m_topology_info;
       CheetahManager *m_cheetah_manager;
+      PimProfiler *m_pim_profiler;
+      ReuseProfiler *m_reuse_profiler;
+      // Scratch space for warmupMemory: the cache lines of a batch and where they were found, for the PIM profiler
+      std::vector<IntPtr> m_warmup_lines;
+      std::vector<HitWhere::where_t> m_warmup_hit_where;
 
       State m_core_state;
 
@@ -1,5 +1,9 @@
 #include "simulator.h"
 #include "cache.h"
+#include "cache_set_lru.h"
+#include "cache_set_nru.h"
+#include "cache_set_plru.h"
+#include "cache_set_srrip.h"
 #include "log.h"
 
 // Cache class
@@ -22,20 +26,31 @@ Cache::Cache(
    m_num_accesses(0),
    m_num_hits(0),
    m_cache_type(cache_type),
+   m_replacement_policy(replacement_policy),
    m_fault_injector(fault_injector)
 {
    m_set_info = CacheSet::createCacheSetInfo(name, cfgname, core_id, replacement_policy, m_associativity);
    m_sets = new CacheSet*[m_num_sets];
+   // Keep all tags in one array rather than in each set's CacheBlockInfo objects, so lookups don't chase pointers
+   m_tags = new IntPtr[m_num_sets * m_associativity];
    for (UInt32 i = 0; i < m_num_sets; i++)
    {
       m_sets[i] = CacheSet::createCacheSet(cfgname, core_id, replacement_policy, m_cache_type, m_associativity, m_blocksize, m_set_info);
+      m_sets[i]->setTagArray(&m_tags[i * m_associativity]);
    }
 
+   // Use the specialized access path if the sets were created with a policy specialized for this associativity
+   if (!bindSetTypeSized<CacheSetLRU>() && !bindSetTypeSized<CacheSetSRRIP>()
+       && !bindSetTypeSized<CacheSetNRU>() && !bindSetTypeSized<CacheSetPLRU>())
+      bindSetType<CacheSet>();
+
    #ifdef ENABLE_SET_USAGE_HIST
    m_set_usage_hist = new UInt64[m_num_sets];
    for (UInt32 i = 0; i < m_num_sets; i++)
       m_set_usage_hist[i] = 0;
    #endif
+
+   registerCheckpointObject(name, core_id, this);
 }
 
 Cache::~Cache()
@@ -54,6 +69,7 @@ Cache::~Cache()
    for (SInt32 i = 0; i < (SInt32) m_num_sets; i++)
       delete m_sets[i];
    delete [] m_sets;
+   delete [] m_tags;
 }
 
 Lock&
@@ -80,8 +96,27 @@ Cache::invalidateSingleLine(IntPtr addr)
    return m_sets[set_index]->invalidate(tag);
 }
 
-CacheBlockInfo*
-Cache::accessSingleLine(IntPtr addr, access_t access_type,
+template <class SetType> bool
+Cache::bindSetType()
+{
+   if (!dynamic_cast<SetType*>(m_sets[0]))
+      return false;
+   m_access_single_line = &Cache::accessSingleLineImpl<SetType>;
+   m_insert_single_line = &Cache::insertSingleLineImpl<SetType>;
+   return true;
+}
+
+template <class Policy> bool
+Cache::bindSetTypeSized()
+{
+#define BIND_SET_TYPE_SIZED(assoc) if (bindSetType<CacheSetSized<Policy, assoc> >()) return true;
+   CACHE_SET_SIZED_ASSOCIATIVITIES(BIND_SET_TYPE_SIZED)
+#undef BIND_SET_TYPE_SIZED
+   return false;
+}
+
+template <class SetType> CacheBlockInfo*
+Cache::accessSingleLineImpl(IntPtr addr, access_t access_type,
       Byte* buff, UInt32 bytes, SubsecondTime now, bool update_replacement)
 {
    //assert((buff == NULL) == (bytes == 0));
@@ -93,7 +128,7 @@ Cache::accessSingleLine(IntPtr addr, access_t access_type,
 
    splitAddress(addr, tag, set_index, block_offset);
 
-   CacheSet* set = m_sets[set_index];
+   SetType* set = static_cast<SetType*>(m_sets[set_index]);
    CacheBlockInfo* cache_block_info = set->find(tag, &line_index);
 
    if (cache_block_info == NULL)
@@ -105,22 +140,25 @@ Cache::accessSingleLine(IntPtr addr, access_t access_type,
       if (m_fault_injector)
          m_fault_injector->preRead(addr, set_index * m_associativity + line_index, bytes, (Byte*)m_sets[set_index]->getDataPtr(line_index, block_offset), now);
 
-      set->read_line(line_index, block_offset, buff, bytes, update_replacement);
+      set->read_line(line_index, block_offset, buff, bytes, false);
    }
    else
    {
-      set->write_line(line_index, block_offset, buff, bytes, update_replacement);
+      set->write_line(line_index, block_offset, buff, bytes, false);
 
       // NOTE: assumes error occurs in memory. If we want to model bus errors, insert the error into buff instead
       if (m_fault_injector)
          m_fault_injector->postWrite(addr, set_index * m_associativity + line_index, bytes, (Byte*)m_sets[set_index]->getDataPtr(line_index, block_offset), now);
    }
 
+   if (update_replacement)
+      set->updateReplacementIndex(line_index);
+
    return cache_block_info;
 }
 
-void
-Cache::insertSingleLine(IntPtr addr, Byte* fill_buff,
+template <class SetType> void
+Cache::insertSingleLineImpl(IntPtr addr, Byte* fill_buff,
       bool* eviction, IntPtr* evict_addr,
       CacheBlockInfo* evict_block_info, Byte* evict_buff,
       SubsecondTime now, CacheCntlr *cntlr)
@@ -132,8 +170,9 @@ Cache::insertSingleLine(IntPtr addr, Byte* fill_buff,
    CacheBlockInfo* cache_block_info = CacheBlockInfo::create(m_cache_type);
    cache_block_info->setTag(tag);
 
-   m_sets[set_index]->insert(cache_block_info, fill_buff,
-         eviction, evict_block_info, evict_buff, cntlr);
+   SetType* set = static_cast<SetType*>(m_sets[set_index]);
+   set->insertAt(set->getReplacementIndex(cntlr), cache_block_info, fill_buff,
+         eviction, evict_block_info, evict_buff);
    *evict_addr = tagToAddress(evict_block_info->getTag());
 
    if (m_fault_injector) {
@@ -184,3 +223,38 @@ Cache::updateHits(Core::mem_op_t mem_op_type, UInt64 hits)
       m_num_hits += hits;
    }
 }
+
+void
+Cache::saveState(CheckpointWriter &writer)
+{
+   writer.write<UInt64>(m_num_sets);
+   writer.write<UInt64>(m_associativity);
+   writer.write<UInt64>(m_blocksize);
+   writer.write<UInt64>(m_hash);
+   writer.write<UInt64>(Sim()->getFaultinjectionManager() != NULL);  // Line data is only kept with fault injection
+   for (UInt32 i = 0; i < m_num_sets; i++)
+      m_sets[i]->saveBlocks(writer);
+
+   // Replacement state comes last, so caches with a different policy can still restore their contents
+   writer.writeString(m_replacement_policy);
+   for (UInt32 i = 0; i < m_num_sets; i++)
+      m_sets[i]->saveReplacementState(writer);
+}
+
+void
+Cache::loadState(CheckpointReader &reader)
+{
+   if (!reader.check(m_num_sets, "number of sets")
+      || !reader.check(m_associativity, "associativity")
+      || !reader.check(m_blocksize, "block size")
+      || !reader.check(m_hash, "hash function")
+      || !reader.check(Sim()->getFaultinjectionManager() != NULL, "fault injection setting"))
+      return;
+   for (UInt32 i = 0; i < m_num_sets; i++)
+      m_sets[i]->loadBlocks(reader);
+
+   if (reader.readString() != m_replacement_policy)
+      return;
+   for (UInt32 i = 0; i < m_num_sets; i++)
+      m_sets[i]->loadReplacementState(reader);
+}
@@ -11,11 +11,12 @@
 #include "log.h"
 #include "core.h"
 #include "fault_injection.h"
+#include "checkpoint.h"
 
 // Define to enable the set usage histogram
 //#define ENABLE_SET_USAGE_HIST
 
-class Cache : public CacheBase
+class Cache : public CacheBase, public Checkpointable
 {
    private:
       bool m_enabled;
@@ -27,10 +28,28 @@ class Cache : public CacheBase
       // Generic Cache Info
       cache_t m_cache_type;
       CacheSet** m_sets;
+      IntPtr* m_tags;   // Tags of all sets, m_associativity entries per set
       CacheSetInfo* m_set_info;
+      String m_replacement_policy;
 
       FaultInjector *m_fault_injector;
 
+      // accessSingleLine and insertSingleLine, instantiated for the type of m_sets so that replacement policies
+      // specialized for this cache's associativity are called without virtual dispatch, see bindSetType()
+      CacheBlockInfo* (Cache::*m_access_single_line)(IntPtr addr,
+            access_t access_type, Byte* buff, UInt32 bytes, SubsecondTime now, bool update_replacement);
+      void (Cache::*m_insert_single_line)(IntPtr addr, Byte* fill_buff,
+            bool* eviction, IntPtr* evict_addr,
+            CacheBlockInfo* evict_block_info, Byte* evict_buff, SubsecondTime now, CacheCntlr *cntlr);
+
+      template <class SetType> bool bindSetType();
+      template <class Policy> bool bindSetTypeSized();
+      template <class SetType> CacheBlockInfo* accessSingleLineImpl(IntPtr addr,
+            access_t access_type, Byte* buff, UInt32 bytes, SubsecondTime now, bool update_replacement);
+      template <class SetType> void insertSingleLineImpl(IntPtr addr, Byte* fill_buff,
+            bool* eviction, IntPtr* evict_addr,
+            CacheBlockInfo* evict_block_info, Byte* evict_buff, SubsecondTime now, CacheCntlr *cntlr);
+
       #ifdef ENABLE_SET_USAGE_HIST
       UInt64* m_set_usage_hist;
       #endif
@@ -54,10 +73,16 @@ class Cache : public CacheBase
 
       bool invalidateSingleLine(IntPtr addr);
       CacheBlockInfo* accessSingleLine(IntPtr addr,
-            access_t access_type, Byte* buff, UInt32 bytes, SubsecondTime now, bool update_replacement);
+            access_t access_type, Byte* buff, UInt32 bytes, SubsecondTime now, bool update_replacement)
+      {
+         return (this->*m_access_single_line)(addr, access_type, buff, bytes, now, update_replacement);
+      }
       void insertSingleLine(IntPtr addr, Byte* fill_buff,
             bool* eviction, IntPtr* evict_addr,
-            CacheBlockInfo* evict_block_info, Byte* evict_buff, SubsecondTime now, CacheCntlr *cntlr = NULL);
+            CacheBlockInfo* evict_block_info, Byte* evict_buff, SubsecondTime now, CacheCntlr *cntlr = NULL)
+      {
+         (this->*m_insert_single_line)(addr, fill_buff, eviction, evict_addr, evict_block_info, evict_buff, now, cntlr);
+      }
       CacheBlockInfo* peekSingleLine(IntPtr addr);
 
       CacheBlockInfo* peekBlock(UInt32 set_index, UInt32 way) const { return m_sets[set_index]->peekBlock(way); }
@@ -68,6 +93,9 @@ class Cache : public CacheBase
 
       void enable() { m_enabled = true; }
       void disable() { m_enabled = false; }
+
+      void saveState(CheckpointWriter &writer);
+      void loadState(CheckpointReader &reader);
 };
 
 template <class T>
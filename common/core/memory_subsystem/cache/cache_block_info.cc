@@ -22,13 +22,35 @@ const char* CacheBlockInfo::getOptionName(option_t option)
 
 
 CacheBlockInfo::CacheBlockInfo(IntPtr tag, CacheState::cstate_t cstate, UInt64 options):
-   m_tag(tag),
+   m_tag_value(tag),
+   m_tag(&m_tag_value),
    m_cstate(cstate),
    m_owner(0),
    m_used(0),
    m_options(options)
 {}
 
+// Copies always get their own tag storage
+CacheBlockInfo::CacheBlockInfo(const CacheBlockInfo &cache_block_info):
+   m_tag_value(cache_block_info.getTag()),
+   m_tag(&m_tag_value),
+   m_cstate(cache_block_info.m_cstate),
+   m_owner(cache_block_info.m_owner),
+   m_used(cache_block_info.m_used),
+   m_options(cache_block_info.m_options)
+{}
+
+CacheBlockInfo&
+CacheBlockInfo::operator=(const CacheBlockInfo &cache_block_info)
+{
+   *m_tag = cache_block_info.getTag();
+   m_cstate = cache_block_info.m_cstate;
+   m_owner = cache_block_info.m_owner;
+   m_used = cache_block_info.m_used;
+   m_options = cache_block_info.m_options;
+   return *this;
+}
+
 CacheBlockInfo::~CacheBlockInfo()
 {}
 
@@ -55,14 +77,14 @@ CacheBlockInfo::create(CacheBase::cache_t cache_type)
 void
 CacheBlockInfo::invalidate()
 {
-   m_tag = ~0;
+   *m_tag = ~0;
    m_cstate = CacheState::INVALID;
 }
 
 void
 CacheBlockInfo::clone(CacheBlockInfo* cache_block_info)
 {
-   m_tag = cache_block_info->getTag();
+   *m_tag = cache_block_info->getTag();
    m_cstate = cache_block_info->getCState();
    m_owner = cache_block_info->m_owner;
    m_used = cache_block_info->m_used;
@@ -88,3 +110,23 @@ CacheBlockInfo::updateUsage(BitsUsedType used)
    m_used |= used;                     // Update usage mask
    return new_bits_set;
 }
+
+void
+CacheBlockInfo::saveState(CheckpointWriter &writer)
+{
+   writer.write(*m_tag);
+   writer.write<UInt8>(m_cstate);
+   writer.write(m_owner);
+   writer.write(m_used);
+   writer.write(m_options);
+}
+
+void
+CacheBlockInfo::loadState(CheckpointReader &reader)
+{
+   reader.read(*m_tag);
+   m_cstate = (CacheState::cstate_t)reader.read<UInt8>();
+   reader.read(m_owner);
+   reader.read(m_used);
+   reader.read(m_options);
+}
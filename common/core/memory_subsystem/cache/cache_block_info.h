@@ -4,6 +4,7 @@
 #include "fixed_types.h"
 #include "cache_state.h"
 #include "cache_base.h"
+#include "checkpoint.h"
 
 class CacheBlockInfo
 {
@@ -21,7 +22,8 @@ class CacheBlockInfo
    // This can be extended later to include other information
    // for different cache coherence protocols
    private:
-      IntPtr m_tag;
+      IntPtr m_tag_value;
+      IntPtr *m_tag;  // Points to m_tag_value, or to this block's slot in its CacheSet's contiguous tag array
       CacheState::cstate_t m_cstate;
       UInt64 m_owner;
       BitsUsedType m_used;
@@ -33,6 +35,8 @@ class CacheBlockInfo
       CacheBlockInfo(IntPtr tag = ~0,
             CacheState::cstate_t cstate = CacheState::INVALID,
             UInt64 options = 0);
+      CacheBlockInfo(const CacheBlockInfo &cache_block_info);
+      CacheBlockInfo& operator=(const CacheBlockInfo &cache_block_info);
       virtual ~CacheBlockInfo();
 
       static CacheBlockInfo* create(CacheBase::cache_t cache_type);
@@ -40,12 +44,18 @@ class CacheBlockInfo
       virtual void invalidate(void);
       virtual void clone(CacheBlockInfo* cache_block_info);
 
-      bool isValid() const { return (m_tag != ((IntPtr) ~0)); }
+      virtual void saveState(CheckpointWriter &writer);
+      virtual void loadState(CheckpointReader &reader);
 
-      IntPtr getTag() const { return m_tag; }
+      // Move this block's tag into external storage, used by CacheSet to keep the tags of all ways together
+      void bindTag(IntPtr *tag) { *tag = *m_tag; m_tag = tag; }
+
+      bool isValid() const { return (*m_tag != ((IntPtr) ~0)); }
+
+      IntPtr getTag() const { return *m_tag; }
       CacheState::cstate_t getCState() const { return m_cstate; }
 
-      void setTag(IntPtr tag) { m_tag = tag; }
+      void setTag(IntPtr tag) { *m_tag = tag; }
       void setCState(CacheState::cstate_t cstate) { m_cstate = cstate; }
 
       UInt64 getOwner() const { return m_owner; }
@@ -8,6 +8,7 @@
 #include "cache_set_round_robin.h"
 #include "cache_set_srrip.h"
 #include "cache_base.h"
+#include "cache_tag_search.h"
 #include "log.h"
 #include "simulator.h"
 #include "config.h"
@@ -18,9 +19,12 @@ CacheSet::CacheSet(CacheBase::cache_t cache_type,
       m_associativity(associativity), m_blocksize(blocksize)
 {
    m_cache_block_info_array = new CacheBlockInfo*[m_associativity];
+   m_tags = new IntPtr[m_associativity];
+   m_tags_owned = true;
    for (UInt32 i = 0; i < m_associativity; i++)
    {
       m_cache_block_info_array[i] = CacheBlockInfo::create(cache_type);
+      m_cache_block_info_array[i]->bindTag(&m_tags[i]);
    }
 
    if (Sim()->getFaultinjectionManager())
@@ -37,9 +41,22 @@ CacheSet::~CacheSet()
    for (UInt32 i = 0; i < m_associativity; i++)
       delete m_cache_block_info_array[i];
    delete [] m_cache_block_info_array;
+   if (m_tags_owned)
+      delete [] m_tags;
    delete [] m_blocks;
 }
 
+void
+CacheSet::setTagArray(IntPtr* tags)
+{
+   for (UInt32 i = 0; i < m_associativity; i++)
+      m_cache_block_info_array[i]->bindTag(&tags[i]);
+   if (m_tags_owned)
+      delete [] m_tags;
+   m_tags = tags;
+   m_tags_owned = false;
+}
+
 void
 CacheSet::read_line(UInt32 line_index, UInt32 offset, Byte *out_buff, UInt32 bytes, bool update_replacement)
 {
@@ -69,38 +86,29 @@ CacheSet::write_line(UInt32 line_index, UInt32 offset, Byte *in_buff, UInt32 byt
 CacheBlockInfo*
 CacheSet::find(IntPtr tag, UInt32* line_index)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
-   {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         if (line_index != NULL)
-            *line_index = index;
-         return (m_cache_block_info_array[index]);
-      }
-   }
-   return NULL;
+   SInt32 index = searchCacheTag(m_tags, m_associativity, tag);
+   if (index < 0)
+      return NULL;
+   if (line_index != NULL)
+      *line_index = index;
+   return (m_cache_block_info_array[index]);
 }
 
 bool
 CacheSet::invalidate(IntPtr& tag)
 {
-   for (SInt32 index = m_associativity-1; index >= 0; index--)
-   {
-      if (m_cache_block_info_array[index]->getTag() == tag)
-      {
-         m_cache_block_info_array[index]->invalidate();
-         return true;
-      }
-   }
-   return false;
+   SInt32 index = searchCacheTag(m_tags, m_associativity, tag);
+   if (index < 0)
+      return false;
+   m_cache_block_info_array[index]->invalidate();
+   return true;
 }
 
 void
-CacheSet::insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* eviction, CacheBlockInfo* evict_block_info, Byte* evict_buff, CacheCntlr *cntlr)
+CacheSet::insertAt(UInt32 index, CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* eviction, CacheBlockInfo* evict_block_info, Byte* evict_buff)
 {
    // This replacement strategy does not take into account the fact that
    // cache blocks can be voluntarily flushed or invalidated due to another write request
-   const UInt32 index = getReplacementIndex(cntlr);
    assert(index < m_associativity);
 
    assert(eviction != NULL);
@@ -125,12 +133,44 @@ CacheSet::insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* evicti
       memcpy(&m_blocks[index * m_blocksize], (void*) fill_buff, m_blocksize);
 }
 
+void
+CacheSet::saveBlocks(CheckpointWriter &writer)
+{
+   for (UInt32 i = 0; i < m_associativity; i++)
+      m_cache_block_info_array[i]->saveState(writer);
+   if (m_blocks != NULL)
+      writer.write(m_blocks, m_associativity * m_blocksize);
+}
+
+void
+CacheSet::loadBlocks(CheckpointReader &reader)
+{
+   for (UInt32 i = 0; i < m_associativity; i++)
+      m_cache_block_info_array[i]->loadState(reader);
+   if (m_blocks != NULL)
+      reader.read(m_blocks, m_associativity * m_blocksize);
+}
+
 char*
 CacheSet::getDataPtr(UInt32 line_index, UInt32 offset)
 {
    return &m_blocks[line_index * m_blocksize + offset];
 }
 
+// Use a version of the policy specialized for this associativity when there is one
+template <class Policy, typename... Args>
+static CacheSet* createCacheSetSized(UInt32 associativity, Args... args)
+{
+   switch(associativity)
+   {
+#define CREATE_CACHE_SET_SIZED(assoc) case assoc: return new CacheSetSized<Policy, assoc>(args...);
+      CACHE_SET_SIZED_ASSOCIATIVITIES(CREATE_CACHE_SET_SIZED)
+#undef CREATE_CACHE_SET_SIZED
+      default:
+         return new Policy(args...);
+   }
+}
+
 CacheSet*
 CacheSet::createCacheSet(String cfgname, core_id_t core_id,
       String replacement_policy,
@@ -145,10 +185,10 @@ CacheSet::createCacheSet(String cfgname, core_id_t core_id,
 
       case CacheBase::LRU:
       case CacheBase::LRU_QBS:
-         return new CacheSetLRU(cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+         return createCacheSetSized<CacheSetLRU>(associativity, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
 
       case CacheBase::NRU:
-         return new CacheSetNRU(cache_type, associativity, blocksize);
+         return createCacheSetSized<CacheSetNRU>(associativity, cache_type, associativity, blocksize);
 
       case CacheBase::MRU:
          return new CacheSetMRU(cache_type, associativity, blocksize);
@@ -157,11 +197,11 @@ CacheSet::createCacheSet(String cfgname, core_id_t core_id,
          return new CacheSetNMRU(cache_type, associativity, blocksize);
 
       case CacheBase::PLRU:
-         return new CacheSetPLRU(cache_type, associativity, blocksize);
+         return createCacheSetSized<CacheSetPLRU>(associativity, cache_type, associativity, blocksize);
 
       case CacheBase::SRRIP:
       case CacheBase::SRRIP_QBS:
-         return new CacheSetSRRIP(cfgname, core_id, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
+         return createCacheSetSized<CacheSetSRRIP>(associativity, cfgname, core_id, cache_type, associativity, blocksize, dynamic_cast<CacheSetInfoLRU*>(set_info), getNumQBSAttempts(policy, cfgname, core_id));
 
       case CacheBase::RANDOM:
          return new CacheSetRandom(cache_type, associativity, blocksize);
@@ -30,6 +30,8 @@ class CacheSet
 
    protected:
       CacheBlockInfo** m_cache_block_info_array;
+      IntPtr* m_tags;      // Tags of all ways, searched by find() without touching the CacheBlockInfo objects
+      bool m_tags_owned;   // False once the tags have moved into their Cache's tag array, see setTagArray()
       char* m_blocks;
       UInt32 m_associativity;
       UInt32 m_blocksize;
@@ -45,11 +47,19 @@ class CacheSet
       UInt32 getAssociativity() { return m_associativity; }
       Lock& getLock() { return m_lock; }
 
+      // Keep the tags in external storage of getAssociativity() entries, so a cache can store the tags of all its sets together
+      void setTagArray(IntPtr* tags);
+
       void read_line(UInt32 line_index, UInt32 offset, Byte *out_buff, UInt32 bytes, bool update_replacement);
       void write_line(UInt32 line_index, UInt32 offset, Byte *in_buff, UInt32 bytes, bool update_replacement);
       CacheBlockInfo* find(IntPtr tag, UInt32* line_index = NULL);
       bool invalidate(IntPtr& tag);
-      void insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* eviction, CacheBlockInfo* evict_block_info, Byte* evict_buff, CacheCntlr *cntlr = NULL);
+      void insert(CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* eviction, CacheBlockInfo* evict_block_info, Byte* evict_buff, CacheCntlr *cntlr = NULL)
+      {
+         insertAt(getReplacementIndex(cntlr), cache_block_info, fill_buff, eviction, evict_block_info, evict_buff);
+      }
+      // Insert into the way selected by getReplacementIndex()
+      void insertAt(UInt32 index, CacheBlockInfo* cache_block_info, Byte* fill_buff, bool* eviction, CacheBlockInfo* evict_block_info, Byte* evict_buff);
 
       CacheBlockInfo* peekBlock(UInt32 way) const { return m_cache_block_info_array[way]; }
 
@@ -60,6 +70,38 @@ class CacheSet
       virtual void updateReplacementIndex(UInt32) = 0;
 
       bool isValidReplacement(UInt32 index);
+
+   protected:
+      // Number of ways, as a compile-time constant in sets specialized by CacheSetSized
+      template <UInt32 Assoc> UInt32 ways() const { return Assoc ? Assoc : m_associativity; }
+
+   public:
+
+      void saveBlocks(CheckpointWriter &writer);
+      void loadBlocks(CheckpointReader &reader);
+      virtual void saveReplacementState(CheckpointWriter &writer) {}
+      virtual void loadReplacementState(CheckpointReader &reader) {}
 };
 
+// Replacement policy specialized for a fixed associativity.
+//
+// Policies that support this implement getReplacementIndexSized<Assoc>() and updateReplacementIndexSized<Assoc>(),
+// using ways<Assoc>() for the number of ways so their loops have a constant trip count (Assoc == 0 is the
+// generic version behind their virtual methods). As these sets are final, Cache calls them without
+// virtual dispatch, see Cache::bindSetType().
+template <class Policy, UInt32 Assoc> class CacheSetSized final : public Policy
+{
+   public:
+      template <typename... Args> CacheSetSized(Args... args) : Policy(args...)
+      {
+         LOG_ASSERT_ERROR(this->getAssociativity() == Assoc, "Set specialized for associativity %u has %u ways", Assoc, this->getAssociativity());
+      }
+
+      UInt32 getReplacementIndex(CacheCntlr *cntlr) { return Policy::template getReplacementIndexSized<Assoc>(cntlr); }
+      void updateReplacementIndex(UInt32 accessed_index) { Policy::template updateReplacementIndexSized<Assoc>(accessed_index); }
+};
+
+// Associativities for which CacheSetSized versions of the policies are compiled
+#define CACHE_SET_SIZED_ASSOCIATIVITIES(macro) macro(4) macro(8) macro(16) macro(20)
+
 #endif /* CACHE_SET_H */
@@ -21,16 +21,16 @@ CacheSetLRU::~CacheSetLRU()
    delete [] m_lru_bits;
 }
 
-UInt32
-CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr)
+template <UInt32 Assoc> UInt32
+CacheSetLRU::getReplacementIndexSized(CacheCntlr *cntlr)
 {
    // First try to find an invalid block
-   for (UInt32 i = 0; i < m_associativity; i++)
+   for (UInt32 i = 0; i < ways<Assoc>(); i++)
    {
       if (!m_cache_block_info_array[i]->isValid())
       {
          // Mark our newly-inserted line as most-recently used
-         moveToMRU(i);
+         moveToMRU<Assoc>(i);
          return i;
       }
    }
@@ -40,7 +40,7 @@ CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr)
    {
       UInt32 index = 0;
       UInt8 max_bits = 0;
-      for (UInt32 i = 0; i < m_associativity; i++)
+      for (UInt32 i = 0; i < ways<Assoc>(); i++)
       {
          if (m_lru_bits[i] > max_bits && isValidReplacement(i))
          {
@@ -61,14 +61,14 @@ CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr)
       {
          // Block is contained in lower-level cache, and we have more tries remaining.
          // Move this block to MRU and try again
-         moveToMRU(index);
+         moveToMRU<Assoc>(index);
          cntlr->incrementQBSLookupCost();
          continue;
       }
       else
       {
          // Mark our newly-inserted line as most-recently used
-         moveToMRU(index);
+         moveToMRU<Assoc>(index);
          m_set_info->incrementAttempt(attempt);
          return index;
       }
@@ -77,17 +77,17 @@ CacheSetLRU::getReplacementIndex(CacheCntlr *cntlr)
    LOG_PRINT_ERROR("Should not reach here");
 }
 
-void
-CacheSetLRU::updateReplacementIndex(UInt32 accessed_index)
+template <UInt32 Assoc> void
+CacheSetLRU::updateReplacementIndexSized(UInt32 accessed_index)
 {
    m_set_info->increment(m_lru_bits[accessed_index]);
-   moveToMRU(accessed_index);
+   moveToMRU<Assoc>(accessed_index);
 }
 
-void
+template <UInt32 Assoc> void
 CacheSetLRU::moveToMRU(UInt32 accessed_index)
 {
-   for (UInt32 i = 0; i < m_associativity; i++)
+   for (UInt32 i = 0; i < ways<Assoc>(); i++)
    {
       if (m_lru_bits[i] < m_lru_bits[accessed_index])
          m_lru_bits[i] ++;
@@ -123,3 +123,22 @@ CacheSetInfoLRU::~CacheSetInfoLRU()
    if (m_attempts)
       delete [] m_attempts;
 }
+
+void
+CacheSetLRU::saveReplacementState(CheckpointWriter &writer)
+{
+   writer.write(m_lru_bits, m_associativity);
+}
+
+void
+CacheSetLRU::loadReplacementState(CheckpointReader &reader)
+{
+   reader.read(m_lru_bits, m_associativity);
+}
+
+template UInt32 CacheSetLRU::getReplacementIndexSized<0>(CacheCntlr *cntlr);
+template void CacheSetLRU::updateReplacementIndexSized<0>(UInt32 accessed_index);
+#define INSTANTIATE_CACHE_SET_LRU_SIZED(assoc) \
+   template UInt32 CacheSetLRU::getReplacementIndexSized<assoc>(CacheCntlr *cntlr); \
+   template void CacheSetLRU::updateReplacementIndexSized<assoc>(UInt32 accessed_index);
+CACHE_SET_SIZED_ASSOCIATIVITIES(INSTANTIATE_CACHE_SET_LRU_SIZED)
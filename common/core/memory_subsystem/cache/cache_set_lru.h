@@ -33,14 +33,18 @@ class CacheSetLRU : public CacheSet
             UInt32 associativity, UInt32 blocksize, CacheSetInfoLRU* set_info, UInt8 num_attempts);
       virtual ~CacheSetLRU();
 
-      virtual UInt32 getReplacementIndex(CacheCntlr *cntlr);
-      void updateReplacementIndex(UInt32 accessed_index);
+      virtual UInt32 getReplacementIndex(CacheCntlr *cntlr) { return getReplacementIndexSized<0>(cntlr); }
+      void updateReplacementIndex(UInt32 accessed_index) { updateReplacementIndexSized<0>(accessed_index); }
+      void saveReplacementState(CheckpointWriter &writer);
+      void loadReplacementState(CheckpointReader &reader);
 
    protected:
       const UInt8 m_num_attempts;
       UInt8* m_lru_bits;
       CacheSetInfoLRU* m_set_info;
-      void moveToMRU(UInt32 accessed_index);
+      template <UInt32 Assoc> UInt32 getReplacementIndexSized(CacheCntlr *cntlr);
+      template <UInt32 Assoc> void updateReplacementIndexSized(UInt32 accessed_index);
+      template <UInt32 Assoc> void moveToMRU(UInt32 accessed_index);
 };
 
 #endif /* CACHE_SET_LRU_H */
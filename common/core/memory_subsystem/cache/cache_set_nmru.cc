@@ -61,3 +61,17 @@ CacheSetNMRU::updateReplacementIndex(UInt32 accessed_index)
    }
    m_lru_bits[accessed_index] = 0;
 }
+
+void
+CacheSetNMRU::saveReplacementState(CheckpointWriter &writer)
+{
+   writer.write(m_lru_bits, m_associativity);
+   writer.write(m_replacement_pointer);
+}
+
+void
+CacheSetNMRU::loadReplacementState(CheckpointReader &reader)
+{
+   reader.read(m_lru_bits, m_associativity);
+   reader.read(m_replacement_pointer);
+}
@@ -21,20 +21,20 @@ CacheSetNRU::~CacheSetNRU()
    delete [] m_lru_bits;
 }
 
-UInt32
-CacheSetNRU::getReplacementIndex(CacheCntlr *cntlr)
+template <UInt32 Assoc> UInt32
+CacheSetNRU::getReplacementIndexSized(CacheCntlr *cntlr)
 {
    // Invalidations may mess up the LRU bits
 
    bool have_zero_bit = false;
 
-   for (UInt32 i = 0; i < m_associativity; i++)
+   for (UInt32 i = 0; i < ways<Assoc>(); i++)
    {
       if (!m_cache_block_info_array[i]->isValid())
       {
          // If there is an invalid line(s) in the set, regardless of the LRU bits of other lines, we choose the first invalid line to replace
          // Mark our newly-inserted line as recently used
-         updateReplacementIndex(i);
+         updateReplacementIndexSized<Assoc>(i);
          return i;
       }
       else if (m_lru_bits[i] == 0 && isValidReplacement(i))
@@ -45,41 +45,64 @@ CacheSetNRU::getReplacementIndex(CacheCntlr *cntlr)
       }
    }
 
-   for (UInt32 i = 0; i < m_associativity; i++)
+   for (UInt32 i = 0; i < ways<Assoc>(); i++)
    {
       if ((m_lru_bits[m_replacement_pointer] == 0 || have_zero_bit == false)
           && isValidReplacement(m_replacement_pointer))
       {
          // We choose the first non-touched line as the victim (note that we start searching from the replacement pointer position)
          UInt8 index = m_replacement_pointer;
-         m_replacement_pointer = (m_replacement_pointer + 1) % m_associativity;
+         m_replacement_pointer = (m_replacement_pointer + 1) % ways<Assoc>();
 
          // Mark our newly-inserted line as recently used
-         updateReplacementIndex(index);
+         updateReplacementIndexSized<Assoc>(index);
          return index;
       }
 
-      m_replacement_pointer = (m_replacement_pointer + 1) % m_associativity;
+      m_replacement_pointer = (m_replacement_pointer + 1) % ways<Assoc>();
    }
 
    LOG_PRINT_ERROR("Error Finding LRU bits");
 }
 
-void
-CacheSetNRU::updateReplacementIndex(UInt32 accessed_index)
+template <UInt32 Assoc> void
+CacheSetNRU::updateReplacementIndexSized(UInt32 accessed_index)
 {
    m_lru_bits[accessed_index] = 1;
    m_num_bits_set++;
 
    // If all lru bits are set to 1 in the set, we make all of them 0
 
-   if (m_num_bits_set == m_associativity)
+   if (m_num_bits_set == ways<Assoc>())
    {
       m_num_bits_set = 0;
 
-      for (UInt32 i = 0; i < m_associativity; i++)
+      for (UInt32 i = 0; i < ways<Assoc>(); i++)
       {
          m_lru_bits[i] = 0;
       }
    }
 }
+
+void
+CacheSetNRU::saveReplacementState(CheckpointWriter &writer)
+{
+   writer.write(m_lru_bits, m_associativity);
+   writer.write(m_num_bits_set);
+   writer.write(m_replacement_pointer);
+}
+
+void
+CacheSetNRU::loadReplacementState(CheckpointReader &reader)
+{
+   reader.read(m_lru_bits, m_associativity);
+   reader.read(m_num_bits_set);
+   reader.read(m_replacement_pointer);
+}
+
+template UInt32 CacheSetNRU::getReplacementIndexSized<0>(CacheCntlr *cntlr);
+template void CacheSetNRU::updateReplacementIndexSized<0>(UInt32 accessed_index);
+#define INSTANTIATE_CACHE_SET_NRU_SIZED(assoc) \
+   template UInt32 CacheSetNRU::getReplacementIndexSized<assoc>(CacheCntlr *cntlr); \
+   template void CacheSetNRU::updateReplacementIndexSized<assoc>(UInt32 accessed_index);
+CACHE_SET_SIZED_ASSOCIATIVITIES(INSTANTIATE_CACHE_SET_NRU_SIZED)
@@ -10,8 +10,14 @@ class CacheSetNRU : public CacheSet
             UInt32 associativity, UInt32 blocksize);
       ~CacheSetNRU();
 
-      UInt32 getReplacementIndex(CacheCntlr *cntlr);
-      void updateReplacementIndex(UInt32 accessed_index);
+      UInt32 getReplacementIndex(CacheCntlr *cntlr) { return getReplacementIndexSized<0>(cntlr); }
+      void updateReplacementIndex(UInt32 accessed_index) { updateReplacementIndexSized<0>(accessed_index); }
+      void saveReplacementState(CheckpointWriter &writer);
+      void loadReplacementState(CheckpointReader &reader);
+
+   protected:
+      template <UInt32 Assoc> UInt32 getReplacementIndexSized(CacheCntlr *cntlr);
+      template <UInt32 Assoc> void updateReplacementIndexSized(UInt32 accessed_index);
 
    private:
       UInt8* m_lru_bits;
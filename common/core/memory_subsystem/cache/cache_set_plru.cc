@@ -18,22 +18,22 @@ CacheSetPLRU::~CacheSetPLRU()
 {
 }
 
-UInt32
-CacheSetPLRU::getReplacementIndex(CacheCntlr *cntlr)
+template <UInt32 Assoc> UInt32
+CacheSetPLRU::getReplacementIndexSized(CacheCntlr *cntlr)
 {
    // Invalidations may mess up the LRU bits
 
-   for (UInt32 i = 0; i < m_associativity; i++)
+   for (UInt32 i = 0; i < ways<Assoc>(); i++)
    {
       if (!m_cache_block_info_array[i]->isValid())
       {
-         updateReplacementIndex(i);
+         updateReplacementIndexSized<Assoc>(i);
          return i;
       }
    }
 
    UInt32 retValue = -1;
-   if (m_associativity == 4)
+   if (ways<Assoc>() == 4)
    {
       if (b[0] == 0)
       {
@@ -46,7 +46,7 @@ CacheSetPLRU::getReplacementIndex(CacheCntlr *cntlr)
          else           retValue = 3;   // b2==1
       }
    }
-   else if (m_associativity == 8)
+   else if (ways<Assoc>() == 8)
    {
       if (b[0] == 0)
       {
@@ -77,27 +77,27 @@ CacheSetPLRU::getReplacementIndex(CacheCntlr *cntlr)
    }
    else
    {
-      LOG_PRINT_ERROR("PLRU doesn't support associativity %d", m_associativity);
+      LOG_PRINT_ERROR("PLRU doesn't support associativity %d", ways<Assoc>());
    }
 
 
    LOG_ASSERT_ERROR(isValidReplacement(retValue), "PLRU selected an invalid replacement candidate" );
-   updateReplacementIndex(retValue);
+   updateReplacementIndexSized<Assoc>(retValue);
    return retValue;
 
 }
 
-void
-CacheSetPLRU::updateReplacementIndex(UInt32 accessed_index)
+template <UInt32 Assoc> void
+CacheSetPLRU::updateReplacementIndexSized(UInt32 accessed_index)
 {
-   if (m_associativity == 4)
+   if (ways<Assoc>() == 4)
    {
       if      (accessed_index==0) { b[0]=1;b[1]=1;     }
       else if (accessed_index==1) { b[0]=1;b[1]=0;     }
       else if (accessed_index==2) { b[0]=0;       b[2]=1;}
       else if (accessed_index==3) { b[0]=0;       b[2]=0;}
    }
-   else if (m_associativity == 8)
+   else if (ways<Assoc>() == 8)
    {
       if      (accessed_index==0) { b[0]=1;b[1]=1;b[2]=1;                            }
       else if (accessed_index==1) { b[0]=1;b[1]=1;b[2]=0;                            }
@@ -110,6 +110,25 @@ CacheSetPLRU::updateReplacementIndex(UInt32 accessed_index)
    }
    else
    {
-      LOG_PRINT_ERROR("PLRU doesn't support associativity %d", m_associativity);
+      LOG_PRINT_ERROR("PLRU doesn't support associativity %d", ways<Assoc>());
    }
 }
+
+void
+CacheSetPLRU::saveReplacementState(CheckpointWriter &writer)
+{
+   writer.write(b, sizeof(b));
+}
+
+void
+CacheSetPLRU::loadReplacementState(CheckpointReader &reader)
+{
+   reader.read(b, sizeof(b));
+}
+
+template UInt32 CacheSetPLRU::getReplacementIndexSized<0>(CacheCntlr *cntlr);
+template void CacheSetPLRU::updateReplacementIndexSized<0>(UInt32 accessed_index);
+#define INSTANTIATE_CACHE_SET_PLRU_SIZED(assoc) \
+   template UInt32 CacheSetPLRU::getReplacementIndexSized<assoc>(CacheCntlr *cntlr); \
+   template void CacheSetPLRU::updateReplacementIndexSized<assoc>(UInt32 accessed_index);
+CACHE_SET_SIZED_ASSOCIATIVITIES(INSTANTIATE_CACHE_SET_PLRU_SIZED)
@@ -44,3 +44,15 @@ void
 CacheSetRandom::updateReplacementIndex(UInt32 accessed_index)
 {
 }
+
+void
+CacheSetRandom::saveReplacementState(CheckpointWriter &writer)
+{
+   writer.write(m_rand);
+}
+
+void
+CacheSetRandom::loadReplacementState(CheckpointReader &reader)
+{
+   reader.read(m_rand);
+}
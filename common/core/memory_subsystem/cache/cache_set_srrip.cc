@@ -27,10 +27,10 @@ CacheSetSRRIP::~CacheSetSRRIP()
    delete [] m_rrip_bits;
 }
 
-UInt32
-CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr)
+template <UInt32 Assoc> UInt32
+CacheSetSRRIP::getReplacementIndexSized(CacheCntlr *cntlr)
 {
-   for (UInt32 i = 0; i < m_associativity; i++)
+   for (UInt32 i = 0; i < ways<Assoc>(); i++)
    {
       if (!m_cache_block_info_array[i]->isValid())
       {
@@ -45,7 +45,7 @@ CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr)
 
    for(UInt32 j = 0; j <= m_rrip_max; ++j)
    {
-      for (UInt32 i = 0; i < m_associativity; i++)
+      for (UInt32 i = 0; i < ways<Assoc>(); i++)
       {
          if (m_rrip_bits[m_replacement_pointer] >= m_rrip_max)
          {
@@ -69,7 +69,7 @@ CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr)
                continue;
             }
 
-            m_replacement_pointer = (m_replacement_pointer + 1) % m_associativity;
+            m_replacement_pointer = (m_replacement_pointer + 1) % ways<Assoc>();
             // Prepare way for a new line: set prediction to 'long'
             m_rrip_bits[index] = m_rrip_insert;
 
@@ -79,11 +79,11 @@ CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr)
             return index;
          }
 
-         m_replacement_pointer = (m_replacement_pointer + 1) % m_associativity;
+         m_replacement_pointer = (m_replacement_pointer + 1) % ways<Assoc>();
       }
 
       // Increment all RRIP counters until one hits RRIP_MAX
-      for (UInt32 i = 0; i < m_associativity; i++)
+      for (UInt32 i = 0; i < ways<Assoc>(); i++)
       {
          if (m_rrip_bits[i] < m_rrip_max)
          {
@@ -95,11 +95,32 @@ CacheSetSRRIP::getReplacementIndex(CacheCntlr *cntlr)
    LOG_PRINT_ERROR("Error finding replacement index");
 }
 
-void
-CacheSetSRRIP::updateReplacementIndex(UInt32 accessed_index)
+template <UInt32 Assoc> void
+CacheSetSRRIP::updateReplacementIndexSized(UInt32 accessed_index)
 {
    m_set_info->increment(m_rrip_bits[accessed_index]);
 
    if (m_rrip_bits[accessed_index] > 0)
       m_rrip_bits[accessed_index]--;
 }
+
+void
+CacheSetSRRIP::saveReplacementState(CheckpointWriter &writer)
+{
+   writer.write(m_rrip_bits, m_associativity);
+   writer.write(m_replacement_pointer);
+}
+
+void
+CacheSetSRRIP::loadReplacementState(CheckpointReader &reader)
+{
+   reader.read(m_rrip_bits, m_associativity);
+   reader.read(m_replacement_pointer);
+}
+
+template UInt32 CacheSetSRRIP::getReplacementIndexSized<0>(CacheCntlr *cntlr);
+template void CacheSetSRRIP::updateReplacementIndexSized<0>(UInt32 accessed_index);
+#define INSTANTIATE_CACHE_SET_SRRIP_SIZED(assoc) \
+   template UInt32 CacheSetSRRIP::getReplacementIndexSized<assoc>(CacheCntlr *cntlr); \
+   template void CacheSetSRRIP::updateReplacementIndexSized<assoc>(UInt32 accessed_index);
+CACHE_SET_SIZED_ASSOCIATIVITIES(INSTANTIATE_CACHE_SET_SRRIP_SIZED)
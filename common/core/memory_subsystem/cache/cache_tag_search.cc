@@ -0,0 +1,69 @@
+#include "cache_tag_search.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+static SInt32 searchCacheTagScalar(const IntPtr *tags, UInt32 associativity, IntPtr tag)
+{
+   for (SInt32 index = associativity-1; index >= 0; index--)
+   {
+      if (tags[index] == tag)
+         return index;
+   }
+   return -1;
+}
+
+#if defined(__x86_64__)
+
+__attribute__((target("avx2")))
+static SInt32 searchCacheTagAvx2(const IntPtr *tags, UInt32 associativity, IntPtr tag)
+{
+   const __m256i needle = _mm256_set1_epi64x(tag);
+   SInt32 index = associativity;
+   for ( ; index >= 4; index -= 4)
+   {
+      __m256i ways = _mm256_loadu_si256((const __m256i*)&tags[index - 4]);
+      int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(ways, needle)));
+      if (mask)
+         return index - 4 + 31 - __builtin_clz(mask);
+   }
+   return searchCacheTagScalar(tags, index, tag);
+}
+
+__attribute__((target("avx512f")))
+static SInt32 searchCacheTagAvx512(const IntPtr *tags, UInt32 associativity, IntPtr tag)
+{
+   const __m512i needle = _mm512_set1_epi64(tag);
+   SInt32 index = associativity;
+   for ( ; index >= 8; index -= 8)
+   {
+      __mmask8 mask = _mm512_cmpeq_epi64_mask(_mm512_loadu_si512(&tags[index - 8]), needle);
+      if (mask)
+         return index - 8 + 31 - __builtin_clz(mask);
+   }
+   return searchCacheTagAvx2(tags, index, tag);
+}
+
+#endif
+
+typedef SInt32 (*SearchCacheTagFunc)(const IntPtr *tags, UInt32 associativity, IntPtr tag);
+
+static SearchCacheTagFunc selectSearchCacheTag()
+{
+#if defined(__x86_64__)
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx512f"))
+      return searchCacheTagAvx512;
+   if (__builtin_cpu_supports("avx2"))
+      return searchCacheTagAvx2;
+#endif
+   return searchCacheTagScalar;
+}
+
+static const SearchCacheTagFunc search_cache_tag = selectSearchCacheTag();
+
+SInt32 searchCacheTag(const IntPtr *tags, UInt32 associativity, IntPtr tag)
+{
+   return search_cache_tag(tags, associativity, tag);
+}
@@ -0,0 +1,12 @@
+#ifndef CACHE_TAG_SEARCH_H
+#define CACHE_TAG_SEARCH_H
+
+#include "fixed_types.h"
+
+// Find tag in the contiguous tag array of a cache set, returns the way it is in or -1 if not found.
+// Ways are searched from the highest one down, so when a tag is present multiple times
+// (e.g. the invalid tag) the highest way is returned, as CacheSet always did.
+// Uses AVX-512 or AVX2 compares when the host supports them.
+SInt32 searchCacheTag(const IntPtr *tags, UInt32 associativity, IntPtr tag);
+
+#endif /* CACHE_TAG_SEARCH_H */
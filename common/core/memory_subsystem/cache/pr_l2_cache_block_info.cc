@@ -60,3 +60,17 @@ PrL2CacheBlockInfo::clone(CacheBlockInfo* cache_block_info)
    m_cached_loc_bitvec = ((PrL2CacheBlockInfo*) cache_block_info)->getCachedLocBitVec();
    CacheBlockInfo::clone(cache_block_info);
 }
+
+void
+PrL2CacheBlockInfo::saveState(CheckpointWriter &writer)
+{
+   CacheBlockInfo::saveState(writer);
+   writer.write(m_cached_loc_bitvec);
+}
+
+void
+PrL2CacheBlockInfo::loadState(CheckpointReader &reader)
+{
+   CacheBlockInfo::loadState(reader);
+   reader.read(m_cached_loc_bitvec);
+}
@@ -27,5 +27,8 @@ class PrL2CacheBlockInfo : public CacheBlockInfo
 
       void invalidate();
       void clone(CacheBlockInfo* cache_block_info);
+
+      void saveState(CheckpointWriter &writer);
+      void loadState(CheckpointReader &reader);
 };
 #endif /* __PR_L2_CACHE_BLOCK_INFO_H__ */
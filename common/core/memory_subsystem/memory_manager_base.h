@@ -72,6 +72,35 @@ class MemoryManagerBase
          return latency;
       }
 
+      // Functional access to the data caches for a batch of accesses (see Core::warmupMemory).
+      // Emulated here by calling into the slow interface one cache line at a time.
+      // If hit_where is not NULL, it receives where each cache line was found.
+      virtual void coreWarmupMemory(const Core::WarmupAccess *accesses, UInt32 count, HitWhere::where_t *hit_where = NULL)
+      {
+         UInt32 cache_block_size = getCacheBlockSize();
+         UInt32 line_idx = 0;
+         for(UInt32 idx = 0; idx < count; ++idx)
+         {
+            IntPtr address = accesses[idx].address, end_address = address + accesses[idx].size;
+            while(address < end_address)
+            {
+               IntPtr address_aligned = address & ~IntPtr(cache_block_size - 1);
+               UInt32 size = std::min(end_address, address_aligned + cache_block_size) - address;
+               HitWhere::where_t this_hit_where = coreInitiateMemoryAccess(
+                     MemComponent::L1_DCACHE,
+                     Core::NONE,
+                     accesses[idx].mem_op_type,
+                     address_aligned, address - address_aligned,
+                     NULL, size,
+                     Core::MEM_MODELED_COUNT);
+               if (hit_where)
+                  hit_where[line_idx] = this_hit_where;
+               ++line_idx;
+               address += size;
+            }
+         }
+      }
+
       virtual void handleMsgFromNetwork(NetPacket& packet) = 0;
 
       // FIXME: Take this out of here
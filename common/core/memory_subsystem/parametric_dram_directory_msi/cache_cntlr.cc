@@ -9,6 +9,9 @@
 #include "hooks_manager.h"
 #include "cache_atd.h"
 #include "shmem_perf.h"
+#ifdef TRACK_SETLOCK_CONTENTION
+#include "timer.h"
+#endif
 
 #include <cstring>
 
@@ -180,6 +183,8 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
                ? Sim()->getFaultinjectionManager()->getFaultInjector(m_core_id_master, mem_component)
                : NULL);
       m_master->m_prefetcher = Prefetcher::createPrefetcher(cache_params.prefetcher, cache_params.configName, m_core_id, m_shared_cores);
+      if (m_master->m_prefetcher)
+         registerCheckpointObject(name + "-prefetcher", core_id, m_master->m_prefetcher);
 
       if (Sim()->getCfg()->getBoolDefault("perf_model/" + cache_params.configName + "/atd/enabled", false))
       {
@@ -206,6 +211,9 @@ CacheCntlr::CacheCntlr(MemComponent::component_t mem_component,
       m_prefetch_on_prefetch_hit = Sim()->getCfg()->getBoolArray("perf_model/" + cache_params.configName + "/prefetcher/prefetch_on_prefetch_hit", core_id);
 
    bzero(&stats, sizeof(stats));
+   #ifdef TRACK_SETLOCK_CONTENTION
+   m_setlock_acquired = 0;
+   #endif
 
    registerStatsMetric(name, core_id, "loads", &stats.loads);
    registerStatsMetric(name, core_id, "stores", &stats.stores);
@@ -287,6 +295,15 @@ CacheCntlr::~CacheCntlr()
       it->second.print();
    }
    #endif
+   #ifdef TRACK_SETLOCK_CONTENTION
+   if (isFirstLevel())
+   {
+      printf("%2u-%s setlock wait: ", m_core_id, MemComponentString(m_mem_component));
+      m_setlock_wait.print();
+      printf("%2u-%s setlock hold: ", m_core_id, MemComponentString(m_mem_component));
+      m_setlock_hold.print();
+   }
+   #endif
 }
 
 void
@@ -345,6 +362,12 @@ LOG_ASSERT_ERROR(offset + data_length <= getCacheBlockSize(), "access until %u >
       between operationPermissibleinCache and the writethrough */
    bool lock_all = m_cache_writethrough && ((mem_op_type == Core::WRITE) || (lock_signal != Core::NONE));
 
+   /* if we're going to miss, we'll need the stack lock anyway: look at the tags without locking,
+      and take the stack lock right away instead of upgrading the set lock later on.
+      Not for atomic operations, which expect to hold just the cache lock in between their two parts */
+   if (lock_signal == Core::NONE && !lock_all && !m_perfect)
+      lock_all = m_passthrough || !probeCache(ca_address, mem_op_type);
+
     /* if this is the second part of an atomic operation: we already have the lock, don't lock again */
    if (lock_signal != Core::UNLOCK) {
       if (lock_all)
@@ -604,6 +627,133 @@ MYLOG("access done");
 }
 
 
+void
+CacheCntlr::processWarmupFromCore(const WarmupLine *lines, UInt32 count, HitWhere::where_t *hit_where)
+{
+   assert(isFirstLevel());
+
+   // Hits only touch our own tags and replacement state, so they can skip the full processMemOpFromCore path.
+   // This is what the hit path of processMemOpFromCore does with modeled == false, minus the time accounting
+   // and with the statistics collected locally. Not possible when hits have side effects beyond this cache.
+   bool fast_hits = !m_perfect && !m_passthrough && m_master->m_atds.empty()
+      && !Sim()->getConfig()->hasCacheEfficiencyCallbacks() && !Sim()->getConfig()->getCacheEfficiencyCallbacks().notify_access_func;
+   #ifdef ENABLE_TRANSITIONS
+   fast_hits = false;
+   #endif
+
+   UInt64 loads_state[CacheState::NUM_CSTATE_STATES] = { 0 }, stores_state[CacheState::NUM_CSTATE_STATES] = { 0 };
+   UInt64 hits = 0, hits_prefetch = 0;
+
+   // The SMT lock is held across a run of hits, and dropped before a miss as processMemOpFromCore takes it itself
+   bool smt_locked = false;
+
+   // The line touched by the previous access if it hit, the state it was in,
+   // and the set lock sequence number under which that state was seen
+   IntPtr last_address = INVALID_ADDRESS;
+   CacheState::cstate_t last_cstate = CacheState::INVALID;
+   SetLock *last_setlock = NULL;
+   UInt32 last_seq = 0;
+
+   for(UInt32 idx = 0; idx < count; ++idx)
+   {
+      const WarmupLine &line = lines[idx];
+      bool cache_hit = false;
+      CacheState::cstate_t cstate = CacheState::INVALID;
+
+      if (fast_hits && !(m_cache_writethrough && line.mem_op_type == Core::WRITE))
+      {
+         if (!smt_locked)
+         {
+            m_master->m_smt_lock.acquire();
+            smt_locked = true;
+         }
+
+         if (line.ca_address == last_address && last_setlock->read_validate(last_seq)
+            && (line.mem_op_type == Core::READ || CacheState(last_cstate).writable()))
+         {
+            // Same line as the previous access, and no other core changed its set since:
+            // it is still the most recently used one in the same state, nothing to update
+            cache_hit = true;
+            cstate = last_cstate;
+         }
+         else
+         {
+            // Optimistic lookup without taking the set lock, as in probeCache(). Only our own core inserts into
+            // this cache, other cores invalidate or downgrade lines only while holding the exclusive lock.
+            // If that happened during the lookup, leave this access to processMemOpFromCore.
+            SetLock *setlock = lastLevelCache()->m_master->getSetLock(line.ca_address);
+            UInt32 seq = setlock->read_begin();
+
+            CacheBlockInfo *cache_block_info;
+            cache_hit = operationPermissibleinCache(line.ca_address, line.mem_op_type, &cache_block_info);
+            if (cache_hit)
+               cstate = getCacheState(cache_block_info);
+
+            if (!setlock->read_validate(seq))
+               cache_hit = false;
+            else if (cache_hit)
+            {
+               // Should another core invalidate the line from here on, our access just happened before theirs.
+               // Invalidation only clears the tag and state, accessCache then no longer finds the line.
+               if (cache_block_info->hasOption(CacheBlockInfo::PREFETCH))
+               {
+                  ++hits_prefetch;
+                  cache_block_info->clearOption(CacheBlockInfo::PREFETCH);
+               }
+               accessCache(line.mem_op_type, line.ca_address, line.offset, NULL, line.length, true);
+               last_setlock = setlock;
+               last_seq = seq;
+            }
+         }
+      }
+
+      if (cache_hit)
+      {
+         ++hits;
+         if (line.mem_op_type == Core::WRITE)
+            ++stores_state[cstate];
+         else
+            ++loads_state[cstate];
+         last_address = line.ca_address;
+         last_cstate = cstate;
+         if (hit_where)
+            hit_where[idx] = HitWhere::where_t(m_mem_component);
+      }
+      else
+      {
+         if (smt_locked)
+         {
+            m_master->m_smt_lock.release();
+            smt_locked = false;
+         }
+         // Misses (and everything else) go through the normal path, which also keeps coherence with the other cores
+         HitWhere::where_t this_hit_where = processMemOpFromCore(Core::NONE, line.mem_op_type, line.ca_address, line.offset, NULL, line.length, false, true);
+         if (hit_where)
+            hit_where[idx] = this_hit_where;
+         last_address = INVALID_ADDRESS;
+      }
+   }
+
+   if (smt_locked)
+      m_master->m_smt_lock.release();
+
+   if (hits)
+   {
+      ScopedLock sl(getLock());
+      getCache()->updateHits(Core::READ, hits);
+      for(UInt32 state = 0; state < CacheState::NUM_CSTATE_STATES; ++state)
+      {
+         stats.loads += loads_state[state];
+         stats.loads_state[state] += loads_state[state];
+         stats.loads_where[m_mem_component] += loads_state[state];
+         stats.stores += stores_state[state];
+         stats.stores_state[state] += stores_state[state];
+         stats.stores_where[m_mem_component] += stores_state[state];
+      }
+      stats.hits_prefetch += hits_prefetch;
+   }
+}
+
 void
 CacheCntlr::updateHits(Core::mem_op_t mem_op_type, UInt64 hits)
 {
@@ -2174,6 +2324,10 @@ CacheCntlr::updateUncoreStatistics(HitWhere::where_t hit_where, SubsecondTime no
      (The above is not strictly true, but Core takes care of this since MemoryManager only has one cycle count anyway).
      On a miss, a lock upgrade is needed.
    - Other levels, or the first level on miss, acquire the lock in exclusive mode which locks out both L1-only and L2+ transactions.
+   - Before locking, a first-level cache probes its own tags without any lock (probeCache(), validated by the set lock's
+     sequence counter) to pick shared or exclusive mode up front. Lookups in the shared levels are not done optimistically:
+     they only happen after a first-level miss, which moves lines and changes directory state, so they stay serialized
+     per set under the exclusive lock.
    #ifdef PRIVATE_L2_OPTIMIZATION
    - (On Nehalem, the L2 is private so it is only the L3 (the first level with m_sharing_cores > 1) that takes the exclusive lock).
    #endif
@@ -2182,13 +2336,39 @@ CacheCntlr::updateUncoreStatistics(HitWhere::where_t hit_where, SubsecondTime no
    use getLock() for this. This is required for statistics updates, the directory waiters queue, etc.
 */
 
+bool
+CacheCntlr::probeCache(IntPtr address, Core::mem_op_t mem_op_type)
+{
+   assert(isFirstLevel());
+   // Optimistic, lock-free tag lookup. Other cores only change our state while holding the stack lock,
+   // which bumps the set lock's sequence number, so retry if that happened while we were looking.
+   SetLock *setlock = lastLevelCache()->m_master->getSetLock(address);
+   UInt32 seq;
+   bool cache_hit;
+   do
+   {
+      seq = setlock->read_begin();
+      cache_hit = operationPermissibleinCache(address, mem_op_type);
+   }
+   while(!setlock->read_validate(seq));
+MYLOG("cache probe %u # %u @ %lx: %d", m_mem_component, m_core_id, address, cache_hit);
+   return cache_hit;
+}
+
 void
 CacheCntlr::acquireLock(UInt64 address)
 {
 MYLOG("cache lock acquire %u # %u @ %lx", m_mem_component, m_core_id, address);
    assert(isFirstLevel());
+   #ifdef TRACK_SETLOCK_CONTENTION
+   UInt64 t_start = rdtsc();
+   #endif
    // Lock this L1 cache for the set containing <address>.
    lastLevelCache()->m_master->getSetLock(address)->acquire_shared(m_core_id);
+   #ifdef TRACK_SETLOCK_CONTENTION
+   m_setlock_acquired = rdtsc();
+   m_setlock_wait.update(m_setlock_acquired - t_start);
+   #endif
 }
 
 void
@@ -2196,6 +2376,11 @@ CacheCntlr::releaseLock(UInt64 address)
 {
 MYLOG("cache lock release %u # %u @ %lx", m_mem_component, m_core_id, address);
    assert(isFirstLevel());
+   #ifdef TRACK_SETLOCK_CONTENTION
+   if (m_setlock_acquired)
+      m_setlock_hold.update(rdtsc() - m_setlock_acquired);
+   m_setlock_acquired = 0;
+   #endif
    lastLevelCache()->m_master->getSetLock(address)->release_shared(m_core_id);
 }
 
@@ -2203,6 +2388,9 @@ void
 CacheCntlr::acquireStackLock(UInt64 address, bool this_is_locked)
 {
 MYLOG("stack lock acquire %u # %u @ %lx", m_mem_component, m_core_id, address);
+   #ifdef TRACK_SETLOCK_CONTENTION
+   UInt64 t_start = rdtsc();
+   #endif
    // Lock the complete stack for the set containing <address>
    if (this_is_locked)
       // If two threads decide to upgrade at the same time, we could deadlock.
@@ -2210,12 +2398,25 @@ MYLOG("stack lock acquire %u # %u @ %lx", m_mem_component, m_core_id, address);
       lastLevelCache()->m_master->getSetLock(address)->upgrade(m_core_id);
    else
       lastLevelCache()->m_master->getSetLock(address)->acquire_exclusive();
+   #ifdef TRACK_SETLOCK_CONTENTION
+   UInt64 t_now = rdtsc();
+   m_setlock_wait.update(t_now - t_start);
+   if (!this_is_locked)
+      m_setlock_acquired = t_now;
+   #endif
 }
 
 void
 CacheCntlr::releaseStackLock(UInt64 address, bool this_is_locked)
 {
 MYLOG("stack lock release %u # %u @ %lx", m_mem_component, m_core_id, address);
+   #ifdef TRACK_SETLOCK_CONTENTION
+   if (!this_is_locked && m_setlock_acquired)
+   {
+      m_setlock_hold.update(rdtsc() - m_setlock_acquired);
+      m_setlock_acquired = 0;
+   }
+   #endif
    if (this_is_locked)
       lastLevelCache()->m_master->getSetLock(address)->downgrade(m_core_id);
    else
@@ -29,6 +29,9 @@ class ATD;
 /* Enable to track latency by HitWhere */
 //#define TRACK_LATENCY_BY_HITWHERE
 
+/* Enable to get histograms of set lock wait and hold times (in rdtsc cycles) */
+//#define TRACK_SETLOCK_CONTENTION
+
 // Forward declarations
 namespace ParametricDramDirectoryMSI
 {
@@ -146,6 +149,13 @@ namespace ParametricDramDirectoryMSI
    };
    typedef std::unordered_map<IntPtr, MshrEntry> Mshr;
 
+   // Part of a functional warmup access that falls within one cache line
+   struct WarmupLine {
+      IntPtr ca_address;
+      UInt32 offset, length;
+      Core::mem_op_t mem_op_type;
+   };
+
    class CacheMasterCntlr
    {
       private:
@@ -248,6 +258,10 @@ namespace ParametricDramDirectoryMSI
          #ifdef TRACK_LATENCY_BY_HITWHERE
          std::unordered_map<HitWhere::where_t, StatHist> lat_by_where;
          #endif
+         #ifdef TRACK_SETLOCK_CONTENTION
+         StatHist m_setlock_wait, m_setlock_hold;
+         UInt64 m_setlock_acquired;
+         #endif
 
          void updateCounters(Core::mem_op_t mem_op_type, IntPtr address, bool cache_hit, CacheState::cstate_t state, Prefetch::prefetch_type_t isPrefetch);
          void cleanupMshr();
@@ -379,6 +393,9 @@ namespace ParametricDramDirectoryMSI
                Byte* data_buf, UInt32 data_length,
                bool modeled,
                bool count);
+         // Functional warmup (counted, not modeled) of a batch of accesses in order, hits are handled without the full access path.
+         // If hit_where is not NULL, it receives where each line was found.
+         void processWarmupFromCore(const WarmupLine *lines, UInt32 count, HitWhere::where_t *hit_where = NULL);
          void updateHits(Core::mem_op_t mem_op_type, UInt64 hits);
 
          // Notify next level cache of so it can update its sharing set
@@ -388,6 +405,7 @@ namespace ParametricDramDirectoryMSI
          // Handle message from Dram Dir
          void handleMsgFromDramDirectory(core_id_t sender, PrL1PrL2DramDirectoryMSI::ShmemMsg* shmem_msg);
          // Acquiring and Releasing per-set Locks
+         bool probeCache(IntPtr address, Core::mem_op_t mem_op_type);
          void acquireLock(UInt64 address);
          void releaseLock(UInt64 address);
          void acquireStackLock(UInt64 address, bool this_is_locked = false);
@@ -135,3 +135,29 @@ GhbPrefetcher::getNextAddress(IntPtr currentAddress, core_id_t core_id)
 
    return prefetchList;
 }
+
+void
+GhbPrefetcher::saveState(CheckpointWriter &writer)
+{
+   writer.write<UInt64>(m_ghbSize);
+   writer.write<UInt64>(m_tableSize);
+   writer.write(m_lastAddress);
+   writer.write(m_ghbHead);
+   writer.write(m_generation);
+   writer.write(m_tableHead);
+   writer.writeVector(m_ghb);
+   writer.writeVector(m_ghbTable);
+}
+
+void
+GhbPrefetcher::loadState(CheckpointReader &reader)
+{
+   if (!reader.check(m_ghbSize, "history buffer size") || !reader.check(m_tableSize, "table size"))
+      return;
+   reader.read(m_lastAddress);
+   reader.read(m_ghbHead);
+   reader.read(m_generation);
+   reader.read(m_tableHead);
+   reader.readVector(m_ghb);
+   reader.readVector(m_ghbTable);
+}
@@ -9,6 +9,9 @@ class GhbPrefetcher : public Prefetcher
       GhbPrefetcher(String configName, core_id_t core_id);
       std::vector<IntPtr> getNextAddress(IntPtr currentAddress, core_id_t core_id);
 
+      void saveState(CheckpointWriter &writer);
+      void loadState(CheckpointReader &reader);
+
       ~GhbPrefetcher();
 
    private:
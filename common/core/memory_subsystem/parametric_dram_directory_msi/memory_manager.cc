@@ -4,6 +4,7 @@
 #include "nuca_cache.h"
 #include "dram_cache.h"
 #include "tlb.h"
+#include "page_table_walker.h"
 #include "simulator.h"
 #include "log.h"
 #include "dvfs_manager.h"
@@ -29,6 +30,7 @@ namespace ParametricDramDirectoryMSI
 {
 
 std::map<CoreComponentType, CacheCntlr*> MemoryManager::m_all_cache_cntlrs;
+PageTable* MemoryManager::m_page_table = NULL;
 
 MemoryManager::MemoryManager(Core* core,
       Network* network, ShmemPerfModel* shmem_perf_model):
@@ -38,6 +40,7 @@ MemoryManager::MemoryManager(Core* core,
    m_dram_directory_cntlr(NULL),
    m_dram_cntlr(NULL),
    m_itlb(NULL), m_dtlb(NULL), m_stlb(NULL),
+   m_page_table_walker(NULL),
    m_tlb_miss_penalty(NULL,0),
    m_tlb_miss_parallel(false),
    m_tag_directory_present(false),
@@ -69,15 +72,19 @@ MemoryManager::MemoryManager(Core* core,
 
       m_last_level_cache = (MemComponent::component_t)(Sim()->getCfg()->getInt("perf_model/cache/levels") - 2 + MemComponent::L2_CACHE);
 
+      // All cores share the same address space, and hence the same page table
+      if (Sim()->getCfg()->getBool("perf_model/ptw/enabled") && !m_page_table)
+         m_page_table = new PageTable();
+
       UInt32 stlb_size = Sim()->getCfg()->getInt("perf_model/stlb/size");
       if (stlb_size)
-         m_stlb = new TLB("stlb", "perf_model/stlb", getCore()->getId(), stlb_size, Sim()->getCfg()->getInt("perf_model/stlb/associativity"), NULL);
+         m_stlb = new TLB("stlb", "perf_model/stlb", getCore()->getId(), stlb_size, Sim()->getCfg()->getInt("perf_model/stlb/associativity"), NULL, m_page_table);
       UInt32 itlb_size = Sim()->getCfg()->getInt("perf_model/itlb/size");
       if (itlb_size)
-         m_itlb = new TLB("itlb", "perf_model/itlb", getCore()->getId(), itlb_size, Sim()->getCfg()->getInt("perf_model/itlb/associativity"), m_stlb);
+         m_itlb = new TLB("itlb", "perf_model/itlb", getCore()->getId(), itlb_size, Sim()->getCfg()->getInt("perf_model/itlb/associativity"), m_stlb, m_page_table);
       UInt32 dtlb_size = Sim()->getCfg()->getInt("perf_model/dtlb/size");
       if (dtlb_size)
-         m_dtlb = new TLB("dtlb", "perf_model/dtlb", getCore()->getId(), dtlb_size, Sim()->getCfg()->getInt("perf_model/dtlb/associativity"), m_stlb);
+         m_dtlb = new TLB("dtlb", "perf_model/dtlb", getCore()->getId(), dtlb_size, Sim()->getCfg()->getInt("perf_model/dtlb/associativity"), m_stlb, m_page_table);
       m_tlb_miss_penalty = ComponentLatency(core->getDvfsDomain(), Sim()->getCfg()->getInt("perf_model/tlb/penalty"));
       m_tlb_miss_parallel = Sim()->getCfg()->getBool("perf_model/tlb/penalty_parallel");
 
@@ -231,7 +238,8 @@ MemoryManager::MemoryManager(Core* core,
 
       m_dram_cntlr = new PrL1PrL2DramDirectoryMSI::DramCntlr(this,
             getShmemPerfModel(),
-            getCacheBlockSize());
+            getCacheBlockSize(),
+            m_dram_controller_home_lookup);
       Sim()->getStatsManager()->logTopology("dram-cntlr", core->getId(), core->getId());
 
       if (Sim()->getCfg()->getBoolArray("perf_model/dram/cache/enabled", core->getId()))
@@ -308,6 +316,11 @@ MemoryManager::MemoryManager(Core* core,
       m_cache_cntlrs[(MemComponent::component_t)(i + 1)]->setPrevCacheCntlrs(prev_cache_cntlrs);
    }
 
+   // Page table entries are loaded through the L1-D cache
+   if (m_page_table && (m_itlb || m_dtlb))
+      m_page_table_walker = new PageTableWalker(getCore()->getId(), m_cache_cntlrs[MemComponent::L1_DCACHE], getShmemPerfModel(), m_page_table,
+         ComponentLatency(core->getDvfsDomain(), Sim()->getCfg()->getInt("perf_model/ptw/overhead")));
+
    // Create Performance Models
    for(UInt32 i = MemComponent::FIRST_LEVEL_CACHE; i <= (UInt32)m_last_level_cache; ++i)
       m_cache_perf_models[(MemComponent::component_t)i] = CachePerfModel::create(
@@ -386,6 +399,7 @@ MemoryManager::~MemoryManager()
    if (m_itlb) delete m_itlb;
    if (m_dtlb) delete m_dtlb;
    if (m_stlb) delete m_stlb;
+   if (m_page_table_walker) delete m_page_table_walker;
 
    for(i = MemComponent::FIRST_LEVEL_CACHE; i <= (UInt32)m_last_level_cache; ++i)
    {
@@ -440,6 +454,31 @@ MemoryManager::coreInitiateMemoryAccess(
          modeled == Core::MEM_MODELED_NONE ? false : true);
 }
 
+void
+MemoryManager::coreWarmupMemory(const Core::WarmupAccess *accesses, UInt32 count, HitWhere::where_t *hit_where)
+{
+   m_warmup_lines.clear();
+   for(UInt32 idx = 0; idx < count; ++idx)
+   {
+      IntPtr address = accesses[idx].address, end_address = address + accesses[idx].size;
+      while(address < end_address)
+      {
+         WarmupLine line;
+         line.ca_address = address & ~IntPtr(m_cache_block_size - 1);
+         line.offset = address - line.ca_address;
+         line.length = std::min(end_address, line.ca_address + m_cache_block_size) - address;
+         line.mem_op_type = accesses[idx].mem_op_type;
+         m_warmup_lines.push_back(line);
+         address += line.length;
+
+         if (m_dtlb)
+            accessTLB(m_dtlb, line.ca_address, false, Core::MEM_MODELED_COUNT);
+      }
+   }
+
+   m_cache_cntlrs[MemComponent::L1_DCACHE]->processWarmupFromCore(m_warmup_lines.data(), m_warmup_lines.size(), hit_where);
+}
+
 void
 MemoryManager::handleMsgFromNetwork(NetPacket& packet)
 {
@@ -590,18 +629,25 @@ void
 MemoryManager::accessTLB(TLB * tlb, IntPtr address, bool isIfetch, Core::MemModeled modeled)
 {
    bool hit = tlb->lookup(address, getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD));
+   bool timed = !(modeled == Core::MEM_MODELED_NONE || modeled == Core::MEM_MODELED_COUNT);
+   SubsecondTime latency = m_tlb_miss_penalty.getLatency();
+
+   // Walk the page table through the cache hierarchy, also when not timed so the caches see the page table entries
+   if (hit == false && m_page_table_walker)
+      latency = m_page_table_walker->walk(address, timed, modeled != Core::MEM_MODELED_NONE);
+
    if (hit == false
-       && !(modeled == Core::MEM_MODELED_NONE || modeled == Core::MEM_MODELED_COUNT)
-       && m_tlb_miss_penalty.getLatency() != SubsecondTime::Zero()
+       && timed
+       && latency != SubsecondTime::Zero()
    )
    {
       if (m_tlb_miss_parallel)
       {
-         incrElapsedTime(m_tlb_miss_penalty.getLatency(), ShmemPerfModel::_USER_THREAD);
+         incrElapsedTime(latency, ShmemPerfModel::_USER_THREAD);
       }
       else
       {
-         PseudoInstruction *i = new TLBMissInstruction(m_tlb_miss_penalty.getLatency(), isIfetch);
+         PseudoInstruction *i = new TLBMissInstruction(latency, isIfetch);
          getCore()->getPerformanceModel()->queuePseudoInstruction(i);
       }
    }
@@ -22,6 +22,8 @@ class ShmemPerf;
 namespace ParametricDramDirectoryMSI
 {
    class TLB;
+   class PageTable;
+   class PageTableWalker;
 
    typedef std::pair<core_id_t, MemComponent::component_t> CoreComponentType;
    typedef std::map<CoreComponentType, CacheCntlr*> CacheCntlrMap;
@@ -37,6 +39,7 @@ namespace ParametricDramDirectoryMSI
          AddressHomeLookup* m_tag_directory_home_lookup;
          AddressHomeLookup* m_dram_controller_home_lookup;
          TLB *m_itlb, *m_dtlb, *m_stlb;
+         PageTableWalker *m_page_table_walker;
          ComponentLatency m_tlb_miss_penalty;
          bool m_tlb_miss_parallel;
 
@@ -54,11 +57,15 @@ namespace ParametricDramDirectoryMSI
 
          ShmemPerf m_dummy_shmem_perf;
 
+         // Scratch space for coreWarmupMemory
+         std::vector<WarmupLine> m_warmup_lines;
+
          // Performance Models
          CachePerfModel* m_cache_perf_models[MemComponent::LAST_LEVEL_CACHE + 1];
 
          // Global map of all caches on all cores (within this process!)
          static CacheCntlrMap m_all_cache_cntlrs;
+         static PageTable *m_page_table;
 
          void accessTLB(TLB * tlb, IntPtr address, bool isIfetch, Core::MemModeled modeled);
 
@@ -89,6 +96,7 @@ namespace ParametricDramDirectoryMSI
                IntPtr address, UInt32 offset,
                Byte* data_buf, UInt32 data_length,
                Core::MemModeled modeled);
+         void coreWarmupMemory(const Core::WarmupAccess *accesses, UInt32 count, HitWhere::where_t *hit_where);
 
          void handleMsgFromNetwork(NetPacket& packet);
 
@@ -0,0 +1,213 @@
+#include "page_table_walker.h"
+#include "cache_cntlr.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "stats.h"
+#include "log.h"
+
+namespace ParametricDramDirectoryMSI
+{
+
+const char*
+PageTable::LevelString(level_t level)
+{
+   switch(level)
+   {
+      case PT:    return "pt";
+      case PD:    return "pd";
+      case PDP:   return "pdp";
+      case PML4:  return "pml4";
+      default:    return "?";
+   }
+}
+
+PageTable::PageTable()
+   : m_thp_threshold(Sim()->getCfg()->getInt("perf_model/ptw/thp_threshold"))
+   , m_next_table(TABLE_BASE)
+{
+   UInt64 page_size = Sim()->getCfg()->getInt("perf_model/ptw/page_size");
+   if (page_size == 1ULL << getLevelShift(PT))
+      m_page_shift = getLevelShift(PT);
+   else if (page_size == 1ULL << getLevelShift(PD))
+      m_page_shift = getLevelShift(PD);
+   else if (page_size == 1ULL << getLevelShift(PDP))
+      m_page_shift = getLevelShift(PDP);
+   else
+      LOG_PRINT_ERROR("Invalid perf_model/ptw/page_size %" PRIu64 ", should be 4096, 2097152 or 1073741824", page_size);
+
+   LOG_ASSERT_ERROR(m_thp_threshold <= (1 << LEVEL_BITS), "perf_model/ptw/thp_threshold should be at most %u", 1 << LEVEL_BITS);
+   if (m_page_shift != getLevelShift(PT))
+      m_thp_threshold = 0;
+
+   m_page_shifts.push_back(m_page_shift);
+   if (m_thp_threshold)
+      m_page_shifts.push_back(getLevelShift(PD));
+}
+
+UInt32
+PageTable::getPageShift(IntPtr address)
+{
+   if (!m_thp_threshold)
+      return m_page_shift;
+
+   ScopedLock sl(m_lock);
+   return m_thp_regions.count(address >> getLevelShift(PD)) ? getLevelShift(PD) : getLevelShift(PT);
+}
+
+UInt32
+PageTable::walk(IntPtr address)
+{
+   if (!m_thp_threshold)
+      return m_page_shift;
+
+   ScopedLock sl(m_lock);
+
+   IntPtr region = address >> getLevelShift(PD);
+   if (m_thp_regions.count(region))
+      return getLevelShift(PD);
+
+   std::bitset<1 << LEVEL_BITS> &pages = m_thp_candidates[region];
+   pages.set((address >> getLevelShift(PT)) & ((1 << LEVEL_BITS) - 1));
+   if (pages.count() < m_thp_threshold)
+      return getLevelShift(PT);
+
+   // Enough of this region is in use, back it with a huge page from now on
+   m_thp_candidates.erase(region);
+   m_thp_regions[region] = true;
+   return getLevelShift(PD);
+}
+
+IntPtr
+PageTable::getEntryAddress(level_t level, IntPtr address)
+{
+   ScopedLock sl(m_lock);
+
+   IntPtr table = address >> getLevelShift(level_t(level + 1));
+   std::unordered_map<IntPtr, IntPtr>::iterator it = m_tables[level].find(table);
+   if (it == m_tables[level].end())
+   {
+      it = m_tables[level].insert(std::make_pair(table, m_next_table)).first;
+      m_next_table += 1 << BASE_PAGE_SHIFT;
+   }
+
+   return it->second + ((address >> getLevelShift(level)) & ((1 << LEVEL_BITS) - 1)) * sizeof(UInt64);
+}
+
+
+PageTableWalker::PageTableWalker(core_id_t core_id, CacheCntlr *cache_cntlr, ShmemPerfModel *shmem_perf_model, PageTable *page_table, ComponentLatency overhead)
+   : m_cache_cntlr(cache_cntlr)
+   , m_shmem_perf_model(shmem_perf_model)
+   , m_page_table(page_table)
+   , m_overhead(overhead)
+   , m_cache_block_size(Sim()->getCfg()->getInt("perf_model/l1_dcache/cache_block_size"))
+   , m_walks(0)
+   , m_walk_latency(SubsecondTime::Zero())
+{
+   static const char* page_size_names[] = { "4kb", "2mb", "1gb" };
+
+   for(int level = PageTable::PT; level < PageTable::NUM_LEVELS; ++level)
+   {
+      String level_name = PageTable::LevelString(PageTable::level_t(level));
+
+      m_walk_caches[level] = NULL;
+      m_walks_by_size[level] = 0;
+      m_loads[level] = 0;
+      m_latency[level] = SubsecondTime::Zero();
+      m_walk_cache_hits[level] = 0;
+      m_walk_cache_accesses[level] = 0;
+
+      registerStatsMetric("ptw", core_id, level_name + "-loads", &m_loads[level]);
+      registerStatsMetric("ptw", core_id, level_name + "-latency", &m_latency[level]);
+
+      if (level < PageTable::PML4)
+         registerStatsMetric("ptw", core_id, String("walks-") + page_size_names[level], &m_walks_by_size[level]);
+
+      if (level > PageTable::PT)
+      {
+         UInt32 entries = Sim()->getCfg()->getInt("perf_model/ptw/" + level_name + "_cache_entries");
+         if (entries)
+            m_walk_caches[level] = new Cache("ptw-" + level_name + "-cache", "perf_model/ptw", core_id, 1, entries,
+               1 << PageTable::BASE_PAGE_SHIFT, "lru", CacheBase::PR_L1_CACHE);
+         registerStatsMetric("ptw", core_id, level_name + "-cache-accesses", &m_walk_cache_accesses[level]);
+         registerStatsMetric("ptw", core_id, level_name + "-cache-hits", &m_walk_cache_hits[level]);
+      }
+   }
+
+   registerStatsMetric("ptw", core_id, "walks", &m_walks);
+   registerStatsMetric("ptw", core_id, "walk-latency", &m_walk_latency);
+}
+
+PageTableWalker::~PageTableWalker()
+{
+   for(int level = PageTable::PT; level < PageTable::NUM_LEVELS; ++level)
+      if (m_walk_caches[level])
+         delete m_walk_caches[level];
+}
+
+SubsecondTime
+PageTableWalker::walk(IntPtr address, bool modeled, bool count)
+{
+   SubsecondTime t_start = m_shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+
+   UInt32 page_shift = m_page_table->walk(address);
+   int leaf = PageTable::PT;
+   while(PageTable::getLevelShift(PageTable::level_t(leaf)) < page_shift)
+      ++leaf;
+
+   // The walk starts below the deepest level that hits in its walk cache, or at the root
+   int start = PageTable::PML4;
+   for(int level = leaf + 1; level < PageTable::NUM_LEVELS; ++level)
+   {
+      if (!m_walk_caches[level])
+         continue;
+      if (count)
+         ++m_walk_cache_accesses[level];
+      IntPtr key = (address >> PageTable::getLevelShift(PageTable::level_t(level))) << PageTable::BASE_PAGE_SHIFT;
+      if (m_walk_caches[level]->accessSingleLine(key, Cache::LOAD, NULL, 0, t_start, true))
+      {
+         if (count)
+            ++m_walk_cache_hits[level];
+         start = level - 1;
+         break;
+      }
+   }
+
+   // Each entry points to the next table, so loads are serialized
+   for(int level = start; level >= leaf; --level)
+   {
+      IntPtr entry = m_page_table->getEntryAddress(PageTable::level_t(level), address);
+      SubsecondTime t_load = m_shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+
+      m_cache_cntlr->processMemOpFromCore(Core::NONE, Core::READ,
+         entry & ~IntPtr(m_cache_block_size - 1), entry & (m_cache_block_size - 1), NULL, sizeof(UInt64), modeled, count);
+
+      if (count)
+      {
+         ++m_loads[level];
+         m_latency[level] += m_shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD) - t_load;
+      }
+
+      if (level > leaf && m_walk_caches[level])
+      {
+         bool eviction;
+         IntPtr evict_addr;
+         CacheBlockInfo evict_block_info;
+         IntPtr key = (address >> PageTable::getLevelShift(PageTable::level_t(level))) << PageTable::BASE_PAGE_SHIFT;
+         m_walk_caches[level]->insertSingleLine(key, NULL, &eviction, &evict_addr, &evict_block_info, NULL, t_load);
+      }
+   }
+
+   SubsecondTime latency = m_shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD) - t_start + m_overhead.getLatency();
+   m_shmem_perf_model->setElapsedTime(ShmemPerfModel::_USER_THREAD, t_start);
+
+   if (count)
+   {
+      ++m_walks;
+      ++m_walks_by_size[leaf];
+      m_walk_latency += latency;
+   }
+
+   return latency;
+}
+
+}
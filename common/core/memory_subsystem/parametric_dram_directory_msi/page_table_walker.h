@@ -0,0 +1,108 @@
+#ifndef PAGE_TABLE_WALKER_H
+#define PAGE_TABLE_WALKER_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "lock.h"
+#include "cache.h"
+#include "shmem_perf_model.h"
+
+#include <vector>
+#include <bitset>
+#include <unordered_map>
+
+namespace ParametricDramDirectoryMSI
+{
+   class CacheCntlr;
+
+   // Radix page table (perf_model/ptw)
+   //
+   // Models the layout of an x86-64 4-level page table so page walks can load real page table entries
+   // through the cache hierarchy. Page table pages are allocated on first use in a region of (kernel)
+   // address space that applications never touch, so a table's 512 entries share cache lines just like
+   // on real hardware. All mappings use perf_model/ptw/page_size, or, with 4 KB pages and a non-zero
+   // perf_model/ptw/thp_threshold, 2 MB regions are promoted to a huge page once page walks have been
+   // done for that many of their 4 KB pages (like transparent huge pages).
+   // There is a single page table, shared by all cores.
+
+   class PageTable
+   {
+      public:
+         enum level_t {
+            PT = 0,     // Page table, maps 4 KB pages
+            PD,         // Page directory, maps page tables or 2 MB pages
+            PDP,        // Page directory pointer table, maps page directories or 1 GB pages
+            PML4,       // Page map level 4, the root
+            NUM_LEVELS
+         };
+         static const char* LevelString(level_t level);
+
+         static const UInt32 BASE_PAGE_SHIFT = 12;
+         static const UInt32 LEVEL_BITS = 9;
+         static const IntPtr TABLE_BASE = 0xffff880000000000ULL;
+
+         static UInt32 getLevelShift(level_t level) { return BASE_PAGE_SHIFT + LEVEL_BITS * level; }
+
+         PageTable();
+
+         // Page sizes that may be in use (as shift amounts, smallest first)
+         const std::vector<UInt32>& getPageShifts() const { return m_page_shifts; }
+         // Size of the page that maps <address>
+         UInt32 getPageShift(IntPtr address);
+         // Record a page walk for <address> and return the size of the page that maps it
+         UInt32 walk(IntPtr address);
+         // Address of the entry for <address> in the table at <level>
+         IntPtr getEntryAddress(level_t level, IntPtr address);
+
+      private:
+         Lock m_lock;
+         UInt32 m_page_shift;
+         UInt32 m_thp_threshold;
+         std::vector<UInt32> m_page_shifts;
+         IntPtr m_next_table;
+         // Base address of each table page, by level and (address >> getLevelShift(level + 1))
+         std::unordered_map<IntPtr, IntPtr> m_tables[NUM_LEVELS];
+         // Promotion candidates: 4 KB pages walked in each 2 MB region, and regions backed by a huge page
+         std::unordered_map<IntPtr, std::bitset<1 << LEVEL_BITS> > m_thp_candidates;
+         std::unordered_map<IntPtr, bool> m_thp_regions;
+   };
+
+   // Hardware page table walker (perf_model/ptw)
+   //
+   // Walks the page table on a miss in the last-level TLB, loading one entry per level through the L1-D
+   // cache, each load depending on the previous one. Page walk caches for the PML4, PDP and PD levels
+   // (perf_model/ptw/<level>_cache_entries, fully associative, LRU) hold the upper-level entries of recent
+   // walks, so a walk only needs to load the entries below the deepest level that hits.
+   // Statistics for each level are kept in ptw[core]: entry loads, the time spent on them, and walk cache hits.
+
+   class PageTableWalker
+   {
+      public:
+         PageTableWalker(core_id_t core_id, CacheCntlr *cache_cntlr, ShmemPerfModel *shmem_perf_model, PageTable *page_table, ComponentLatency overhead);
+         ~PageTableWalker();
+
+         // Walk the page table for <address> starting at the current time of the user thread, and return the walk's latency.
+         // The time of the user thread is left unchanged, the caller decides how to account for the latency.
+         SubsecondTime walk(IntPtr address, bool modeled, bool count);
+
+      private:
+         CacheCntlr *m_cache_cntlr;
+         ShmemPerfModel *m_shmem_perf_model;
+         PageTable *m_page_table;
+         ComponentLatency m_overhead;
+         const UInt32 m_cache_block_size;
+
+         // Page walk caches, indexed by level (none for the PT level)
+         Cache *m_walk_caches[PageTable::NUM_LEVELS];
+
+         UInt64 m_walks;
+         UInt64 m_walks_by_size[PageTable::NUM_LEVELS];
+         SubsecondTime m_walk_latency;
+         UInt64 m_loads[PageTable::NUM_LEVELS];
+         SubsecondTime m_latency[PageTable::NUM_LEVELS];
+         UInt64 m_walk_cache_hits[PageTable::NUM_LEVELS];
+         UInt64 m_walk_cache_accesses[PageTable::NUM_LEVELS];
+   };
+}
+
+#endif // PAGE_TABLE_WALKER_H
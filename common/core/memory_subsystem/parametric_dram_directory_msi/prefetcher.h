@@ -2,15 +2,19 @@
 #define PREFETCHER_H
 
 #include "fixed_types.h"
+#include "checkpoint.h"
 
 #include <vector>
 
-class Prefetcher
+class Prefetcher : public Checkpointable
 {
    public:
       static Prefetcher* createPrefetcher(String type, String configName, core_id_t core_id, UInt32 shared_cores);
 
       virtual std::vector<IntPtr> getNextAddress(IntPtr current_address, core_id_t core_id) = 0;
+
+      virtual void saveState(CheckpointWriter &writer) {}
+      virtual void loadState(CheckpointReader &reader) {}
 };
 
 #endif // PREFETCHER_H
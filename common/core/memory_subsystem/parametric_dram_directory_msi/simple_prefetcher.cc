@@ -62,3 +62,23 @@ SimplePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id)
 
    return addresses;
 }
+
+void
+SimplePrefetcher::saveState(CheckpointWriter &writer)
+{
+   writer.write<UInt64>(m_prev_address.size());
+   writer.write<UInt64>(n_flows);
+   writer.write(n_flow_next);
+   for(UInt32 idx = 0; idx < m_prev_address.size(); ++idx)
+      writer.writeVector(m_prev_address[idx]);
+}
+
+void
+SimplePrefetcher::loadState(CheckpointReader &reader)
+{
+   if (!reader.check(m_prev_address.size(), "number of cores") || !reader.check(n_flows, "number of flows"))
+      return;
+   reader.read(n_flow_next);
+   for(UInt32 idx = 0; idx < m_prev_address.size(); ++idx)
+      reader.readVector(m_prev_address[idx]);
+}
@@ -1,19 +1,26 @@
 #include "tlb.h"
+#include "page_table_walker.h"
 #include "stats.h"
 
 namespace ParametricDramDirectoryMSI
 {
 
-TLB::TLB(String name, String cfgname, core_id_t core_id, UInt32 num_entries, UInt32 associativity, TLB *next_level)
+TLB::TLB(String name, String cfgname, core_id_t core_id, UInt32 num_entries, UInt32 associativity, TLB *next_level, PageTable *page_table)
    : m_size(num_entries)
    , m_associativity(associativity)
    , m_cache(name + "_cache", cfgname, core_id, num_entries / associativity, associativity, SIM_PAGE_SIZE, "lru", CacheBase::PR_L1_CACHE)
    , m_next_level(next_level)
+   , m_page_table(page_table)
    , m_access(0)
    , m_miss(0)
 {
    LOG_ASSERT_ERROR((num_entries / associativity) * associativity == num_entries, "Invalid TLB configuration: num_entries(%d) must be a multiple of the associativity(%d)", num_entries, associativity);
 
+   if (m_page_table)
+      m_page_shifts = m_page_table->getPageShifts();
+   else
+      m_page_shifts.push_back(SIM_PAGE_SHIFT);
+
    registerStatsMetric(name, core_id, "access", &m_access);
    registerStatsMetric(name, core_id, "miss", &m_miss);
 }
@@ -21,7 +28,9 @@ TLB::TLB(String name, String cfgname, core_id_t core_id, UInt32 num_entries, UIn
 bool
 TLB::lookup(IntPtr address, SubsecondTime now, bool allocate_on_miss)
 {
-   bool hit = m_cache.accessSingleLine(address, Cache::LOAD, NULL, 0, now, true);
+   bool hit = false;
+   for(std::vector<UInt32>::const_iterator it = m_page_shifts.begin(); it != m_page_shifts.end() && !hit; ++it)
+      hit = m_cache.accessSingleLine(getKey(address, *it), Cache::LOAD, NULL, 0, now, true);
 
    m_access++;
 
@@ -37,19 +46,19 @@ TLB::lookup(IntPtr address, SubsecondTime now, bool allocate_on_miss)
 
    if (allocate_on_miss)
    {
-      allocate(address, now);
+      allocate(getKey(address, m_page_table ? m_page_table->getPageShift(address) : SIM_PAGE_SHIFT), now);
    }
 
    return hit;
 }
 
 void
-TLB::allocate(IntPtr address, SubsecondTime now)
+TLB::allocate(IntPtr key, SubsecondTime now)
 {
    bool eviction;
    IntPtr evict_addr;
    CacheBlockInfo evict_block_info;
-   m_cache.insertSingleLine(address, NULL, &eviction, &evict_addr, &evict_block_info, NULL, now);
+   m_cache.insertSingleLine(key, NULL, &eviction, &evict_addr, &evict_block_info, NULL, now);
 
    // Use next level as a victim cache
    if (eviction && m_next_level)
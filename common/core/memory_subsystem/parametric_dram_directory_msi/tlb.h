@@ -4,26 +4,39 @@
 #include "fixed_types.h"
 #include "cache.h"
 
+#include <vector>
+
 namespace ParametricDramDirectoryMSI
 {
+   class PageTable;
+
+   // Translations for pages of different sizes share the same entries. An entry is keyed by its
+   // page number and page size, so a lookup probes once for each page size that may be in use.
    class TLB
    {
       private:
          static const UInt32 SIM_PAGE_SHIFT = 12; // 4KB
          static const IntPtr SIM_PAGE_SIZE = (1L << SIM_PAGE_SHIFT);
          static const IntPtr SIM_PAGE_MASK = ~(SIM_PAGE_SIZE - 1);
+         static const UInt32 KEY_SIZE_SHIFT = 58; // Page size goes in the top bits of an entry's key
 
          UInt32 m_size;
          UInt32 m_associativity;
          Cache m_cache;
 
          TLB *m_next_level;
+         PageTable *m_page_table;
+         std::vector<UInt32> m_page_shifts;
 
          UInt64 m_access, m_miss;
+
+         static IntPtr getKey(IntPtr address, UInt32 page_shift)
+         { return ((address >> page_shift) << SIM_PAGE_SHIFT) | (IntPtr(page_shift) << KEY_SIZE_SHIFT); }
+
+         void allocate(IntPtr key, SubsecondTime now);
       public:
-         TLB(String name, String cfgname, core_id_t core_id, UInt32 num_entries, UInt32 associativity, TLB *next_level);
+         TLB(String name, String cfgname, core_id_t core_id, UInt32 num_entries, UInt32 associativity, TLB *next_level, PageTable *page_table = NULL);
          bool lookup(IntPtr address, SubsecondTime now, bool allocate_on_miss = true);
-         void allocate(IntPtr address, SubsecondTime now);
    };
 }
 
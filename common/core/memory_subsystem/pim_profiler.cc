@@ -0,0 +1,80 @@
+#include "pim_profiler.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "stats.h"
+#include "log.h"
+
+#include <algorithm>
+
+PimProfiler*
+PimProfiler::create(core_id_t core_id)
+{
+   if (Sim()->getCfg()->getBool("routine_tracer/pim_candidates/enabled"))
+      return new PimProfiler(core_id);
+   else
+      return NULL;
+}
+
+PimProfiler::PimProfiler(core_id_t core_id)
+   : m_cache_block_size(Sim()->getCfg()->getInt("perf_model/l1_dcache/cache_block_size"))
+   , m_num_banks(Sim()->getCfg()->getInt("perf_model/pim/num_banks"))
+   , m_row_size(Sim()->getCfg()->getInt("perf_model/pim/row_size"))
+   , m_open_rows(m_num_banks, ~UInt64(0))
+   , m_last_use(Sim()->getCfg()->getInt("routine_tracer/pim_candidates/reuse_sampling"), MAX_REUSE_LINES)
+   , m_busy_until(SubsecondTime::Zero())
+   , m_accesses(0)
+   , m_llc_misses(0)
+   , m_dram_bytes(0)
+   , m_dram_row_hits(0)
+   , m_reuse_samples(0)
+   , m_reuse_distance(0)
+   , m_miss_latency(SubsecondTime::Zero())
+   , m_miss_busy_time(SubsecondTime::Zero())
+{
+   LOG_ASSERT_ERROR(m_num_banks > 0 && m_row_size > 0, "perf_model/pim/num_banks and row_size should be positive");
+   LOG_ASSERT_ERROR(Sim()->getCfg()->getInt("routine_tracer/pim_candidates/reuse_sampling") > 0, "routine_tracer/pim_candidates/reuse_sampling should be positive");
+
+   registerStatsMetric("pim-profile", core_id, "accesses", &m_accesses);
+   registerStatsMetric("pim-profile", core_id, "llc-misses", &m_llc_misses);
+   registerStatsMetric("pim-profile", core_id, "dram-bytes", &m_dram_bytes);
+   registerStatsMetric("pim-profile", core_id, "dram-row-hits", &m_dram_row_hits);
+   registerStatsMetric("pim-profile", core_id, "reuse-samples", &m_reuse_samples);
+   registerStatsMetric("pim-profile", core_id, "reuse-distance", &m_reuse_distance);
+   registerStatsMetric("pim-profile", core_id, "miss-latency", &m_miss_latency);
+   registerStatsMetric("pim-profile", core_id, "miss-busy-time", &m_miss_busy_time);
+}
+
+void
+PimProfiler::access(IntPtr address, HitWhere::where_t hit_where, SubsecondTime start, SubsecondTime latency)
+{
+   ++m_accesses;
+
+   UInt64 last_use;
+   if (m_last_use.access(address / m_cache_block_size, m_accesses, last_use) == SampledReuseTracker<UInt64>::REUSE)
+   {
+      ++m_reuse_samples;
+      m_reuse_distance += m_accesses - last_use;
+   }
+
+   if (hit_where != HitWhere::DRAM && hit_where != HitWhere::DRAM_LOCAL && hit_where != HitWhere::DRAM_REMOTE)
+      return;
+
+   ++m_llc_misses;
+   m_dram_bytes += m_cache_block_size;
+
+   UInt64 row_index = address / m_row_size;
+   UInt64 &open_row = m_open_rows[row_index % m_num_banks];
+   if (open_row == row_index / m_num_banks)
+      ++m_dram_row_hits;
+   else
+      open_row = row_index / m_num_banks;
+
+   // Time during which at least one miss was outstanding
+   SubsecondTime end = start + latency;
+   if (end > m_busy_until)
+   {
+      m_miss_busy_time += end - std::max(start, m_busy_until);
+      m_busy_until = end;
+   }
+   m_miss_latency += latency;
+}
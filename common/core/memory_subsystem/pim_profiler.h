@@ -0,0 +1,52 @@
+#ifndef __PIM_PROFILER_H
+#define __PIM_PROFILER_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "hit_where.h"
+#include "sampled_reuse_tracker.h"
+
+#include <vector>
+
+// Per-core memory behavior counters used to find near-memory offload candidates (routine_tracer/pim_candidates)
+//
+// All counters are regular statistics (pim-profile[core]), the funcstats routine tracer picks them up as
+// thread statistics and attributes them to the routine that was executing. For every data cache line accessed:
+//  - llc-misses and dram-bytes count the lines that had to come from DRAM
+//  - dram-row-hits counts the misses that would find their row open, using the bank and row layout of
+//    the near-memory banks (perf_model/pim/num_banks and row_size)
+//  - reuse-distance is the number of line accesses since the previous use of the same line, summed over
+//    reuse-samples; only a subset of lines is tracked (one in reuse_sampling, see SampledReuseTracker)
+//  - miss-latency over miss-busy-time is the average number of outstanding misses (memory-level parallelism)
+
+class PimProfiler
+{
+   public:
+      static PimProfiler* create(core_id_t core_id);
+
+      PimProfiler(core_id_t core_id);
+
+      void access(IntPtr address, HitWhere::where_t hit_where, SubsecondTime start, SubsecondTime latency);
+
+   private:
+      static const UInt32 MAX_REUSE_LINES = 65536;
+
+      const UInt32 m_cache_block_size;
+      const UInt32 m_num_banks;
+      const UInt32 m_row_size;
+
+      std::vector<UInt64> m_open_rows;
+      SampledReuseTracker<UInt64> m_last_use;  // Reuse distance is measured in accesses
+      SubsecondTime m_busy_until;
+
+      UInt64 m_accesses;
+      UInt64 m_llc_misses;
+      UInt64 m_dram_bytes;
+      UInt64 m_dram_row_hits;
+      UInt64 m_reuse_samples;
+      UInt64 m_reuse_distance;
+      SubsecondTime m_miss_latency;
+      SubsecondTime m_miss_busy_time;
+};
+
+#endif // __PIM_PROFILER_H
@@ -23,14 +23,16 @@ namespace PrL1PrL2DramDirectoryMSI
 
 DramCntlr::DramCntlr(MemoryManagerBase* memory_manager,
       ShmemPerfModel* shmem_perf_model,
-      UInt32 cache_block_size)
+      UInt32 cache_block_size,
+      AddressHomeLookup* address_home_lookup)
    : DramCntlrInterface(memory_manager, shmem_perf_model, cache_block_size)
    , m_reads(0)
    , m_writes(0)
 {
    m_dram_perf_model = DramPerfModel::createDramPerfModel(
          memory_manager->getCore()->getId(),
-         cache_block_size);
+         cache_block_size,
+         address_home_lookup);
 
    m_fault_injector = Sim()->getFaultinjectionManager()
       ? Sim()->getFaultinjectionManager()->getFaultInjector(memory_manager->getCore()->getId(), MemComponent::DRAM)
@@ -14,6 +14,7 @@
 #include "subsecond_time.h"
 
 class FaultInjector;
+class AddressHomeLookup;
 
 namespace PrL1PrL2DramDirectoryMSI
 {
@@ -38,7 +39,8 @@ namespace PrL1PrL2DramDirectoryMSI
       public:
          DramCntlr(MemoryManagerBase* memory_manager,
                ShmemPerfModel* shmem_perf_model,
-               UInt32 cache_block_size);
+               UInt32 cache_block_size,
+               AddressHomeLookup* address_home_lookup = NULL);
 
          ~DramCntlr();
 
@@ -30,6 +30,8 @@ DramDirectoryCache::DramDirectoryCache(
    // Logs
    m_log_num_sets = floorLog2(m_num_sets);
    m_log_cache_block_size = floorLog2(m_cache_block_size);
+
+   registerCheckpointObject("dram-directory", core_id, this);
 }
 
 DramDirectoryCache::~DramDirectoryCache()
@@ -153,6 +155,54 @@ DramDirectoryCache::invalidateDirectoryEntry(IntPtr address)
    LOG_PRINT_ERROR("");
 }
 
+void
+DramDirectoryCache::saveState(CheckpointWriter &writer)
+{
+   writer.write<UInt64>(m_total_entries);
+   writer.write<UInt64>(m_associativity);
+   writer.write(m_replacement_ptrs, m_num_sets * sizeof(UInt32));
+
+   // Save every directory slot. Entries that were replaced while requests were still outstanding have already
+   // left the directory (they are in m_replaced_directory_entry_list); they are transient and are not saved.
+   for (UInt32 i = 0; i < m_total_entries; i++)
+   {
+      DirectoryEntry* directory_entry = m_directory->getDirectoryEntry(i);
+      writer.write(directory_entry->getAddress());
+      writer.write<UInt32>(directory_entry->getDirectoryBlockInfo()->getDState());
+      writer.write(directory_entry->getOwner());
+
+      std::pair<bool, std::vector<core_id_t> > sharers_list = directory_entry->getSharersList();
+      writer.write(sharers_list.first);
+      writer.writeVector(sharers_list.second);
+   }
+}
+
+void
+DramDirectoryCache::loadState(CheckpointReader &reader)
+{
+   if (!reader.check(m_total_entries, "number of entries") || !reader.check(m_associativity, "associativity"))
+      return;
+   reader.read(m_replacement_ptrs, m_num_sets * sizeof(UInt32));
+
+   for (UInt32 i = 0; i < m_total_entries; i++)
+   {
+      DirectoryEntry* directory_entry = m_directory->createDirectoryEntry();
+      delete m_directory->getDirectoryEntry(i);
+      m_directory->setDirectoryEntry(i, directory_entry);
+
+      directory_entry->setAddress(reader.read<IntPtr>());
+      directory_entry->getDirectoryBlockInfo()->setDState((DirectoryState::dstate_t)reader.read<UInt32>());
+      directory_entry->setOwner(reader.read<core_id_t>());
+
+      bool all_sharers = reader.read<bool>();
+      std::vector<core_id_t> sharers(reader.read<UInt64>());
+      reader.read(sharers.data(), sharers.size() * sizeof(core_id_t));
+      if (!all_sharers)
+         for (std::vector<core_id_t>::iterator it = sharers.begin(); it != sharers.end(); it++)
+            directory_entry->addSharer(*it, getMaxHwSharers());
+   }
+}
+
 void
 DramDirectoryCache::splitAddress(IntPtr address, IntPtr& tag, UInt32& set_index)
 {
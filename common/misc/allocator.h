@@ -11,7 +11,7 @@
 
 class Allocator
 {
-   private:
+   protected:
       struct DataElement
       {
           Allocator *allocator;
@@ -33,43 +33,78 @@ class Allocator
 template <typename T, unsigned MaxItems = 0> class TypedAllocator : public Allocator
 {
    private:
+      // Overlays a DataElement while it is on one of the free lists
+      struct FreeElement
+      {
+         FreeElement *next;
+      };
+
+      // Allocation is done by one thread at a time: the one simulating the core (or SMT thread) that owns
+      // this allocator. In ROB-SMT however, DynamicMicroOps are free'd in simulate() which can be called by anyone.
+      // Free'd elements are therefore pushed onto a lock-free remote free list, which alloc() takes over
+      // in its entirety once its own free list runs empty. Elements are never returned to m_alloc.
+      FreeElement *m_free_local;
+      FreeElement * volatile m_free_remote;
       UInt64 m_items;
       FSBAllocator_ElemAllocator<sizeof(DataElement) + sizeof(T), MaxItems, T> m_alloc;
 
-      // In ROB-SMT, DynamicMicroOps are allocated by their own thread but free'd in simulate() which can be called by anyone
-      Lock m_lock;
+      static UInt64 countFree(FreeElement *elem)
+      {
+         UInt64 count = 0;
+         for( ; elem; elem = elem->next)
+            ++count;
+         return count;
+      }
 
    public:
       TypedAllocator()
-         : m_items(0)
+         : m_free_local(NULL)
+         , m_free_remote(NULL)
+         , m_items(0)
       {}
 
       virtual ~TypedAllocator()
       {
-         if (m_items)
+         UInt64 items = m_items - countFree(m_free_local) - countFree(m_free_remote);
+         if (items)
          {
             int status;
             char *nameoftype = abi::__cxa_demangle(typeid(T).name(), 0, 0, &status);
-            printf("[ALLOC] %" PRIu64 " items of type %s not freed\n", m_items, nameoftype);
+            printf("[ALLOC] %" PRIu64 " items of type %s not freed\n", items, nameoftype);
             free(nameoftype);
          }
       }
 
       virtual void* alloc(size_t bytes)
       {
-         ScopedLock sl(m_lock);
          //LOG_ASSERT_ERROR(bytes == sizeof(T), "");
-         ++m_items;
-         DataElement *elem = (DataElement *)m_alloc.allocate();
+         if (!m_free_local && m_free_remote)
+            m_free_local = __sync_lock_test_and_set(&m_free_remote, (FreeElement*)NULL);
+
+         DataElement *elem;
+         if (m_free_local)
+         {
+            elem = (DataElement *)m_free_local;
+            m_free_local = m_free_local->next;
+         }
+         else
+         {
+            ++m_items;
+            elem = (DataElement *)m_alloc.allocate();
+         }
          elem->allocator = this;
          return elem->data;
       }
 
       virtual void _dealloc(void* ptr)
       {
-         ScopedLock sl(m_lock);
-         --m_items;
-         m_alloc.deallocate((T*)ptr);
+         FreeElement *elem = (FreeElement *)ptr, *head;
+         do
+         {
+            head = m_free_remote;
+            elem->next = head;
+         }
+         while (!__sync_bool_compare_and_swap(&m_free_remote, head, elem));
       }
 };
 
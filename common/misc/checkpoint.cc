@@ -0,0 +1,242 @@
+#include "checkpoint.h"
+#include "simulator.h"
+#include "config.h"
+#include "config.hpp"
+#include "hooks_manager.h"
+#include "magic_server.h"
+#include "log.h"
+#include "itostr.h"
+#include "core_manager.h"
+#include "performance_model.h"
+#include "clock_skew_minimization_object.h"
+
+#include <cstring>
+#include <typeinfo>
+#include <zlib.h>
+
+// File layout (zlib compressed): magic, version, number of sections, then per section
+// the object name, index, type name, data size and data
+static const UInt32 CHECKPOINT_MAGIC = 0x4b434e53; // "SNCK"
+static const UInt32 CHECKPOINT_VERSION = 1;
+
+void CheckpointWriter::write(const void *data, size_t size)
+{
+   const UInt8 *bytes = (const UInt8*)data;
+   m_data.insert(m_data.end(), bytes, bytes + size);
+}
+
+void CheckpointWriter::writeVector(const std::vector<bool> &vector)
+{
+   write<UInt64>(vector.size());
+   for(size_t i = 0; i < vector.size(); i += 8)
+   {
+      UInt8 bits = 0;
+      for(size_t j = i; j < i + 8 && j < vector.size(); ++j)
+         bits |= vector[j] << (j - i);
+      write(bits);
+   }
+}
+
+void CheckpointWriter::writeString(const String &string)
+{
+   write<UInt32>(string.size());
+   write(string.data(), string.size());
+}
+
+void CheckpointReader::read(void *data, size_t size)
+{
+   LOG_ASSERT_ERROR(m_offset + size <= m_data.size(), "Checkpoint section %s is truncated", m_name.c_str());
+   memcpy(data, m_data.data() + m_offset, size);
+   m_offset += size;
+}
+
+void CheckpointReader::readSize(size_t size)
+{
+   UInt64 saved = read<UInt64>();
+   LOG_ASSERT_ERROR(saved == size, "Checkpoint section %s has a table of %lu entries, expected %lu", m_name.c_str(), saved, size);
+}
+
+void CheckpointReader::readVector(std::vector<bool> &vector)
+{
+   readSize(vector.size());
+   for(size_t i = 0; i < vector.size(); i += 8)
+   {
+      UInt8 bits = read<UInt8>();
+      for(size_t j = i; j < i + 8 && j < vector.size(); ++j)
+         vector[j] = (bits >> (j - i)) & 1;
+   }
+}
+
+String CheckpointReader::readString()
+{
+   String string(read<UInt32>(), '\0');
+   read(&string[0], string.size());
+   return string;
+}
+
+bool CheckpointReader::check(UInt64 current, const char *what)
+{
+   UInt64 saved = read<UInt64>();
+   if (saved != current)
+   {
+      printf("[SNIPER] Checkpoint: %s has a different %s (%lu in checkpoint, %lu now), not restoring it\n", m_name.c_str(), what, saved, current);
+      return false;
+   }
+   return true;
+}
+
+CheckpointManager::CheckpointManager()
+   : m_restored(false)
+   , m_save_filename(Sim()->getCfg()->getString("checkpoint/save"))
+   , m_save_at(Sim()->getCfg()->getString("checkpoint/save_at"))
+   , m_save_marker(Sim()->getCfg()->getInt("checkpoint/save_marker"))
+{
+   if (m_save_filename != "" && m_save_filename[0] != '/')
+      m_save_filename = Sim()->getConfig()->formatOutputFileName(m_save_filename);
+}
+
+void CheckpointManager::init()
+{
+   String filename = Sim()->getCfg()->getString("checkpoint/load");
+   if (filename != "")
+   {
+      bool loaded = load(filename);
+      LOG_ASSERT_ERROR(loaded, "Cannot read checkpoint %s", filename.c_str());
+
+      ScopedLock sl(m_lock);
+      for(std::map<Key, Checkpointable*>::iterator it = m_objects.begin(); it != m_objects.end(); ++it)
+         restore(it->first, it->second);
+      m_restored = true;
+      printf("[SNIPER] Restored %lu objects from checkpoint %s\n", m_objects.size(), filename.c_str());
+
+      // Core clocks have moved forward, move the barrier along so it doesn't have to step through all quanta up to there
+      SubsecondTime barrier_next = SubsecondTime::Zero();
+      for(UInt32 core_id = 0; core_id < Sim()->getConfig()->getApplicationCores(); ++core_id)
+         barrier_next = std::max(barrier_next, Sim()->getCoreManager()->getCoreFromID(core_id)->getPerformanceModel()->getElapsedTime());
+      if (Sim()->getClockSkewMinimizationServer())
+         Sim()->getClockSkewMinimizationServer()->setFastForward(false, barrier_next);
+   }
+
+   if (m_save_filename != "")
+   {
+      if (m_save_at == "roi-begin")
+         Sim()->getHooksManager()->registerHook(HookType::HOOK_ROI_BEGIN, CheckpointManager::hookSave, (UInt64)this);
+      else if (m_save_at == "roi-end")
+         Sim()->getHooksManager()->registerHook(HookType::HOOK_ROI_END, CheckpointManager::hookSave, (UInt64)this);
+      else if (m_save_at == "marker")
+         Sim()->getHooksManager()->registerHook(HookType::HOOK_MAGIC_MARKER, CheckpointManager::hookMagicMarker, (UInt64)this);
+      else
+         LOG_PRINT_ERROR("Invalid value %s for checkpoint/save_at, must be roi-begin, roi-end or marker", m_save_at.c_str());
+   }
+}
+
+String CheckpointManager::keyName(const Key &key)
+{
+   return key.first + "[" + itostr(key.second) + "]";
+}
+
+void CheckpointManager::registerObject(String name, UInt32 index, Checkpointable *object)
+{
+   ScopedLock sl(m_lock);
+   Key key(name, index);
+   LOG_ASSERT_ERROR(m_objects.count(key) == 0, "Checkpoint object %s registered twice", keyName(key).c_str());
+   m_objects[key] = object;
+   if (m_restored)
+      restore(key, object);
+}
+
+void CheckpointManager::restore(const Key &key, Checkpointable *object)
+{
+   std::map<Key, Section>::iterator it = m_sections.find(key);
+   if (it == m_sections.end())
+      return;
+   if (it->second.type != typeid(*object).name())
+   {
+      printf("[SNIPER] Checkpoint: %s has changed type, not restoring it\n", keyName(key).c_str());
+      return;
+   }
+   CheckpointReader reader(keyName(key), it->second.data);
+   object->loadState(reader);
+}
+
+void CheckpointManager::save(String filename)
+{
+   ScopedLock sl(m_lock);
+
+   gzFile file = gzopen(filename.c_str(), "wb");
+   LOG_ASSERT_ERROR(file, "Cannot create checkpoint %s", filename.c_str());
+
+   UInt32 header[3] = { CHECKPOINT_MAGIC, CHECKPOINT_VERSION, (UInt32)m_objects.size() };
+   gzwrite(file, header, sizeof(header));
+   for(std::map<Key, Checkpointable*>::iterator it = m_objects.begin(); it != m_objects.end(); ++it)
+   {
+      CheckpointWriter writer;
+      writer.writeString(it->first.first);
+      writer.write<UInt32>(it->first.second);
+      writer.writeString(typeid(*it->second).name());
+
+      CheckpointWriter section;
+      it->second->saveState(section);
+      writer.writeVector(section.getData());
+
+      int written = gzwrite(file, writer.getData().data(), writer.getData().size());
+      LOG_ASSERT_ERROR(written == (int)writer.getData().size(), "Error writing checkpoint %s", filename.c_str());
+   }
+   gzclose(file);
+
+   printf("[SNIPER] Wrote checkpoint of %lu objects to %s\n", m_objects.size(), filename.c_str());
+}
+
+bool CheckpointManager::load(String filename)
+{
+   gzFile file = gzopen(filename.c_str(), "rb");
+   if (!file)
+      return false;
+
+   // Sections are small compared to the simulator's own footprint, read everything at once
+   std::vector<UInt8> data;
+   UInt8 buffer[65536];
+   int size;
+   while((size = gzread(file, buffer, sizeof(buffer))) > 0)
+      data.insert(data.end(), buffer, buffer + size);
+   gzclose(file);
+   if (size < 0)
+      return false;
+
+   CheckpointReader reader(filename, data);
+   UInt32 header[3];
+   reader.read(header, sizeof(header));
+   if (header[0] != CHECKPOINT_MAGIC || header[1] != CHECKPOINT_VERSION)
+      return false;
+   for(UInt32 i = 0; i < header[2]; ++i)
+   {
+      String name = reader.readString();
+      UInt32 index = reader.read<UInt32>();
+      Section &section = m_sections[Key(name, index)];
+      section.type = reader.readString();
+      section.data.resize(reader.read<UInt64>());
+      reader.read(section.data.data(), section.data.size());
+   }
+   return true;
+}
+
+SInt64 CheckpointManager::hookSave(UInt64 object, UInt64 argument)
+{
+   CheckpointManager *self = (CheckpointManager*)object;
+   self->save(self->m_save_filename);
+   return 0;
+}
+
+SInt64 CheckpointManager::hookMagicMarker(UInt64 object, UInt64 argument)
+{
+   CheckpointManager *self = (CheckpointManager*)object;
+   MagicServer::MagicMarkerType *marker = (MagicServer::MagicMarkerType*)argument;
+   if (marker->arg0 == self->m_save_marker)
+      self->save(self->m_save_filename);
+   return 0;
+}
+
+void registerCheckpointObject(String name, UInt32 index, Checkpointable *object)
+{
+   Sim()->getCheckpointManager()->registerObject(name, index, object);
+}
@@ -0,0 +1,121 @@
+#ifndef __CHECKPOINT_H
+#define __CHECKPOINT_H
+
+#include "fixed_types.h"
+#include "lock.h"
+
+#include <vector>
+#include <map>
+
+// Checkpoints of warmed-up microarchitectural state (cache contents, replacement and coherence state,
+// branch predictor and prefetcher tables, core clocks), so that a run can skip fast-forward and warmup.
+//
+// Objects that have state worth preserving implement Checkpointable and register themselves with
+// registerCheckpointObject(), just like they register their statistics. A checkpoint is a compressed
+// image with one section per (object name, index). On restore, each registered object gets its own
+// section back: sections for objects that no longer exist are ignored, objects without a section
+// (or whose type has changed) keep their initial state. Objects are responsible for checking that
+// the geometry of their state matches the checkpoint, see CheckpointReader::check().
+//
+// Only simulator state is restored: the application, its trace or the frontend feeding it is not moved to the
+// point where the checkpoint was taken. The run restoring a checkpoint should start there by itself, for
+// instance by using a trace recorded from that point on, or by fast-forwarding without warmup up to it.
+
+class CheckpointWriter
+{
+   private:
+      std::vector<UInt8> m_data;
+
+   public:
+      void write(const void *data, size_t size);
+      template <class T> void write(const T &value) { write(&value, sizeof(T)); }
+      template <class T> void writeVector(const std::vector<T> &vector)
+      {
+         write<UInt64>(vector.size());
+         write(vector.data(), vector.size() * sizeof(T));
+      }
+      void writeVector(const std::vector<bool> &vector);
+      void writeString(const String &string);
+
+      const std::vector<UInt8>& getData() const { return m_data; }
+};
+
+class CheckpointReader
+{
+   private:
+      const String m_name;
+      const std::vector<UInt8> &m_data;
+      size_t m_offset;
+
+      void readSize(size_t size);
+
+   public:
+      CheckpointReader(String name, const std::vector<UInt8> &data) : m_name(name), m_data(data), m_offset(0) {}
+
+      void read(void *data, size_t size);
+      template <class T> void read(T &value) { read(&value, sizeof(T)); }
+      template <class T> T read() { T value; read(&value, sizeof(T)); return value; }
+      // Vectors are read in place, they must have the same size as when they were saved
+      template <class T> void readVector(std::vector<T> &vector)
+      {
+         readSize(vector.size());
+         read(vector.data(), vector.size() * sizeof(T));
+      }
+      void readVector(std::vector<bool> &vector);
+      String readString();
+
+      // Read a value written as write<UInt64>(saved) and compare it to the current configuration.
+      // Returns false (with a warning) on a mismatch, in which case the object should not restore any further.
+      bool check(UInt64 current, const char *what);
+};
+
+class Checkpointable
+{
+   public:
+      virtual ~Checkpointable() {}
+      virtual void saveState(CheckpointWriter &writer) = 0;
+      virtual void loadState(CheckpointReader &reader) = 0;
+};
+
+class CheckpointManager
+{
+   private:
+      typedef std::pair<String, UInt32> Key;
+
+      struct Section
+      {
+         String type;
+         std::vector<UInt8> data;
+      };
+
+      std::map<Key, Checkpointable*> m_objects;
+      std::map<Key, Section> m_sections;  // Loaded from the checkpoint we're restoring from
+      bool m_restored;
+      Lock m_lock;
+
+      String m_save_filename;
+      String m_save_at;
+      UInt64 m_save_marker;
+
+      static String keyName(const Key &key);
+      void restore(const Key &key, Checkpointable *object);
+
+      static SInt64 hookSave(UInt64 object, UInt64 argument);
+      static SInt64 hookMagicMarker(UInt64 object, UInt64 argument);
+
+   public:
+      CheckpointManager();
+
+      // Called after all cores have been created: restore from checkpoint/load, and arm the checkpoint/save trigger
+      void init();
+
+      // Objects registered after init() are restored immediately, so they must be fully constructed by then
+      void registerObject(String name, UInt32 index, Checkpointable *object);
+
+      void save(String filename);
+      bool load(String filename);
+};
+
+void registerCheckpointObject(String name, UInt32 index, Checkpointable *object);
+
+#endif // __CHECKPOINT_H
@@ -0,0 +1,79 @@
+#ifndef __SAMPLED_REUSE_TRACKER_H
+#define __SAMPLED_REUSE_TRACKER_H
+
+#include "fixed_types.h"
+
+#include <unordered_map>
+
+// Remembers when a subset of the cache lines was last used, so their reuse can be measured at a bounded cost.
+//
+// One line in <sampling> is followed, selected by a multiplicative hash of the line number so the selection does
+// not alias with strided access patterns. When <max_lines> lines are being followed, the sampling rate is halved
+// and the lines that are no longer sampled are dropped. The lines that remain keep their complete history, where
+// forgetting all (or the oldest) lines would make long reuses look like first uses and bias towards short reuses.
+//
+// T is whatever the user measures reuse in (time, access count). Not thread-safe, users provide their own locking.
+template <class T>
+class SampledReuseTracker
+{
+   public:
+      enum result_t
+      {
+         UNSAMPLED,  // Line is not followed
+         FIRST_USE,  // Line is followed, but had not been used since we started following it
+         REUSE,      // Line is followed and was used before
+      };
+
+      SampledReuseTracker(UInt32 sampling, UInt32 max_lines)
+         : m_sampling(sampling)
+         , m_max_lines(max_lines)
+         , m_divisor(sampling)
+      {}
+
+      // Whether <line> is sampled at the initial rate. Cheap and lock-free: lines that fail this are never followed.
+      bool isCandidate(IntPtr line) const { return hash(line) % m_sampling == 0; }
+
+      // Record a use of <line> at <now>. On a reuse, <last_use> is set to the time of the previous use.
+      result_t access(IntPtr line, T now, T &last_use)
+      {
+         if (hash(line) % m_divisor != 0)
+            return UNSAMPLED;
+
+         typename std::unordered_map<IntPtr, T>::iterator it = m_last_use.find(line);
+         if (it != m_last_use.end())
+         {
+            last_use = it->second;
+            it->second = now;
+            return REUSE;
+         }
+
+         if (m_last_use.size() >= m_max_lines)
+         {
+            m_divisor *= 2;
+            for(it = m_last_use.begin(); it != m_last_use.end(); )
+            {
+               if (hash(it->first) % m_divisor != 0)
+                  it = m_last_use.erase(it);
+               else
+                  ++it;
+            }
+            if (hash(line) % m_divisor != 0)
+               return UNSAMPLED;
+         }
+         m_last_use[line] = now;
+         return FIRST_USE;
+      }
+
+      // How many lines each followed line stands for, relative to the initial sampling rate
+      UInt64 getWeight() const { return m_divisor / m_sampling; }
+
+   private:
+      const UInt32 m_sampling;
+      const UInt32 m_max_lines;
+      UInt64 m_divisor;  // Follow lines whose hash is a multiple of this, always a multiple of m_sampling
+      std::unordered_map<IntPtr, T> m_last_use;
+
+      static UInt64 hash(IntPtr line) { return (line * 0x9e3779b97f4a7c15ULL) >> 32; }
+};
+
+#endif // __SAMPLED_REUSE_TRACKER_H
@@ -4,6 +4,7 @@
 _SetLock::_SetLock(UInt32 core_offset, UInt32 num_sharers)
    : m_locks(num_sharers)
    , m_core_offset(core_offset)
+   , m_seq(0)
 {
    #ifdef TIME_LOCKS
    _timer = TotalTimer::getTimerByStacktrace("setlock@" + itostr(this));
@@ -20,12 +21,17 @@ _SetLock::acquire_exclusive(void)
 
    for(std::vector<PersetLock>::iterator it = m_locks.begin(); it != m_locks.end(); ++it)
       (*it).acquire();
+
+   // Make the sequence number odd, optimistic readers will retry until we're done
+   __sync_fetch_and_add(&m_seq, 1);
 }
 
 // Release exclusive access
 void
 _SetLock::release_exclusive(void)
 {
+   __sync_fetch_and_add(&m_seq, 1);
+
    for(std::vector<PersetLock>::iterator it = m_locks.begin(); it != m_locks.end(); ++it)
       (*it).release();
 }
@@ -60,6 +66,8 @@ _SetLock::upgrade(UInt32 core_id)
 void
 _SetLock::downgrade(UInt32 core_id)
 {
+   __sync_fetch_and_add(&m_seq, 1);
+
    for(unsigned int i = 0; i < m_locks.size(); ++i)
       if (i != (core_id - m_core_offset))
          m_locks.at(i).release();
@@ -7,7 +7,14 @@
 #include <vector>
 #include <pthread.h>
 
-/* Cache set lock */
+/* Cache set lock
+
+   Besides the shared (one sharer) and exclusive (all sharers) modes, each set lock has a sequence counter
+   that is odd while the set is held exclusively. Readers that only need to probe the tags can do so without
+   taking any lock: take a snapshot with read_begin(), read the set, and accept the result only when
+   read_validate() returns true, retrying otherwise. Since all state changes done by other cores happen under
+   the exclusive lock, a validated probe saw a consistent set.
+*/
 
 class _SetLock
 {
@@ -20,6 +27,21 @@ class _SetLock
       void upgrade(UInt32 core_id);
       void downgrade(UInt32 core_id);
 
+      // Readers only need acquire ordering (reads of the set are not moved before read_begin or after
+      // read_validate), which costs no fence instruction on x86. Writers use full barriers (__sync_fetch_and_add).
+      UInt32 read_begin(void)
+      {
+         UInt32 seq;
+         while((seq = __atomic_load_n(&m_seq, __ATOMIC_ACQUIRE)) & 1)
+            __asm__ __volatile__ ("pause");
+         return seq;
+      }
+      bool read_validate(UInt32 seq)
+      {
+         __atomic_thread_fence(__ATOMIC_ACQUIRE);
+         return __atomic_load_n(&m_seq, __ATOMIC_RELAXED) == seq;
+      }
+
    private:
       class PersetLock
       {
@@ -33,6 +55,7 @@ class _SetLock
 
       std::vector<PersetLock> m_locks;
       UInt32 m_core_offset;
+      volatile UInt32 m_seq;
       #ifdef TIME_LOCKS
       TotalTimer* _timer;
       #endif
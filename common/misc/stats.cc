@@ -3,6 +3,7 @@
 #include "hooks_manager.h"
 #include "utils.h"
 #include "itostr.h"
+#include "config.hpp"
 
 #include <math.h>
 #include <stdio.h>
@@ -27,6 +28,7 @@ const char* db_create_stmts[] = {
    // Other users
    "CREATE TABLE `topology` (componentname TEXT, coreid INTEGER, masterid INTEGER);",
    "CREATE TABLE `event` (event INTEGER, time INTEGER, core INTEGER, thread INTEGER, value0 INTEGER, value1 INTEGER, description TEXT);",
+   "CREATE TABLE `pimcandidates` (rank INTEGER, eip INTEGER, name TEXT, location TEXT, calls INTEGER, instructions INTEGER, llcmisses INTEGER, drambytes INTEGER, rowlocality REAL, reusedistance REAL, mlp REAL, hosttime INTEGER, pimtime INTEGER);",
 };
 const char db_insert_stmt_name[] = "INSERT INTO `names` (nameid, objectname, metricname) VALUES (?, ?, ?);";
 const char db_insert_stmt_prefix[] = "INSERT INTO `prefixes` (prefixid, prefixname) VALUES (?, ?);";
@@ -43,6 +45,8 @@ UInt64 getWallclockTimeCallback(String objectName, UInt32 index, String metricNa
 StatsManager::StatsManager()
    : m_keyid(0)
    , m_prefixnum(0)
+   , m_flat_metrics_changed(true)
+   , m_columnar(NULL)
    , m_db(NULL)
 {
    init();
@@ -57,6 +61,9 @@ StatsManager::~StatsManager()
          for(StatsIndexList::iterator it3 = it2->second.second.begin(); it3 != it2->second.second.end(); ++it3)
             delete it3->second;
 
+   if (m_columnar)
+      convertColumnar();
+
    if (m_db)
    {
       sqlite3_finalize(m_stmt_insert_name);
@@ -99,6 +106,19 @@ StatsManager::init()
       }
    }
    sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+
+   String format = Sim()->getCfg()->getString("general/stats_format");
+   if (format == "columnar")
+   {
+      m_columnar_filename = Sim()->getConfig()->formatOutputFileName("sim.stats.bin");
+      m_columnar = fopen(m_columnar_filename.c_str(), "w");
+      LOG_ASSERT_ERROR(m_columnar, "Cannot create %s", m_columnar_filename.c_str());
+      fwrite(&COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC), 1, m_columnar);
+   }
+   else if (format != "sqlite")
+   {
+      LOG_PRINT_ERROR("Invalid general/stats_format %s", format.c_str());
+   }
 }
 
 int
@@ -145,27 +165,146 @@ StatsManager::recordStats(String prefix)
    res = sqlite3_step(m_stmt_insert_prefix);
    LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
 
+   if (m_flat_metrics_changed)
+      updateFlatMetrics();
+
+   if (m_columnar)
+   {
+      // Only the prefix goes into the database now, the values are converted at exit
+      writeColumnar(prefixid);
+   }
+   else
+   {
+      for(std::vector<FlatMetric>::iterator it = m_flat_metrics.begin(); it != m_flat_metrics.end(); ++it)
+      {
+         if (!it->metric->isDefault())
+         {
+            sqlite3_reset(m_stmt_insert_value);
+            sqlite3_bind_int(m_stmt_insert_value, 1, prefixid);
+            sqlite3_bind_int(m_stmt_insert_value, 2, it->nameid);          // Metric ID
+            sqlite3_bind_int(m_stmt_insert_value, 3, it->metric->index);   // Core ID
+            sqlite3_bind_int64(m_stmt_insert_value, 4, it->metric->recordMetric());
+            res = sqlite3_step(m_stmt_insert_value);
+            LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+         }
+      }
+   }
+   res = sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+   LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+}
+
+void
+StatsManager::updateFlatMetrics()
+{
+   m_flat_metrics.clear();
    for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
    {
       for (StatsMetricList::iterator it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
       {
          for(StatsIndexList::iterator it3 = it2->second.second.begin(); it3 != it2->second.second.end(); ++it3)
          {
-            if (!it3->second->isDefault())
-            {
-               sqlite3_reset(m_stmt_insert_value);
-               sqlite3_bind_int(m_stmt_insert_value, 1, prefixid);
-               sqlite3_bind_int(m_stmt_insert_value, 2, it2->second.first);   // Metric ID
-               sqlite3_bind_int(m_stmt_insert_value, 3, it3->second->index);  // Core ID
-               sqlite3_bind_int64(m_stmt_insert_value, 4, it3->second->recordMetric());
-               res = sqlite3_step(m_stmt_insert_value);
-               LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
-            }
+            FlatMetric flat = { it3->second, UInt32(it2->second.first) };
+            m_flat_metrics.push_back(flat);
          }
       }
    }
-   res = sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
-   LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+   m_flat_metrics_changed = false;
+
+   if (m_columnar)
+   {
+      UInt32 header[2] = { COLUMNAR_LAYOUT, UInt32(m_flat_metrics.size()) };
+      fwrite(header, sizeof(header), 1, m_columnar);
+      for(std::vector<FlatMetric>::iterator it = m_flat_metrics.begin(); it != m_flat_metrics.end(); ++it)
+      {
+         ColumnarEntry entry = { it->nameid, it->metric->index, it->metric->isDefaultZero() ? UInt32(COLUMNAR_ZERO_IS_DEFAULT) : 0 };
+         fwrite(&entry, sizeof(entry), 1, m_columnar);
+      }
+   }
+}
+
+void
+StatsManager::writeColumnar(int prefixid)
+{
+   m_values.resize(m_flat_metrics.size());
+   for(size_t i = 0; i < m_flat_metrics.size(); ++i)
+      m_values[i] = m_flat_metrics[i].metric->recordMetric();
+
+   UInt32 header[3] = { COLUMNAR_SNAPSHOT, UInt32(prefixid), UInt32(m_values.size()) };
+   fwrite(header, sizeof(header), 1, m_columnar);
+   fwrite(m_values.data(), sizeof(UInt64), m_values.size(), m_columnar);
+   // Keep the file usable by sniper_stats if we don't make it to the end
+   fflush(m_columnar);
+}
+
+void
+StatsManager::convertColumnar()
+{
+   fclose(m_columnar);
+   m_columnar = NULL;
+
+   FILE *fp = fopen(m_columnar_filename.c_str(), "r");
+   LOG_ASSERT_ERROR(fp, "Cannot open %s", m_columnar_filename.c_str());
+
+   UInt64 magic = 0;
+   if (fread(&magic, sizeof(magic), 1, fp) != 1 || magic != COLUMNAR_MAGIC)
+      LOG_PRINT_ERROR("%s is not a statistics file", m_columnar_filename.c_str());
+
+   // Scripts can delete snapshots while the simulation runs (sim.util.db_delete), skip those
+   sqlite3_stmt *stmt_prefix;
+   sqlite3_prepare(m_db, "SELECT prefixid FROM `prefixes` WHERE prefixid = ?;", -1, &stmt_prefix, NULL);
+
+   std::vector<ColumnarEntry> layout;
+   std::vector<UInt64> values;
+   UInt32 header[2];
+   int res;
+
+   sqlite3_exec(m_db, "BEGIN TRANSACTION", NULL, NULL, NULL);
+   while (fread(header, sizeof(header), 1, fp) == 1)
+   {
+      if (header[0] == COLUMNAR_LAYOUT)
+      {
+         layout.resize(header[1]);
+         if (header[1] && fread(layout.data(), sizeof(layout[0]), layout.size(), fp) != layout.size())
+            break;
+      }
+      else if (header[0] == COLUMNAR_SNAPSHOT)
+      {
+         UInt32 prefixid = header[1], count;
+         if (fread(&count, sizeof(count), 1, fp) != 1)
+            break;
+         LOG_ASSERT_ERROR(count == layout.size(), "Snapshot %d in %s has %u values for %u metrics", prefixid, m_columnar_filename.c_str(), count, (UInt32)layout.size());
+         values.resize(count);
+         if (count && fread(values.data(), sizeof(UInt64), count, fp) != count)
+            break;
+
+         sqlite3_reset(stmt_prefix);
+         sqlite3_bind_int(stmt_prefix, 1, prefixid);
+         if (sqlite3_step(stmt_prefix) != SQLITE_ROW)
+            continue;
+
+         for(UInt32 i = 0; i < count; ++i)
+         {
+            // Like isDefault(), leave out zeros only for metrics whose default is zero (callbacks are always written)
+            if (values[i] == 0 && (layout[i].flags & COLUMNAR_ZERO_IS_DEFAULT))
+               continue;
+            sqlite3_reset(m_stmt_insert_value);
+            sqlite3_bind_int(m_stmt_insert_value, 1, prefixid);
+            sqlite3_bind_int(m_stmt_insert_value, 2, layout[i].nameid);   // Metric ID
+            sqlite3_bind_int(m_stmt_insert_value, 3, layout[i].index);    // Core ID
+            sqlite3_bind_int64(m_stmt_insert_value, 4, values[i]);
+            res = sqlite3_step(m_stmt_insert_value);
+            LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+         }
+      }
+      else
+      {
+         LOG_PRINT_ERROR("Invalid record type %u in %s", header[0], m_columnar_filename.c_str());
+      }
+   }
+   sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+
+   sqlite3_finalize(stmt_prefix);
+   fclose(fp);
 }
 
 void
@@ -176,6 +315,7 @@ StatsManager::registerMetric(StatsMetricBase *metric)
    LOG_ASSERT_ERROR(m_objects[_objectName][_metricName].second.count(metric->index) == 0,
       "Duplicate statistic %s.%s[%d]", _objectName.c_str(), _metricName.c_str(), metric->index);
    m_objects[_objectName][_metricName].second[metric->index] = metric;
+   m_flat_metrics_changed = true;
 
    if (m_objects[_objectName][_metricName].first == 0)
    {
@@ -234,6 +374,30 @@ StatsManager::logEvent(event_type_t event, SubsecondTime time, core_id_t core_id
    sqlite3_finalize(stmt);
 }
 
+void
+StatsManager::logPimCandidate(UInt32 rank, IntPtr eip, const char *name, const char *location, UInt64 calls, UInt64 instructions,
+   UInt64 llc_misses, UInt64 dram_bytes, double row_locality, double reuse_distance, double mlp, SubsecondTime host_time, SubsecondTime pim_time)
+{
+   sqlite3_stmt *stmt;
+   sqlite3_prepare(m_db, "INSERT INTO pimcandidates (rank, eip, name, location, calls, instructions, llcmisses, drambytes, rowlocality, reusedistance, mlp, hosttime, pimtime) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);", -1, &stmt, NULL);
+   sqlite3_bind_int(stmt, 1, rank);
+   sqlite3_bind_int64(stmt, 2, eip);
+   sqlite3_bind_text(stmt, 3, name, -1, SQLITE_STATIC);
+   sqlite3_bind_text(stmt, 4, location, -1, SQLITE_STATIC);
+   sqlite3_bind_int64(stmt, 5, calls);
+   sqlite3_bind_int64(stmt, 6, instructions);
+   sqlite3_bind_int64(stmt, 7, llc_misses);
+   sqlite3_bind_int64(stmt, 8, dram_bytes);
+   sqlite3_bind_double(stmt, 9, row_locality);
+   sqlite3_bind_double(stmt, 10, reuse_distance);
+   sqlite3_bind_double(stmt, 11, mlp);
+   sqlite3_bind_int64(stmt, 12, host_time.getFS());
+   sqlite3_bind_int64(stmt, 13, pim_time.getFS());
+   int res = sqlite3_step(stmt);
+   LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+   sqlite3_finalize(stmt);
+}
+
 StatHist &
 StatHist::operator += (StatHist & stat)
 {
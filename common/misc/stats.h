@@ -4,6 +4,8 @@
 #include "itostr.h"
 
 #include <cstring>
+#include <cstdio>
+#include <vector>
 #include <sqlite3.h>
 
 class StatsMetricBase
@@ -18,6 +20,7 @@ class StatsMetricBase
       virtual ~StatsMetricBase() {}
       virtual UInt64 recordMetric() = 0;
       virtual bool isDefault() { return false; } // Return true when value hasn't changed from its initialization value
+      virtual bool isDefaultZero() { return false; } // Return true when isDefault() is the same as a zero value
 };
 
 template <class T> UInt64 makeStatsValue(T t);
@@ -37,6 +40,7 @@ template <class T> class StatsMetric : public StatsMetricBase
       {
          return recordMetric() == 0;
       }
+      virtual bool isDefaultZero() { return true; }
 };
 
 typedef UInt64 (*StatsCallback)(String objectName, UInt32 index, String metricName, UInt64 arg);
@@ -78,11 +82,42 @@ class StatsManager
       void logMarker(SubsecondTime time, core_id_t core_id, thread_id_t thread_id, UInt64 value0, UInt64 value1, const char * description)
       { logEvent(EVENT_MARKER, time, core_id, thread_id, value0, value1, description); }
       void logEvent(event_type_t event, SubsecondTime time, core_id_t core_id, thread_id_t thread_id, UInt64 value0, UInt64 value1, const char * description);
+      void logPimCandidate(UInt32 rank, IntPtr eip, const char *name, const char *location, UInt64 calls, UInt64 instructions,
+         UInt64 llc_misses, UInt64 dram_bytes, double row_locality, double reuse_distance, double mlp, SubsecondTime host_time, SubsecondTime pim_time);
 
    private:
+      // Layout of sim.stats.bin (general/stats_format = columnar), see tools/sniper_stats_columnar.py
+      static const UInt64 COLUMNAR_MAGIC = 0x5354415453525053ULL; // "SPRSTATS"
+      enum columnar_record_t {
+         COLUMNAR_LAYOUT = 1,    // count, count * (nameid, index, flags): metrics of the following snapshots
+         COLUMNAR_SNAPSHOT,      // prefixid, count, count * value
+      };
+      enum columnar_flags_t {
+         COLUMNAR_ZERO_IS_DEFAULT = 1,    // A zero value is the metric's default, leave it out like isDefault() does
+      };
+      struct ColumnarEntry
+      {
+         UInt32 nameid;
+         UInt32 index;
+         UInt32 flags;
+      };
+
+      // All metrics, resolved once from m_objects and rebuilt only when a metric is added
+      struct FlatMetric
+      {
+         StatsMetricBase *metric;
+         UInt32 nameid;
+      };
+
       UInt64 m_keyid;
       UInt64 m_prefixnum;
 
+      std::vector<FlatMetric> m_flat_metrics;
+      bool m_flat_metrics_changed;
+      std::vector<UInt64> m_values;
+      FILE *m_columnar;
+      String m_columnar_filename;
+
       sqlite3 *m_db;
       sqlite3_stmt *m_stmt_insert_name;
       sqlite3_stmt *m_stmt_insert_prefix;
@@ -99,6 +134,9 @@ class StatsManager
       int busy_handler(int count);
 
       void recordMetricName(UInt64 keyId, std::string objectName, std::string metricName);
+      void updateFlatMetrics();
+      void writeColumnar(int prefixid);
+      void convertColumnar();
 };
 
 template <class T> void registerStatsMetric(String objectName, UInt32 index, String metricName, T *metric)
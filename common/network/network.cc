@@ -10,6 +10,7 @@
 #include "subsecond_time.h"
 #include "performance_model.h"
 #include "instruction.h"
+#include "stats.h"
 
 // FIXME: Rework netCreateBuf and netExPacket. We don't need to
 // duplicate the sender/receiver info the packet. This should be known
@@ -19,6 +20,7 @@
 
 Network::Network(Core *core)
       : _core(core)
+      , _numRemoteMemoryPackets(0)
 {
    LOG_ASSERT_ERROR(sizeof(g_type_to_static_network_map) / sizeof(EStaticNetwork) == NUM_PACKET_TYPES,
                     "Static network type map has incorrect number of entries.");
@@ -39,6 +41,8 @@ Network::Network(Core *core)
    for (SInt32 i = 0; i < NUM_STATIC_NETWORKS; i++)
       _models[i] = NetworkModel::createModel(this, modelTypes[i], (EStaticNetwork)i);
 
+   registerStatsMetric("network", _core->getId(), "remote-memory-packets", &_numRemoteMemoryPackets);
+
    LOG_PRINT("Initialized.");
 }
 
@@ -78,7 +82,9 @@ void Network::netPullFromTransport()
    {
       LOG_PRINT("Entering netPullFromTransport");
 
-      NetPacket packet(_transport->recv());
+      Byte *buffer = _transport->recv();
+      NetPacket packet(buffer);
+      _transport->release(buffer);
 
       LOG_PRINT("Pull packet : type %i, from %i, time %s", (SInt32)packet.type, packet.sender, itostr(packet.time).c_str());
       assert(0 <= packet.sender && packet.sender < _numMod);
@@ -154,6 +160,8 @@ SInt32 Network::netSend(NetPacket& packet)
    NetworkModel *model = _models[g_type_to_static_network_map[packet.type]];
 
    model->countPacket(packet);
+   if (g_type_to_static_network_map[packet.type] == STATIC_NETWORK_MEMORY_1 && packet.receiver != _tid)
+      ++_numRemoteMemoryPackets;
 
    std::vector<NetworkModel::Hop> hopVec;
    model->routePacket(packet, hopVec);
@@ -516,8 +524,6 @@ NetPacket::NetPacket(Byte *buffer)
       memcpy(data_buffer, buffer + sizeof(*this), length);
       data = data_buffer;
    }
-
-   delete [] buffer;
 }
 
 // This implementation is slightly wasteful because there is no need
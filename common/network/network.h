@@ -102,6 +102,9 @@ class Network
       // Modeling
       UInt32 getModeledLength(const NetPacket& pkt);
 
+      // Memory network packets sent to another core (cache misses to remote directories/DRAM, coherence traffic)
+      UInt64 getNumRemoteMemoryPackets() const { return _numRemoteMemoryPackets; }
+
    private:
       NetworkModel * _models[NUM_STATIC_NETWORKS];
 
@@ -114,6 +117,8 @@ class Network
       SInt32 _tid;
       SInt32 _numMod;
 
+      UInt64 _numRemoteMemoryPackets;
+
       NetQueue _netQueue;
       Lock _netQueueLock;
       ConditionVariable _netQueueCond;
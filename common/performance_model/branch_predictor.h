@@ -4,8 +4,9 @@
 #include <iostream>
 
 #include "fixed_types.h"
+#include "checkpoint.h"
 
-class BranchPredictor
+class BranchPredictor : public Checkpointable
 {
 public:
    BranchPredictor();
@@ -23,6 +24,10 @@ public:
 
    void resetCounters();
 
+   // Predictor tables, for checkpointing
+   virtual void saveState(CheckpointWriter &writer) {}
+   virtual void loadState(CheckpointReader &reader) {}
+
 protected:
    void updateCounters(bool predicted, bool actual);
 
@@ -259,6 +259,36 @@ public:
 
    }
 
+   void saveState(CheckpointWriter &writer)
+   {
+      writer.write(m_lru_use_count);
+      for (unsigned int w = 0 ; w < m_num_ways ; ++w )
+      {
+         writer.writeVector(m_ways[w].m_tags);
+         writer.writeVector(m_ways[w].m_previous_actual);
+         writer.writeVector(m_ways[w].m_enabled);
+         writer.writeVector(m_ways[w].m_predictors);
+         writer.writeVector(m_ways[w].m_lru);
+         writer.writeVector(m_ways[w].m_count);
+         writer.writeVector(m_ways[w].m_limit);
+      }
+   }
+
+   void loadState(CheckpointReader &reader)
+   {
+      reader.read(m_lru_use_count);
+      for (unsigned int w = 0 ; w < m_num_ways ; ++w )
+      {
+         reader.readVector(m_ways[w].m_tags);
+         reader.readVector(m_ways[w].m_previous_actual);
+         reader.readVector(m_ways[w].m_enabled);
+         reader.readVector(m_ways[w].m_predictors);
+         reader.readVector(m_ways[w].m_lru);
+         reader.readVector(m_ways[w].m_count);
+         reader.readVector(m_ways[w].m_limit);
+      }
+   }
+
 private:
 
    class Way
@@ -23,3 +23,16 @@ void OneBitBranchPredictor::update(bool predicted, bool actual, IntPtr ip, IntPt
    UInt32 index = ip % m_bits.size();
    m_bits[index] = actual;
 }
+
+void OneBitBranchPredictor::saveState(CheckpointWriter &writer)
+{
+   writer.write<UInt64>(m_bits.size());
+   writer.writeVector(m_bits);
+}
+
+void OneBitBranchPredictor::loadState(CheckpointReader &reader)
+{
+   if (!reader.check(m_bits.size(), "table size"))
+      return;
+   reader.readVector(m_bits);
+}
@@ -86,3 +86,27 @@ void PentiumMBranchPredictor::update_pir(bool actual, IntPtr ip, IntPtr target,
 
    m_pir = ((m_pir << 2) ^ rhs) & 0x7fff;
 }
+
+void PentiumMBranchPredictor::saveState(CheckpointWriter &writer)
+{
+   m_global_predictor.saveState(writer);
+   m_btb.saveState(writer);
+   m_bimodal_table.saveState(writer);
+   m_lpb.saveState(writer);
+   writer.write(m_pir);
+   writer.write(m_last_gp_hit);
+   writer.write(m_last_bm_pred);
+   writer.write(m_last_lpb_hit);
+}
+
+void PentiumMBranchPredictor::loadState(CheckpointReader &reader)
+{
+   m_global_predictor.loadState(reader);
+   m_btb.loadState(reader);
+   m_bimodal_table.loadState(reader);
+   m_lpb.loadState(reader);
+   reader.read(m_pir);
+   reader.read(m_last_gp_hit);
+   reader.read(m_last_bm_pred);
+   reader.read(m_last_lpb_hit);
+}
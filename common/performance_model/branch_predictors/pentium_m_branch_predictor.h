@@ -20,6 +20,9 @@ public:
 
    void update(bool predicted, bool actual, IntPtr ip, IntPtr target);
 
+   void saveState(CheckpointWriter &writer);
+   void loadState(CheckpointReader &reader);
+
 private:
 
    void update_pir(bool actual, IntPtr ip, IntPtr target, BranchPredictorReturnValue::BranchType branch_type);
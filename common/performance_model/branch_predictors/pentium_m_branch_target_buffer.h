@@ -90,6 +90,26 @@ public:
       m_ways[lru_way].m_plru[index] = m_lru_use_count++;
    }
 
+   void saveState(CheckpointWriter &writer)
+   {
+      writer.write(m_lru_use_count);
+      for (unsigned int w = 0 ; w < NUM_WAYS ; ++w )
+      {
+         writer.writeVector(m_ways[w].m_tag_offset);
+         writer.writeVector(m_ways[w].m_plru);
+      }
+   }
+
+   void loadState(CheckpointReader &reader)
+   {
+      reader.read(m_lru_use_count);
+      for (unsigned int w = 0 ; w < NUM_WAYS ; ++w )
+      {
+         reader.readVector(m_ways[w].m_tag_offset);
+         reader.readVector(m_ways[w].m_plru);
+      }
+   }
+
 private:
    std::vector<Way> m_ways;
    UInt64 m_lru_use_count;
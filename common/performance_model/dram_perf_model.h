@@ -7,6 +7,7 @@
 #include "dram_cntlr_interface.h"
 
 class ShmemPerf;
+class AddressHomeLookup;
 
 // Note: Each Dram Controller owns a single DramModel object
 // Hence, m_dram_bandwidth is the bandwidth for a single DRAM controller
@@ -26,7 +27,7 @@ class DramPerfModel
       UInt64 m_num_accesses;
 
    public:
-      static DramPerfModel* createDramPerfModel(core_id_t core_id, UInt32 cache_block_size);
+      static DramPerfModel* createDramPerfModel(core_id_t core_id, UInt32 cache_block_size, AddressHomeLookup* address_home_lookup = NULL);
 
       DramPerfModel(core_id_t core_id, UInt64 cache_block_size) : m_enabled(false), m_num_accesses(0) {}
       virtual ~DramPerfModel() {}
@@ -0,0 +1,274 @@
+#include "dram_perf_model_banked.h"
+#include "simulator.h"
+#include "config.h"
+#include "config.hpp"
+#include "stats.h"
+#include "shmem_perf.h"
+#include "utils.h"
+#include "address_home_lookup.h"
+
+#include <algorithm>
+
+static SubsecondTime getTiming(String name)
+{
+   // Operate in fs for higher precision before converting to uint64_t/SubsecondTime
+   return SubsecondTime::FS() * static_cast<uint64_t>(TimeConverter<float>::NStoFS(Sim()->getCfg()->getFloat("perf_model/dram/banked/" + name)));
+}
+
+DramPerfModelBanked::DramPerfModelBanked(core_id_t core_id,
+      UInt32 cache_block_size,
+      AddressHomeLookup* address_home_lookup):
+   DramPerfModel(core_id, cache_block_size),
+   m_address_home_lookup(address_home_lookup),
+   m_num_channels(Sim()->getCfg()->getInt("perf_model/dram/banked/num_channels")),
+   m_num_ranks(Sim()->getCfg()->getInt("perf_model/dram/banked/num_ranks")),
+   m_num_banks(Sim()->getCfg()->getInt("perf_model/dram/banked/num_banks")),
+   m_controller_latency(getTiming("controller_latency")),
+   m_tCAS(getTiming("tCAS")),
+   m_tRCD(getTiming("tRCD")),
+   m_tRP(getTiming("tRP")),
+   m_tRAS(getTiming("tRAS")),
+   m_tRRD(getTiming("tRRD")),
+   m_tFAW(getTiming("tFAW")),
+   m_tREFI(getTiming("tREFI").getFS()),
+   m_tRFC(getTiming("tRFC").getFS()),
+   m_row_hit_cap(Sim()->getCfg()->getInt("perf_model/dram/banked/row_hit_cap")),
+   m_channel_bandwidth(8 * Sim()->getCfg()->getFloat("perf_model/dram/per_controller_bandwidth") / m_num_channels), // Convert bytes to bits
+   m_total_read_queueing_delay(SubsecondTime::Zero()),
+   m_total_write_queueing_delay(SubsecondTime::Zero()),
+   m_total_access_latency(SubsecondTime::Zero())
+{
+   LOG_ASSERT_ERROR(isPower2(m_num_channels) && isPower2(m_num_ranks) && isPower2(m_num_banks),
+                    "DRAM num_channels (%u), num_ranks (%u) and num_banks (%u) should be powers of two", m_num_channels, m_num_ranks, m_num_banks);
+   LOG_ASSERT_ERROR(m_tRFC == 0 || m_tRFC < m_tREFI, "DRAM tRFC should be shorter than tREFI");
+
+   parseAddressMapping(Sim()->getCfg()->getString("perf_model/dram/banked/address_mapping"),
+                       Sim()->getCfg()->getInt("perf_model/dram/banked/page_size"), cache_block_size);
+
+   m_burst_time = m_channel_bandwidth.getRoundedLatency(8 * cache_block_size); // bytes to bits
+
+   Bank bank;
+   bank.open_row = NO_ROW;
+   bank.activate_time = SubsecondTime::Zero();
+   bank.next_column = SubsecondTime::Zero();
+   bank.closed_row = NO_ROW;
+   bank.close_time = SubsecondTime::Zero();
+   bank.closed_next_column = SubsecondTime::Zero();
+   bank.num_bypassed = 0;
+   bank.row_hits = 0;
+   bank.row_misses = 0;
+   bank.row_conflicts = 0;
+   bank.queueing_delay = SubsecondTime::Zero();
+   m_banks.resize(m_num_channels * m_num_ranks * m_num_banks, bank);
+
+   Rank rank;
+   rank.last_activate = SubsecondTime::Zero();
+   for(UInt32 i = 0; i < 4; ++i)
+      rank.activates[i] = SubsecondTime::Zero();
+   rank.next_activate = 0;
+   m_ranks.resize(m_num_channels * m_num_ranks, rank);
+
+   if (Sim()->getCfg()->getBool("perf_model/dram/queue_model/enabled"))
+   {
+      for(UInt32 channel = 0; channel < m_num_channels; ++channel)
+         m_queue_models.push_back(QueueModel::create(m_num_channels > 1 ? "dram-queue-" + itostr(channel) : "dram-queue",
+                                                     core_id, Sim()->getCfg()->getString("perf_model/dram/queue_model/type"), m_burst_time));
+   }
+
+   registerStatsMetric("dram", core_id, "total-access-latency", &m_total_access_latency);
+   registerStatsMetric("dram", core_id, "total-read-queueing-delay", &m_total_read_queueing_delay);
+   registerStatsMetric("dram", core_id, "total-write-queueing-delay", &m_total_write_queueing_delay);
+   for(UInt32 i = 0; i < m_banks.size(); ++i)
+   {
+      registerStatsMetric("dram", core_id, "row-hits[" + itostr(i) + "]", &m_banks[i].row_hits);
+      registerStatsMetric("dram", core_id, "row-misses[" + itostr(i) + "]", &m_banks[i].row_misses);
+      registerStatsMetric("dram", core_id, "row-conflicts[" + itostr(i) + "]", &m_banks[i].row_conflicts);
+      registerStatsMetric("dram", core_id, "bank-queueing-delay[" + itostr(i) + "]", &m_banks[i].queueing_delay);
+   }
+}
+
+DramPerfModelBanked::~DramPerfModelBanked()
+{
+   for(std::vector<QueueModel*>::iterator it = m_queue_models.begin(); it != m_queue_models.end(); ++it)
+      delete *it;
+}
+
+void
+DramPerfModelBanked::parseAddressMapping(String mapping, UInt32 page_size, UInt32 cache_block_size)
+{
+   LOG_ASSERT_ERROR(isPower2(page_size) && page_size >= cache_block_size, "DRAM page_size (%u) should be a power of two of at least one cache block", page_size);
+
+   UInt32 bits[NUM_FIELDS];
+   bits[FIELD_ROW] = 64; // Whatever remains
+   bits[FIELD_RANK] = floorLog2(m_num_ranks);
+   bits[FIELD_BANK] = floorLog2(m_num_banks);
+   bits[FIELD_CHANNEL] = floorLog2(m_num_channels);
+   bits[FIELD_COLUMN] = floorLog2(page_size);
+
+   // Fields are listed from most to least significant, assign their bit positions from the end
+   std::vector<field_t> fields;
+   size_t i = 0;
+   while (true)
+   {
+      size_t position = mapping.find(':', i);
+      String name = mapping.substr(i, position == String::npos ? String::npos : position - i);
+      if (name == "row")
+         fields.push_back(FIELD_ROW);
+      else if (name == "rank")
+         fields.push_back(FIELD_RANK);
+      else if (name == "bank")
+         fields.push_back(FIELD_BANK);
+      else if (name == "channel")
+         fields.push_back(FIELD_CHANNEL);
+      else if (name == "column")
+         fields.push_back(FIELD_COLUMN);
+      else
+         LOG_PRINT_ERROR("Invalid field %s in DRAM address mapping %s", name.c_str(), mapping.c_str());
+
+      if (position == String::npos)
+         break;
+      i = position + 1;
+   }
+
+   LOG_ASSERT_ERROR(fields.size() == NUM_FIELDS && fields[0] == FIELD_ROW,
+                    "DRAM address mapping %s should list row, rank, bank, channel and column once, starting with row", mapping.c_str());
+
+   UInt32 shift = 0;
+   bool seen[NUM_FIELDS] = { false };
+   for(std::vector<field_t>::reverse_iterator it = fields.rbegin(); it != fields.rend(); ++it)
+   {
+      LOG_ASSERT_ERROR(!seen[*it], "DRAM address mapping %s lists a field more than once", mapping.c_str());
+      seen[*it] = true;
+      m_field_shift[*it] = shift;
+      m_field_mask[*it] = bits[*it] >= 64 ? ~UInt64(0) : (UInt64(1) << bits[*it]) - 1;
+      shift += bits[*it];
+   }
+}
+
+SubsecondTime
+DramPerfModelBanked::afterRefresh(UInt32 rank, SubsecondTime time) const
+{
+   // Ranks are refreshed every tREFI, staggered, delay commands that fall inside a refresh
+   if (m_tRFC == 0)
+      return time;
+   UInt64 phase = (time.getFS() + rank * m_tREFI / m_ranks.size()) % m_tREFI;
+   if (phase < m_tRFC)
+      return time + SubsecondTime::FS(m_tRFC - phase);
+   else
+      return time;
+}
+
+bool
+DramPerfModelBanked::refreshedSince(UInt32 rank, SubsecondTime since, SubsecondTime time) const
+{
+   if (m_tRFC == 0 || time <= since)
+      return false;
+   UInt64 offset = rank * m_tREFI / m_ranks.size();
+   return (since.getFS() + offset) / m_tREFI != (time.getFS() + offset) / m_tREFI;
+}
+
+SubsecondTime
+DramPerfModelBanked::getAccessLatency(SubsecondTime pkt_time, UInt64 pkt_size, core_id_t requester, IntPtr address, DramCntlrInterface::access_t access_type, ShmemPerf *perf)
+{
+   if ((!m_enabled) ||
+         (requester >= (core_id_t) Config::getSingleton()->getApplicationCores()))
+   {
+      return SubsecondTime::Zero();
+   }
+
+   // Remove the controller-interleaving bits, so consecutive addresses within this controller map onto consecutive columns
+   IntPtr local_address = m_address_home_lookup ? m_address_home_lookup->getLinearAddress(address) : address;
+   UInt32 channel = getField(local_address, FIELD_CHANNEL);
+   UInt32 rank_index = channel * m_num_ranks + getField(local_address, FIELD_RANK);
+   UInt64 row = getField(local_address, FIELD_ROW);
+   Bank &bank = m_banks[rank_index * m_num_banks + getField(local_address, FIELD_BANK)];
+   Rank &rank = m_ranks[rank_index];
+
+   SubsecondTime time = pkt_time + m_controller_latency;
+   bool open = bank.open_row != NO_ROW && !refreshedSince(rank_index, bank.activate_time, time);
+
+   // Time of our column command, and how long we need the bank for ourselves until then
+   SubsecondTime column, own_time;
+   if (open && row == bank.open_row)
+   {
+      column = afterRefresh(rank_index, std::max(time, bank.next_column));
+      bank.next_column = column + m_burst_time;
+      own_time = SubsecondTime::Zero();
+      ++bank.row_hits;
+   }
+   else if (open && row == bank.closed_row && time < bank.close_time && bank.num_bypassed < m_row_hit_cap)
+   {
+      // FR-FCFS: served before the conflicting request that is waiting to close this row,
+      // the precharge and everything after it moves back if needed
+      column = std::max(time, bank.closed_next_column);
+      bank.closed_next_column = column + m_burst_time;
+      ++bank.num_bypassed;
+      if (bank.closed_next_column > bank.close_time)
+      {
+         SubsecondTime shift = bank.closed_next_column - bank.close_time;
+         bank.close_time += shift;
+         bank.activate_time += shift;
+         bank.next_column += shift;
+      }
+      own_time = SubsecondTime::Zero();
+      ++bank.row_hits;
+   }
+   else
+   {
+      SubsecondTime activate;
+      if (open)
+      {
+         SubsecondTime precharge = std::max(std::max(time, bank.next_column), bank.activate_time + m_tRAS);
+         bank.closed_row = bank.open_row;
+         bank.close_time = precharge;
+         bank.closed_next_column = bank.next_column;
+         bank.num_bypassed = 0;
+         activate = precharge + m_tRP;
+         own_time = m_tRP + m_tRCD;
+         ++bank.row_conflicts;
+      }
+      else
+      {
+         activate = std::max(time, bank.next_column);
+         bank.closed_row = NO_ROW;
+         own_time = m_tRCD;
+         ++bank.row_misses;
+      }
+
+      // Activates in a rank are tRRD apart, and at most four of them fit in tFAW
+      activate = std::max(activate, rank.last_activate + m_tRRD);
+      activate = std::max(activate, rank.activates[rank.next_activate] + m_tFAW);
+      activate = afterRefresh(rank_index, activate);
+      rank.last_activate = std::max(rank.last_activate, activate);
+      rank.activates[rank.next_activate] = activate;
+      rank.next_activate = (rank.next_activate + 1) % 4;
+
+      bank.open_row = row;
+      bank.activate_time = activate;
+      column = activate + m_tRCD;
+      bank.next_column = column + m_burst_time;
+   }
+
+   SubsecondTime bank_queue_delay = column - time - own_time;
+   SubsecondTime data_time = column + m_tCAS;
+   SubsecondTime bus_queue_delay = m_queue_models.size() ? m_queue_models[channel]->computeQueueDelay(data_time, m_burst_time, requester) : SubsecondTime::Zero();
+   SubsecondTime queue_delay = bank_queue_delay + bus_queue_delay;
+   SubsecondTime access_latency = data_time + bus_queue_delay + m_burst_time - pkt_time;
+
+   perf->updateTime(pkt_time);
+   perf->updateTime(time + bank_queue_delay, ShmemPerf::DRAM_QUEUE);
+   perf->updateTime(data_time, ShmemPerf::DRAM_DEVICE);
+   perf->updateTime(data_time + bus_queue_delay, ShmemPerf::DRAM_QUEUE);
+   perf->updateTime(data_time + bus_queue_delay + m_burst_time, ShmemPerf::DRAM_BUS);
+
+   // Update Memory Counters
+   m_num_accesses ++;
+   m_total_access_latency += access_latency;
+   bank.queueing_delay += bank_queue_delay;
+   if (access_type == DramCntlrInterface::READ)
+      m_total_read_queueing_delay += queue_delay;
+   else
+      m_total_write_queueing_delay += queue_delay;
+
+   return access_latency;
+}
@@ -0,0 +1,112 @@
+#ifndef __DRAM_PERF_MODEL_BANKED_H__
+#define __DRAM_PERF_MODEL_BANKED_H__
+
+#include "dram_perf_model.h"
+#include "queue_model.h"
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "dram_cntlr_interface.h"
+
+#include <vector>
+
+class AddressHomeLookup;
+
+// DRAM model with channels, ranks and banks (perf_model/dram/type = banked)
+//
+// Each controller has num_channels channels of num_ranks ranks of num_banks banks. Addresses are split into
+// row, rank, bank, channel and column fields in the order given by perf_model/dram/banked/address_mapping
+// (most significant field first). Every bank keeps its open row: a row hit only needs a column command (tCAS),
+// an access to a closed bank an activate (tRCD) first, and a row conflict a precharge (tRP, not before tRAS
+// after the activate) as well. Activates in a rank are at least tRRD apart, at most four of them fit in tFAW,
+// and ranks are refreshed every tREFI for tRFC, which closes all their rows. Data is transferred over the
+// channel bus, with bandwidth per_controller_bandwidth / num_channels. Fields are taken from the address within
+// this controller, with the bits that select the controller (perf_model/dram/num_controllers) removed.
+//
+// Scheduling is FR-FCFS: row hits go before older row conflicts to the same bank, up to row_hit_cap of them.
+// Since requests are seen one at a time, a conflict only closes its bank's row when it gets its precharge:
+// row hits that arrive before that are served from the old row, and move the precharge back.
+
+class DramPerfModelBanked : public DramPerfModel
+{
+   private:
+      enum field_t
+      {
+         FIELD_ROW,
+         FIELD_RANK,
+         FIELD_BANK,
+         FIELD_CHANNEL,
+         FIELD_COLUMN,
+         NUM_FIELDS
+      };
+
+      static const UInt64 NO_ROW = ~UInt64(0);
+
+      struct Bank
+      {
+         UInt64 open_row;                 // Row in the row buffer, or NO_ROW
+         SubsecondTime activate_time;     // When open_row was activated
+         SubsecondTime next_column;       // Earliest time for the next column command to open_row
+         // The row that was replaced by open_row is still open for row hits until close_time (FR-FCFS)
+         UInt64 closed_row;
+         SubsecondTime close_time;
+         SubsecondTime closed_next_column;
+         UInt32 num_bypassed;
+
+         UInt64 row_hits;
+         UInt64 row_misses;
+         UInt64 row_conflicts;
+         SubsecondTime queueing_delay;
+      };
+
+      struct Rank
+      {
+         SubsecondTime last_activate;
+         SubsecondTime activates[4];      // The last four activates, for tFAW
+         UInt32 next_activate;
+      };
+
+      AddressHomeLookup *m_address_home_lookup;
+      const UInt32 m_num_channels;
+      const UInt32 m_num_ranks;
+      const UInt32 m_num_banks;
+      UInt32 m_field_shift[NUM_FIELDS];
+      UInt64 m_field_mask[NUM_FIELDS];
+
+      SubsecondTime m_controller_latency;
+      SubsecondTime m_tCAS;
+      SubsecondTime m_tRCD;
+      SubsecondTime m_tRP;
+      SubsecondTime m_tRAS;
+      SubsecondTime m_tRRD;
+      SubsecondTime m_tFAW;
+      UInt64 m_tREFI;                     // In fs, for the modulo arithmetic
+      UInt64 m_tRFC;
+      const UInt32 m_row_hit_cap;
+
+      ComponentBandwidth m_channel_bandwidth;
+      SubsecondTime m_burst_time;
+
+      std::vector<Bank> m_banks;
+      std::vector<Rank> m_ranks;
+      std::vector<QueueModel*> m_queue_models;  // Channel data buses
+
+      SubsecondTime m_total_read_queueing_delay;
+      SubsecondTime m_total_write_queueing_delay;
+      SubsecondTime m_total_access_latency;
+
+      void parseAddressMapping(String mapping, UInt32 page_size, UInt32 cache_block_size);
+      UInt64 getField(IntPtr address, field_t field) const { return (address >> m_field_shift[field]) & m_field_mask[field]; }
+      SubsecondTime afterRefresh(UInt32 rank, SubsecondTime time) const;
+      bool refreshedSince(UInt32 rank, SubsecondTime since, SubsecondTime time) const;
+
+   public:
+      DramPerfModelBanked(core_id_t core_id,
+            UInt32 cache_block_size,
+            AddressHomeLookup* address_home_lookup);
+
+      ~DramPerfModelBanked();
+
+      SubsecondTime getAccessLatency(SubsecondTime pkt_time, UInt64 pkt_size, core_id_t requester, IntPtr address, DramCntlrInterface::access_t access_type, ShmemPerf *perf);
+};
+
+#endif /* __DRAM_PERF_MODEL_BANKED_H__ */
@@ -0,0 +1,203 @@
+#include "free_interval_list.h"
+#include "log.h"
+#include "utils.h"
+
+#include <algorithm>
+
+FreeIntervalList::FreeIntervalList(UInt32 max_size, SubsecondTime min_interval, Interval initial)
+   : m_mask((1 << ceilLog2(max_size + 1)) - 1)
+   , m_max_size(max_size)
+   , m_min_interval(min_interval)
+   , m_head(0)
+   , m_size(1)
+   , m_num_valid(0)
+{
+   LOG_ASSERT_ERROR(max_size >= 1, "Free interval list should hold at least one interval");
+   // One more than max_size, as a request can split an interval before we trim the list
+   m_entries = new Entry[m_mask + 1];
+   m_entries[0].interval = initial;
+}
+
+FreeIntervalList::~FreeIntervalList()
+{
+   delete [] m_entries;
+}
+
+UInt32
+FreeIntervalList::findInterval(SubsecondTime pkt_time, SubsecondTime processing_time)
+{
+   // Return the index of the first interval the request fits in, or that starts after pkt_time (m_size if none)
+   SubsecondTime pkt_end = pkt_time + processing_time;
+
+   // Under heavy load, requests mostly go to one of the first few intervals: try those before searching
+   UInt32 num_probe = std::min(m_size, (UInt32)LINEAR_PROBE);
+   for(UInt32 index = 0; index < num_probe; ++index)
+   {
+      const Interval &interval = at(index);
+      if ((pkt_time >= interval.first && pkt_end <= interval.second) || pkt_time < interval.first)
+         return index;
+   }
+   if (num_probe == m_size)
+      return m_size;
+
+   // First interval ending after pkt_time, or at/after pkt_end. End times are non-decreasing.
+   UInt32 lo = 0, hi = m_size;
+   while (lo < hi)
+   {
+      UInt32 mid = (lo + hi) / 2;
+      if (at(mid).second > pkt_time || at(mid).second >= pkt_end)
+         hi = mid;
+      else
+         lo = mid + 1;
+   }
+   UInt32 index = lo;
+
+   // The request doesn't fit in any interval before that, but one of them may start after pkt_time.
+   // Search the entries with a valid max_first, or else extend those until we find one.
+   UInt32 num_valid = std::min(m_num_valid, index);
+   if (num_valid && entry(num_valid - 1).max_first > pkt_time)
+   {
+      lo = 0;
+      hi = num_valid;
+      while (lo < hi)
+      {
+         UInt32 mid = (lo + hi) / 2;
+         if (entry(mid).max_first > pkt_time)
+            hi = mid;
+         else
+            lo = mid + 1;
+      }
+   }
+   else
+   {
+      lo = index;
+      while (m_num_valid < index)
+         if (validateNext() > pkt_time)
+         {
+            lo = m_num_valid - 1;
+            break;
+         }
+   }
+   if (lo < index || index == m_size)
+      return lo;
+
+   const Interval &interval = at(index);
+   if ((pkt_time >= interval.first && pkt_end <= interval.second) || pkt_time < interval.first)
+      return index;
+   else
+      // This interval ends after pkt_time, so the next one starts after it
+      return index + 1;
+}
+
+SubsecondTime
+FreeIntervalList::validateNext()
+{
+   // Compute max_first of the first entry that doesn't have a valid one
+   Entry &e = entry(m_num_valid);
+   e.max_first = m_num_valid ? std::max(entry(m_num_valid - 1).max_first, e.interval.first) : e.interval.first;
+   ++m_num_valid;
+   return e.max_first;
+}
+
+void
+FreeIntervalList::replace(UInt32 index, const Interval *intervals, UInt32 count)
+{
+   // Replace the interval at index by count (0, 1 or 2) intervals, moving the shorter side of the ring
+   if (count == 0)
+   {
+      if (index < m_size / 2)
+      {
+         for(UInt32 i = index; i > 0; --i)
+            entry(i) = entry(i - 1);
+         m_head = (m_head + 1) & m_mask;
+      }
+      else
+      {
+         for(UInt32 i = index; i < m_size - 1; ++i)
+            entry(i) = entry(i + 1);
+      }
+      --m_size;
+   }
+   else if (count == 1)
+   {
+      entry(index).interval = intervals[0];
+   }
+   else
+   {
+      if (index < m_size / 2)
+      {
+         m_head = (m_head - 1) & m_mask;
+         for(UInt32 i = 0; i < index; ++i)
+            entry(i) = entry(i + 1);
+      }
+      else
+      {
+         for(UInt32 i = m_size; i > index + 1; --i)
+            entry(i) = entry(i - 1);
+      }
+      entry(index).interval = intervals[0];
+      entry(index + 1).interval = intervals[1];
+      ++m_size;
+   }
+
+   // Entries before index are unchanged, as are their max_first values
+   m_num_valid = std::min(m_num_valid, index);
+}
+
+SubsecondTime
+FreeIntervalList::allocate(SubsecondTime pkt_time, SubsecondTime processing_time)
+{
+   UInt32 index = findInterval(pkt_time, processing_time);
+   if (index == m_size)
+      return SubsecondTime::MaxTime();
+
+   Interval interval = at(index);
+   Interval remaining[2];
+   UInt32 count = 0;
+   SubsecondTime queue_delay;
+
+   if ((pkt_time >= interval.first) && ((pkt_time + processing_time) <= interval.second))
+   {
+      queue_delay = SubsecondTime::Zero();
+      if ((pkt_time - interval.first) >= m_min_interval)
+         remaining[count++] = Interval(interval.first, pkt_time);
+      if ((interval.second - (pkt_time + processing_time)) >= m_min_interval)
+         remaining[count++] = Interval(pkt_time + processing_time, interval.second);
+   }
+   else
+   {
+      // WH: The request comes before this free part, but doesn't fit. It doesn't make sense to me to
+      //     demand a fit and move this request down even further. In reality, this request would have most
+      //     likely executed at interval.first, while later request would/could be delayed. But it's too late
+      //     for that now.
+      //     (If we assume all wait times are additive then the average works out by shifting it down,
+      //      but since this is an interactive simulation all delays propagate through the system
+      //      so this won't be accurate.)
+      // Note that when processing_time is longer than the interval, the difference below wraps around and
+      // we keep an interval that starts after it ends
+      queue_delay = interval.first - pkt_time;
+      if ((interval.second - (interval.first + processing_time)) >= m_min_interval)
+         remaining[count++] = Interval(interval.first + processing_time, interval.second);
+   }
+
+   replace(index, remaining, count);
+
+   if (m_size > m_max_size)
+   {
+      m_head = (m_head + 1) & m_mask;
+      --m_size;
+      // The remaining valid entries keep their order, once one of them has the same max_first as before, so do all after it
+      if (m_num_valid)
+         --m_num_valid;
+      for(UInt32 index = 0; index < m_num_valid; ++index)
+      {
+         Entry &e = entry(index);
+         SubsecondTime max_first = index ? std::max(entry(index - 1).max_first, e.interval.first) : e.interval.first;
+         if (max_first == e.max_first)
+            break;
+         e.max_first = max_first;
+      }
+   }
+
+   return queue_delay;
+}
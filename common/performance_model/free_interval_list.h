@@ -0,0 +1,61 @@
+#ifndef __FREE_INTERVAL_LIST_H__
+#define __FREE_INTERVAL_LIST_H__
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+
+#include <utility>
+
+// The free intervals of QueueModelHistoryList, kept sorted in a ring buffer of at most max_size entries.
+//
+// The list used to be a std::list that was walked linearly, with a node allocated or freed on most requests.
+// Intervals never overlap: each one starts at or after the end of the previous one, so their end times are
+// non-decreasing and the interval a request fits in can be found with a binary search. Start times are not
+// always sorted though: an interval that was shortened by a request longer than itself has its start moved
+// beyond its end (and possibly beyond later intervals), the linear walk then treated it as an interval to
+// queue behind. To give the exact same delays, each entry also holds the largest start time up to it, so the
+// first interval starting after a request can be found with a binary search as well.
+
+class FreeIntervalList
+{
+   public:
+      typedef std::pair<SubsecondTime, SubsecondTime> Interval;
+
+      FreeIntervalList(UInt32 max_size, SubsecondTime min_interval, Interval initial);
+      ~FreeIntervalList();
+
+      // Schedule a request arriving at pkt_time and taking processing_time in the first interval it fits in,
+      // or at the start of the first interval after pkt_time. Returns the queue delay, or MaxTime if there is no such interval.
+      SubsecondTime allocate(SubsecondTime pkt_time, SubsecondTime processing_time);
+
+      UInt32 size() const { return m_size; }
+      const Interval& front() const { return at(0); }
+      const Interval& back() const { return at(m_size - 1); }
+
+   private:
+      static const UInt32 LINEAR_PROBE = 4;
+
+      struct Entry
+      {
+         Interval interval;
+         SubsecondTime max_first;   // Latest start time of this and all preceding intervals
+      };
+
+      Entry *m_entries;
+      const UInt32 m_mask;
+      const UInt32 m_max_size;
+      const SubsecondTime m_min_interval;
+      UInt32 m_head;
+      UInt32 m_size;
+      UInt32 m_num_valid;           // Number of leading entries with an up-to-date max_first
+
+      Entry& entry(UInt32 index) { return m_entries[(m_head + index) & m_mask]; }
+      const Entry& entry(UInt32 index) const { return m_entries[(m_head + index) & m_mask]; }
+      const Interval& at(UInt32 index) const { return entry(index).interval; }
+
+      UInt32 findInterval(SubsecondTime pkt_time, SubsecondTime processing_time);
+      void replace(UInt32 index, const Interval *intervals, UInt32 count);
+      SubsecondTime validateNext();
+};
+
+#endif /* __FREE_INTERVAL_LIST_H__ */
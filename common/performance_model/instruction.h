@@ -30,12 +30,13 @@ enum InstructionType
    INST_TLB_MISS,
    INST_MEM_ACCESS, // Not a regular memory access.  These are added latencies and do not correspond to a particular instruction.  Dynamic Instruction
    INST_DELAY,
+   INST_PIM_REGION,
    INST_UNKNOWN,
    MAX_INSTRUCTION_COUNT
 };
 
 __attribute__ ((unused)) static const char * INSTRUCTION_NAMES [] =
-{"generic","add","sub","mul","div","fadd","fsub","fmul","fdiv","jmp","branch", "dynamic_misc","recv","sync","spawn","tlb_miss","mem_access","delay","unknown"};
+{"generic","add","sub","mul","div","fadd","fsub","fmul","fdiv","jmp","branch", "dynamic_misc","recv","sync","spawn","tlb_miss","mem_access","delay","pim_region","unknown"};
 
 class Instruction
 {
@@ -233,6 +234,22 @@ private:
    delay_type_t m_delay_type;
 };
 
+// entry into or exit from a near-memory offload region (SimPimRegionBegin/End)
+class PimRegionInstruction : public PseudoInstruction
+{
+public:
+   PimRegionInstruction(bool begin, UInt64 region)
+      : PseudoInstruction(SubsecondTime::Zero(), INST_PIM_REGION)
+      , m_begin(begin)
+      , m_region(region)
+   { }
+   bool isBegin() const { return m_begin; }
+   UInt64 getRegion() const { return m_region; }
+private:
+   bool m_begin;
+   UInt64 m_region;
+};
+
 class UnknownInstruction : public PseudoInstruction
 {
 public:
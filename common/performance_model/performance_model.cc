@@ -1,6 +1,7 @@
 #include "core.h"
 #include "performance_model.h"
 #include "fastforward_performance_model.h"
+#include "pim_performance_model.h"
 #include "branch_predictor.h"
 #include "simulator.h"
 #include "oneipc_performance_model.h"
@@ -55,6 +56,7 @@ PerformanceModel::PerformanceModel(Core *core)
    , m_fastforward(false)
    , m_fastforward_model(new FastforwardPerformanceModel(core, this))
    , m_detailed_sync(true)
+   , m_pim_model(PimPerformanceModel::create(core, this))
    , m_hold(false)
    , m_instruction_count(0)
    , m_elapsed_time(Sim()->getDvfsManager()->getCoreDomain(core->getId()))
@@ -89,12 +91,16 @@ PerformanceModel::PerformanceModel(Core *core)
    registerStatsMetric("performance_model", core->getId(), "cpiSyncDvfsTransition", &m_cpiSyncDvfsTransition);
 
    registerStatsMetric("performance_model", core->getId(), "cpiRecv", &m_cpiRecv);
+
+   registerCheckpointObject("performance_model", core->getId(), this);
 }
 
 PerformanceModel::~PerformanceModel()
 {
    delete m_bp;
    delete m_fastforward_model;
+   if (m_pim_model)
+      delete m_pim_model;
    if (m_instruction_tracer)
       delete m_instruction_tracer;
 }
@@ -306,7 +312,11 @@ void PerformanceModel::iterate()
       LOG_ASSERT_ERROR(!ins->instruction->isIdle(), "Idle instructions should not make it here!");
 
       if (!m_fastforward && m_enabled)
-         handleInstruction(ins);
+      {
+         // Near-memory regions may be executed by the PIM core instead
+         if (!m_pim_model || !m_pim_model->handleInstruction(ins))
+            handleInstruction(ins);
+      }
 
       delete ins;
 
@@ -335,6 +345,18 @@ void PerformanceModel::incrementIdleElapsedTime(SubsecondTime time)
       m_fastforward_model->notifyElapsedTimeUpdate();
 }
 
+void PerformanceModel::saveState(CheckpointWriter &writer)
+{
+   writer.write<UInt64>(getElapsedTime().getFS());
+}
+
+void PerformanceModel::loadState(CheckpointReader &reader)
+{
+   SubsecondTime time = SubsecondTime::FS(reader.read<UInt64>());
+   if (time > getElapsedTime())
+      setElapsedTime(time);
+}
+
 // Only called at the start of a new thread (SPAWN_INST)
 void PerformanceModel::setElapsedTime(SubsecondTime time)
 {
@@ -8,6 +8,7 @@
 #include "subsecond_time.h"
 #include "instruction_tracer.h"
 #include "hit_where.h"
+#include "checkpoint.h"
 
 #include <queue>
 #include <iostream>
@@ -16,12 +17,13 @@
 class Core;
 class BranchPredictor;
 class FastforwardPerformanceModel;
+class PimPerformanceModel;
 class Instruction;
 class PseudoInstruction;
 class DynamicInstruction;
 class Allocator;
 
-class PerformanceModel
+class PerformanceModel : public Checkpointable
 {
 public:
    PerformanceModel(Core* core);
@@ -38,6 +40,10 @@ public:
    SubsecondTime getElapsedTime() const { return m_elapsed_time.getElapsedTime(); }
    SubsecondTime getNonIdleElapsedTime() const { return getElapsedTime() - m_idle_elapsed_time.getElapsedTime(); }
 
+   // Checkpoints contain the core's clock, a restored core continues from the time at which the checkpoint was taken
+   void saveState(CheckpointWriter &writer);
+   void loadState(CheckpointReader &reader);
+
    void countInstructions(IntPtr address, UInt32 count);
    void handleMemoryLatency(SubsecondTime latency, HitWhere::where_t hit_where);
    void handleBranchMispredict();
@@ -86,6 +92,7 @@ public:
 protected:
    friend class SpawnInstruction;
    friend class FastforwardPerformanceModel;
+   friend class PimPerformanceModel;
 
    void setElapsedTime(SubsecondTime time);
    void incrementElapsedTime(SubsecondTime time) { m_elapsed_time.addLatency(time); }
@@ -120,6 +127,8 @@ private:
    FastforwardPerformanceModel* m_fastforward_model;
    bool m_detailed_sync;
 
+   PimPerformanceModel* m_pim_model;
+
    bool m_hold;
 
 protected:
@@ -24,6 +24,19 @@
 // Define to not skip any cycles, but assert that the skip logic is working fine
 //#define ASSERT_SKIP
 
+static bool isWakeupScheduler(String type)
+{
+   if (type == "scan")
+      return false;
+   else if (type == "wakeup")
+      return true;
+   else
+   {
+      LOG_PRINT_ERROR("Invalid rob_timer issue scheduler %s", type.c_str());
+      return false;
+   }
+}
+
 RobTimer::RobTimer(
          Core *core, PerformanceModel *_perf, const CoreModel *core_model,
          int misprediction_penalty,
@@ -37,6 +50,7 @@ RobTimer::RobTimer(
       , m_store_to_load_forwarding(Sim()->getCfg()->getBoolArray("perf_model/core/rob_timer/store_to_load_forwarding", core->getId()))
       , m_no_address_disambiguation(!Sim()->getCfg()->getBoolArray("perf_model/core/rob_timer/address_disambiguation", core->getId()))
       , inorder(Sim()->getCfg()->getBoolArray("perf_model/core/rob_timer/in_order", core->getId()))
+      , m_wakeup_scheduler(isWakeupScheduler(Sim()->getCfg()->getStringArray("perf_model/core/rob_timer/issue_scheduler", core->getId())))
       , m_core(core)
       , rob(window_size + 255)
       , m_num_in_rob(0)
@@ -56,6 +70,7 @@ RobTimer::RobTimer(
       , time_skipped(SubsecondTime::Zero())
       , registerDependencies(new RegisterDependencies())
       , memoryDependencies(new MemoryDependencies())
+      , m_oldest_not_done(0)
       , perf(_perf)
       , m_cpiCurrentFrontEndStall(NULL)
       , m_mlp_histogram(Sim()->getCfg()->getBoolArray("perf_model/core/rob_timer/mlp_histogram", core->getId()))
@@ -503,6 +518,14 @@ SubsecondTime RobTimer::doDispatch(SubsecondTime **cpiComponent)
          entry->ready = std::max(entry->ready, (now + 1ul).getElapsedTime());
          next_event = std::min(next_event, entry->ready);
 
+         if (m_wakeup_scheduler)
+         {
+            if (entry->ready != SubsecondTime::MaxTime())
+               scheduleEntry(entry);
+            if (uop.getMicroOp()->isStore())
+               m_pending_stores.push_back(uop.getSequenceNumber());
+         }
+
          #ifdef DEBUG_PERCYCLE
             std::cout<<"DISPATCH "<<entry->uop->getMicroOp()->toShortString()<<std::endl;
          #endif
@@ -630,6 +653,9 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
    entry->done = cycle_done;
    next_event = std::min(next_event, entry->done);
 
+   if (m_wakeup_scheduler)
+      m_done_heap.push(TimedSeqNr(entry->done, uop.getSequenceNumber()));
+
    --m_rs_entries_used;
 
    #ifdef DEBUG_PERCYCLE
@@ -650,6 +676,10 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
       {
          depEntry->ready = depEntry->readyMax;
          //std::cout<<"    ready @ "<<depEntry->ready<<std::endl;
+
+         // Uops that are not yet dispatched will be scheduled by doDispatch()
+         if (m_wakeup_scheduler && isDispatched(depEntry->uop->getSequenceNumber()))
+            scheduleEntry(depEntry);
       }
 
       // For stores, check if their address has been produced
@@ -694,6 +724,92 @@ void RobTimer::issueInstruction(uint64_t idx, SubsecondTime &next_event)
    }
 }
 
+bool RobTimer::canIssueEntry(RobEntry *entry, uint64_t num_issued, bool head_of_queue, bool have_unresolved_store, bool &no_more_load, bool &no_more_store, bool &stop)
+{
+   DynamicMicroOp *uop = entry->uop;
+
+   // See if we can issue this instruction
+
+   bool canIssue = false;
+
+   if (entry->ready > now)
+      canIssue = false;          // blocked by dependency
+
+   else if ((no_more_load && uop->getMicroOp()->isLoad()) || (no_more_store && uop->getMicroOp()->isStore()))
+      canIssue = false;          // blocked by mfence
+
+   else if (uop->getMicroOp()->isSerializing())
+   {
+      if (head_of_queue && last_store_done <= now)
+         canIssue = true;
+      else
+      {
+         stop = true;
+         return false;
+      }
+   }
+
+   else if (uop->getMicroOp()->isMemBarrier())
+   {
+      if (head_of_queue && last_store_done <= now)
+         canIssue = true;
+      else
+         // Don't issue any memory operations following a memory barrier
+         no_more_load = no_more_store = true;
+         // FIXME: L/SFENCE
+   }
+
+   else if (!m_rob_contention && num_issued == dispatchWidth)
+      canIssue = false;          // no issue contention: issue width == dispatch width
+
+   else if (uop->getMicroOp()->isLoad() && !load_queue.hasFreeSlot(now))
+      canIssue = false;          // load queue full
+
+   else if (uop->getMicroOp()->isLoad() && m_no_address_disambiguation && have_unresolved_store)
+      canIssue = false;          // preceding store with unknown address
+
+   else if (uop->getMicroOp()->isStore() && (!head_of_queue || !store_queue.hasFreeSlot(now)))
+      canIssue = false;          // store queue full
+
+   else
+      canIssue = true;           // issue!
+
+
+   // canIssue already marks issue ports as in use, so do this one last
+   if (canIssue && m_rob_contention && ! m_rob_contention->tryIssue(*uop))
+      canIssue = false;          // blocked by structural hazard
+
+   return canIssue;
+}
+
+void RobTimer::accountLongLatencyLoad(RobEntry *entry)
+{
+   DynamicMicroOp *uop = entry->uop;
+
+   // Calculate memory-level parallelism (MLP) for long-latency loads (but ignore overlapped misses)
+   if (uop->getMicroOp()->isLoad() && uop->isLongLatencyLoad() && uop->getDCacheHitWhere() != HitWhere::L1_OWN)
+   {
+      if (m_lastAccountedMemoryCycle < now) m_lastAccountedMemoryCycle = now;
+
+      SubsecondTime done = std::max( now.getElapsedTime(), entry->done );
+      // Ins will be outstanding for until it is done. By account beforehand I don't need to
+      // worry about fast-forwarding simulations
+      m_outstandingLongLatencyInsns += (done - now);
+
+      // Only account for the cycles that have not yet been accounted for by other long
+      // latency misses (don't account cycles twice).
+      if ( done > m_lastAccountedMemoryCycle )
+      {
+         m_outstandingLongLatencyCycles += done - m_lastAccountedMemoryCycle;
+         m_lastAccountedMemoryCycle = done;
+      }
+
+      #ifdef ASSERT_SKIP
+      LOG_ASSERT_ERROR( m_outstandingLongLatencyInsns >= m_outstandingLongLatencyCycles, "MLP calculation is wrong: MLP cannot be < 1!"  );
+      #endif
+   }
+}
+
 SubsecondTime RobTimer::doIssue()
 {
    uint64_t num_issued = 0;
@@ -718,94 +834,154 @@ SubsecondTime RobTimer::doIssue()
       next_event = std::min(next_event, entry->ready);
 
 
-      // See if we can issue this instruction
-
-      bool canIssue = false;
+      bool stop = false;
+      bool canIssue = canIssueEntry(entry, num_issued, head_of_queue, have_unresolved_store, no_more_load, no_more_store, stop);
+      if (stop)
+         break;
 
-      if (entry->ready > now)
-         canIssue = false;          // blocked by dependency
 
-      else if ((no_more_load && uop->getMicroOp()->isLoad()) || (no_more_store && uop->getMicroOp()->isStore()))
-         canIssue = false;          // blocked by mfence
+      if (canIssue)
+      {
+         num_issued++;
+         issueInstruction(i, next_event);
+         accountLongLatencyLoad(entry);
 
-      else if (uop->getMicroOp()->isSerializing())
+         #ifdef ASSERT_SKIP
+            LOG_ASSERT_ERROR(will_skip == false, "Cycle would have been skipped but stuff happened");
+         #endif
+      }
+      else
       {
-         if (head_of_queue && last_store_done <= now)
-            canIssue = true;
-         else
+         head_of_queue = false;     // Subsequent instructions are not at the head of the ROB
+
+         if (uop->getMicroOp()->isStore() && entry->addressReady > now)
+            have_unresolved_store = true;
+
+         if (inorder)
+            // In-order: only issue from head of the ROB
             break;
       }
 
-      else if (uop->getMicroOp()->isMemBarrier())
+
+      if (m_rob_contention)
       {
-         if (head_of_queue && last_store_done <= now)
-            canIssue = true;
-         else
-            // Don't issue any memory operations following a memory barrier
-            no_more_load = no_more_store = true;
-            // FIXME: L/SFENCE
+         if (m_rob_contention->noMore())
+            break;
+      }
+      else
+      {
+         if (num_issued == dispatchWidth)
+            break;
       }
+   }
+
+   return next_event;
+}
 
-      else if (!m_rob_contention && num_issued == dispatchWidth)
-         canIssue = false;          // no issue contention: issue width == dispatch width
+bool RobTimer::isDispatched(UInt64 sequenceNumber) const
+{
+   return rob.size() && sequenceNumber < rob.front().uop->getSequenceNumber() + m_num_in_rob;
+}
 
-      else if (uop->getMicroOp()->isLoad() && !load_queue.hasFreeSlot(now))
-         canIssue = false;          // load queue full
+void RobTimer::scheduleEntry(RobEntry *entry)
+{
+   UInt64 sequenceNumber = entry->uop->getSequenceNumber();
+   if (entry->ready <= now)
+   {
+      // Keep the ready list in program order, this can be in the middle of doIssueWakeup() (zero-latency producer)
+      // but since dependants are always younger than their producer they will still be visited this cycle
+      m_ready_list.insert(std::lower_bound(m_ready_list.begin(), m_ready_list.end(), sequenceNumber), sequenceNumber);
+   }
+   else
+      m_wakeup_heap.push(TimedSeqNr(entry->ready, sequenceNumber));
+}
 
-      else if (uop->getMicroOp()->isLoad() && m_no_address_disambiguation && have_unresolved_store)
-         canIssue = false;          // preceding store with unknown address
+bool RobTimer::haveUnresolvedStoreBefore(UInt64 sequenceNumber) const
+{
+   for(std::deque<UInt64>::const_iterator it = m_pending_stores.begin(); it != m_pending_stores.end() && *it < sequenceNumber; ++it)
+   {
+      if (rob.at(*it - rob.front().uop->getSequenceNumber()).addressReady > now)
+         return true;
+   }
+   return false;
+}
 
-      else if (uop->getMicroOp()->isStore() && (!head_of_queue || !store_queue.hasFreeSlot(now)))
-         canIssue = false;          // store queue full
+SubsecondTime RobTimer::getEarliestDone()
+{
+   UInt64 first = rob.size() ? rob.front().uop->getSequenceNumber() : nextSequenceNumber;
+   while (!m_done_heap.empty() && m_done_heap.top().second < first)
+      m_done_heap.pop();
+   return m_done_heap.empty() ? SubsecondTime::MaxTime() : m_done_heap.top().first;
+}
 
-      else
-         canIssue = true;           // issue!
+SubsecondTime RobTimer::doIssueWakeup()
+{
+   // Issue the same uops, in the same order, as doIssue() would, but only visit the ones that are ready.
+   // Uops that doIssue() would skip over can only end the in-order issue group, clear head_of_queue,
+   // or set have_unresolved_store; the oldest not-yet-issued uop and the list of pending stores
+   // tell us when that would have happened.
+   uint64_t num_issued = 0;
+   SubsecondTime next_event = SubsecondTime::MaxTime();
+   bool no_more_load = false, no_more_store = false, visited_ready = false;
+
+   if (m_rob_contention)
+      m_rob_contention->initCycle(now);
+
+   while (!m_wakeup_heap.empty() && m_wakeup_heap.top().first <= now)
+   {
+      m_ready_list.insert(std::lower_bound(m_ready_list.begin(), m_ready_list.end(), m_wakeup_heap.top().second), m_wakeup_heap.top().second);
+      m_wakeup_heap.pop();
+   }
+
+   for(size_t i = 0; i < m_ready_list.size(); )
+   {
+      RobEntry *entry = this->findEntryBySequenceNumber(m_ready_list[i]);
+      DynamicMicroOp *uop = entry->uop;
+      bool head_of_queue = uop->getSequenceNumber() == m_oldest_not_done;
 
+      if (inorder && !head_of_queue)
+         break;                     // An older uop is blocked
 
-      // canIssue already marks issue ports as in use, so do this one last
-      if (canIssue && m_rob_contention && ! m_rob_contention->tryIssue(*uop))
-         canIssue = false;          // blocked by structural hazard
+      visited_ready = true;
+      next_event = std::min(next_event, entry->ready);
+
+      bool have_unresolved_store = m_no_address_disambiguation && uop->getMicroOp()->isLoad()
+                                 && haveUnresolvedStoreBefore(uop->getSequenceNumber());
 
+      bool stop = false;
+      bool canIssue = canIssueEntry(entry, num_issued, head_of_queue, have_unresolved_store, no_more_load, no_more_store, stop);
+      if (stop)
+         break;
 
       if (canIssue)
       {
          num_issued++;
-         issueInstruction(i, next_event);
+         issueInstruction(uop->getSequenceNumber() - rob.front().uop->getSequenceNumber(), next_event);
+         accountLongLatencyLoad(entry);
 
-         // Calculate memory-level parallelism (MLP) for long-latency loads (but ignore overlapped misses)
-         if (uop->getMicroOp()->isLoad() && uop->isLongLatencyLoad() && uop->getDCacheHitWhere() != HitWhere::L1_OWN)
+         if (uop->getMicroOp()->isStore())
          {
-            if (m_lastAccountedMemoryCycle < now) m_lastAccountedMemoryCycle = now;
-
-            SubsecondTime done = std::max( now.getElapsedTime(), entry->done );
-            // Ins will be outstanding for until it is done. By account beforehand I don't need to
-            // worry about fast-forwarding simulations
-            m_outstandingLongLatencyInsns += (done - now);
+            LOG_ASSERT_ERROR(m_pending_stores.front() == uop->getSequenceNumber(), "Stores are expected to issue in order");
+            m_pending_stores.pop_front();
+         }
 
-            // Only account for the cycles that have not yet been accounted for by other long
-            // latency misses (don't account cycles twice).
-            if ( done > m_lastAccountedMemoryCycle )
-            {
-               m_outstandingLongLatencyCycles += done - m_lastAccountedMemoryCycle;
-               m_lastAccountedMemoryCycle = done;
-            }
+         m_ready_list.erase(m_ready_list.begin() + i);
 
-            #ifdef ASSERT_SKIP
-            LOG_ASSERT_ERROR( m_outstandingLongLatencyInsns >= m_outstandingLongLatencyCycles, "MLP calculation is wrong: MLP cannot be < 1!"  );
-            #endif
+         if (head_of_queue)
+         {
+            // Skip over uops that were issued out-of-order before
+            ++m_oldest_not_done;
+            while (m_oldest_not_done < nextSequenceNumber && this->findEntryBySequenceNumber(m_oldest_not_done)->done != SubsecondTime::MaxTime())
+               ++m_oldest_not_done;
          }
 
-
          #ifdef ASSERT_SKIP
             LOG_ASSERT_ERROR(will_skip == false, "Cycle would have been skipped but stuff happened");
          #endif
       }
       else
       {
-         head_of_queue = false;     // Subsequent instructions are not at the head of the ROB
-
-         if (uop->getMicroOp()->isStore() && entry->addressReady > now)
-            have_unresolved_store = true;
+         ++i;
 
          if (inorder)
             // In-order: only issue from head of the ROB
@@ -825,6 +1001,20 @@ SubsecondTime RobTimer::doIssue()
       }
    }
 
+   if (visited_ready)
+      // doIssue() would have seen a ready time of at most now, there is no need to look any further
+      return next_event;
+
+   // Nothing was ready: doIssue() would have walked all of the ROB (or, in-order, up to the oldest uop not yet issued)
+   next_event = getEarliestDone();
+   if (inorder)
+   {
+      if (isDispatched(m_oldest_not_done))
+         next_event = std::min(next_event, this->findEntryBySequenceNumber(m_oldest_not_done)->ready);
+   }
+   else if (!m_wakeup_heap.empty())
+      next_event = std::min(next_event, m_wakeup_heap.top().first);
+
    return next_event;
 }
 
@@ -865,6 +1055,9 @@ SubsecondTime RobTimer::doCommit(uint64_t& instructionsExecuted)
          break;
    }
 
+   if (m_wakeup_scheduler)
+      getEarliestDone(); // Also drops committed uops from the done heap so it doesn't keep growing
+
    if (rob.size())
       return rob.front().done;
    else
@@ -898,7 +1091,7 @@ void RobTimer::execute(uint64_t& instructionsExecuted, SubsecondTime& latency)
    // Decode stage is not modeled, assumes the decoders can keep up with (up to) dispatchWidth uops per cycle
 
    SubsecondTime next_dispatch = doDispatch(&cpiComponent);
-   SubsecondTime next_issue    = doIssue();
+   SubsecondTime next_issue    = m_wakeup_scheduler ? doIssueWakeup() : doIssue();
    SubsecondTime next_commit   = doCommit(instructionsExecuted);
 
 
@@ -10,6 +10,7 @@
 #include "stats.h"
 
 #include <deque>
+#include <queue>
 
 class RobTimer
 {
@@ -53,6 +54,7 @@ private:
    const bool m_store_to_load_forwarding;
    const bool m_no_address_disambiguation;
    const bool inorder;
+   const bool m_wakeup_scheduler;
 
    Core *m_core;
 
@@ -78,6 +80,18 @@ private:
 
    int addressMask;
 
+   // Event-driven issue scheduler (issue_scheduler = wakeup): instead of walking the whole ROB every cycle,
+   // dispatched uops whose operands are known wait in a wakeup heap until their ready time, after which they
+   // move to a ready list ordered by sequence number. Uops still waiting for a producer are in neither, they
+   // are scheduled by issueInstruction() through their producer's dependants list.
+   typedef std::pair<SubsecondTime, UInt64> TimedSeqNr;
+   typedef std::priority_queue<TimedSeqNr, std::vector<TimedSeqNr>, std::greater<TimedSeqNr> > TimedSeqNrHeap;
+   TimedSeqNrHeap m_wakeup_heap;          // Dispatched, operands known, ready in the future (by ready time)
+   std::vector<UInt64> m_ready_list;      // Dispatched, ready, not yet issued (by sequence number)
+   TimedSeqNrHeap m_done_heap;            // Issued uops by done time, committed ones are removed lazily
+   std::deque<UInt64> m_pending_stores;   // Dispatched stores not yet issued (stores issue in program order)
+   UInt64 m_oldest_not_done;              // Sequence number of the oldest uop that has not yet been issued
+
    UInt64 m_uop_type_count[MicroOp::UOP_SUBTYPE_SIZE];
    UInt64 m_uops_total;
    UInt64 m_uops_x87;
@@ -143,9 +157,17 @@ private:
    void execute(uint64_t& instructionsExecuted, SubsecondTime& latency);
    SubsecondTime doDispatch(SubsecondTime **cpiComponent);
    SubsecondTime doIssue();
+   SubsecondTime doIssueWakeup();
    SubsecondTime doCommit(uint64_t& instructionsExecuted);
 
+   bool canIssueEntry(RobEntry *entry, uint64_t num_issued, bool head_of_queue, bool have_unresolved_store, bool &no_more_load, bool &no_more_store, bool &stop);
    void issueInstruction(uint64_t idx, SubsecondTime &next_event);
+   void accountLongLatencyLoad(RobEntry *entry);
+
+   bool isDispatched(UInt64 sequenceNumber) const;
+   void scheduleEntry(RobEntry *entry);
+   bool haveUnresolvedStoreBefore(UInt64 sequenceNumber) const;
+   SubsecondTime getEarliestDone();
 
 public:
 
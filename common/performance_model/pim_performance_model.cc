@@ -0,0 +1,193 @@
+#include "pim_performance_model.h"
+#include "performance_model.h"
+#include "simulator.h"
+#include "pim_manager.h"
+#include "core.h"
+#include "config.hpp"
+#include "stats.h"
+#include "instruction.h"
+#include "dynamic_instruction.h"
+#include "dvfs_manager.h"
+
+static SubsecondTime getTiming(String name)
+{
+   // Operate in fs for higher precision before converting to uint64_t/SubsecondTime
+   return SubsecondTime::FS() * static_cast<uint64_t>(TimeConverter<float>::NStoFS(Sim()->getCfg()->getFloat("perf_model/pim/" + name)));
+}
+
+PimPerformanceModel*
+PimPerformanceModel::create(Core *core, PerformanceModel *perf)
+{
+   if (Sim()->getCfg()->getBool("perf_model/pim/enabled"))
+      return new PimPerformanceModel(core, perf);
+   else
+      return NULL;
+}
+
+PimPerformanceModel::PimPerformanceModel(Core *core, PerformanceModel *perf)
+   : m_core(core)
+   , m_perf(perf)
+   , m_num_banks(Sim()->getCfg()->getInt("perf_model/pim/num_banks"))
+   , m_row_size(Sim()->getCfg()->getInt("perf_model/pim/row_size"))
+   , m_cache_block_size(Sim()->getCfg()->getInt("perf_model/l1_dcache/cache_block_size"))
+   , m_row_hit_latency(getTiming("row_hit_latency"))
+   , m_row_miss_latency(getTiming("row_miss_latency"))
+   , m_bank_bandwidth(8 * Sim()->getCfg()->getFloat("perf_model/pim/bank_bandwidth")) // Convert bytes to bits
+   , m_entry_cost(getTiming("entry_cost"))
+   , m_exit_cost(getTiming("exit_cost"))
+   , m_flush_cost_per_line(getTiming("flush_cost_per_line"))
+   , m_in_region(false)
+   , m_region(0)
+   , m_instructions(0)
+   , m_total_time(SubsecondTime::Zero())
+{
+   String mode = Sim()->getCfg()->getString("perf_model/pim/mode");
+   if (mode == "offload")
+      m_offload = true;
+   else if (mode == "shadow")
+      m_offload = false;
+   else
+      LOG_PRINT_ERROR("Invalid perf_model/pim/mode %s", mode.c_str());
+
+   m_period = SubsecondTime::FS() * static_cast<uint64_t>(TimeConverter<float>::NStoFS(1. / Sim()->getCfg()->getFloat("perf_model/pim/frequency")));
+   LOG_ASSERT_ERROR(m_num_banks > 0 && m_row_size > 0, "perf_model/pim/num_banks and row_size should be positive");
+
+   Bank bank;
+   bank.open_row = ~UInt64(0);
+   bank.ready = SubsecondTime::Zero();
+   m_banks.resize(m_num_banks, bank);
+
+   registerStatsMetric("pim", core->getId(), "instructions", &m_instructions);
+   registerStatsMetric("pim", core->getId(), "time", &m_total_time);
+}
+
+bool
+PimPerformanceModel::handleInstruction(DynamicInstruction *dynins)
+{
+   if (dynins->instruction->getType() == INST_PIM_REGION)
+   {
+      PimRegionInstruction const* pim_insn = dynamic_cast<PimRegionInstruction const*>(dynins->instruction);
+      LOG_ASSERT_ERROR(pim_insn != NULL, "Expected a PimRegionInstruction, but did not get one.");
+      if (pim_insn->isBegin())
+         regionBegin(pim_insn->getRegion());
+      else
+         regionEnd(pim_insn->getRegion());
+      return true;
+   }
+
+   if (!m_in_region)
+      return false;
+
+   // Dynamic instructions (TLB misses etc.) keep their cost, others take as many cycles as on the host core
+   if (dynins->instruction->isPseudo())
+      m_time += dynins->instruction->getCost(m_core);
+   else if (dynins->isBranch())
+      m_time += m_period;
+   else
+      m_time += m_period * SubsecondTime::divideRounded(dynins->instruction->getCost(m_core), m_core->getDvfsDomain()->getPeriod());
+
+   for(UInt8 idx = 0; idx < dynins->num_memory; ++idx)
+      if (dynins->memory_info[idx].executed)
+         accessMemory(dynins->memory_info[idx].addr, dynins->memory_info[idx].size, dynins->memory_info[idx].dir == Operand::READ);
+
+   ++m_region_instructions;
+
+   if (m_offload)
+   {
+      // The host core is waiting for us
+      if (m_time > m_perf->getElapsedTime())
+         m_perf->incrementElapsedTime(m_time - m_perf->getElapsedTime());
+      return true;
+   }
+   else
+      return false;
+}
+
+void
+PimPerformanceModel::accessMemory(IntPtr address, UInt32 size, bool is_read)
+{
+   UInt64 row_index = address / m_row_size;
+   Bank &bank = m_banks[row_index % m_num_banks];
+   UInt64 row = row_index / m_num_banks;
+
+   SubsecondTime start = std::max(m_time, bank.ready);
+   SubsecondTime transfer = m_bank_bandwidth.getRoundedLatency(8 * size); // bytes to bits
+   if (bank.open_row == row)
+   {
+      // Row hits are pipelined, only limited by the bank's bandwidth
+      bank.ready = start + transfer;
+      if (is_read)
+         m_time = start + m_row_hit_latency + transfer;
+      ++m_region_row_hits;
+   }
+   else
+   {
+      // Opening a new row keeps the bank busy
+      bank.open_row = row;
+      bank.ready = start + m_row_miss_latency - m_row_hit_latency + transfer;
+      if (is_read)
+         m_time = start + m_row_miss_latency + transfer;
+   }
+
+   ++m_region_accesses;
+   m_region_lines.insert(address / m_cache_block_size);
+}
+
+void
+PimPerformanceModel::regionBegin(UInt64 region)
+{
+   if (m_in_region)
+   {
+      LOG_PRINT_WARNING_ONCE("Nested PIM region %" PRIu64 " inside region %" PRIu64 ", ignoring", region, m_region);
+      return;
+   }
+
+   m_in_region = true;
+   m_region = region;
+   m_host_start = m_perf->getElapsedTime();
+   m_time = m_host_start + m_entry_cost;
+   m_region_instructions = 0;
+   m_region_accesses = 0;
+   m_region_row_hits = 0;
+   m_region_lines.clear();
+}
+
+void
+PimPerformanceModel::regionEnd(UInt64 region)
+{
+   if (!m_in_region || region != m_region)
+   {
+      LOG_PRINT_WARNING_ONCE("End of PIM region %" PRIu64 " that was not started, ignoring", region);
+      return;
+   }
+
+   SubsecondTime flush_time = m_exit_cost + m_flush_cost_per_line * m_region_lines.size();
+   m_time += flush_time;
+
+   PimManager::RegionResult result;
+   result.instructions = m_region_instructions;
+   result.accesses = m_region_accesses;
+   result.row_hits = m_region_row_hits;
+   result.lines = m_region_lines.size();
+   result.pim_time = m_time - m_host_start;
+   result.flush_time = m_entry_cost + flush_time;
+
+   if (m_offload)
+   {
+      if (m_time > m_perf->getElapsedTime())
+         m_perf->incrementElapsedTime(m_time - m_perf->getElapsedTime());
+      // Time jumped ahead without the detailed host model knowing about it
+      m_perf->notifyElapsedTimeUpdate();
+      result.host_time = SubsecondTime::Zero();
+   }
+   else
+   {
+      result.host_time = m_perf->getElapsedTime() - m_host_start;
+   }
+
+   m_in_region = false;
+   m_instructions += m_region_instructions;
+   m_total_time += result.pim_time;
+
+   Sim()->getPimManager()->regionDone(m_region, result);
+}
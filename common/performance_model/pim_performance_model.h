@@ -0,0 +1,80 @@
+#ifndef PIM_PERFORMANCE_MODEL_H
+#define PIM_PERFORMANCE_MODEL_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+
+#include <vector>
+#include <unordered_set>
+
+class Core;
+class PerformanceModel;
+class DynamicInstruction;
+class PimRegionInstruction;
+
+// Timing of code regions on a near-memory (processing-in-memory) core (perf_model/pim)
+//
+// Instructions between SimPimRegionBegin and SimPimRegionEnd are executed by a simple in-order core at
+// perf_model/pim/frequency. Its memory accesses do not go through the cache hierarchy but directly to the
+// DRAM banks, which each have their own open row and bank_bandwidth. Reads stall the core, writes are posted.
+// Handing the region to the near-memory core costs entry_cost, and getting back exit_cost plus
+// flush_cost_per_line for every cache line the region touched, as host caches need to write back or
+// invalidate their copies.
+//
+// In offload mode, the host core waits for the near-memory core and its time advances accordingly. In shadow
+// mode, the host core executes the region as usual and the near-memory core runs alongside it, so both times
+// are known and PimManager can report the speedup of offloading each region.
+
+class PimPerformanceModel
+{
+   public:
+      static PimPerformanceModel* create(Core *core, PerformanceModel *perf);
+
+      PimPerformanceModel(Core *core, PerformanceModel *perf);
+
+      // Returns true when the instruction is not to be executed by the host core
+      bool handleInstruction(DynamicInstruction *dynins);
+
+   private:
+      struct Bank
+      {
+         UInt64 open_row;
+         SubsecondTime ready;
+      };
+
+      Core *m_core;
+      PerformanceModel *m_perf;
+
+      bool m_offload;
+      SubsecondTime m_period;
+      const UInt32 m_num_banks;
+      const UInt32 m_row_size;
+      const UInt32 m_cache_block_size;
+      SubsecondTime m_row_hit_latency;
+      SubsecondTime m_row_miss_latency;
+      ComponentBandwidth m_bank_bandwidth;
+      SubsecondTime m_entry_cost;
+      SubsecondTime m_exit_cost;
+      SubsecondTime m_flush_cost_per_line;
+
+      std::vector<Bank> m_banks;
+
+      // Current region
+      bool m_in_region;
+      UInt64 m_region;
+      SubsecondTime m_host_start;
+      SubsecondTime m_time;
+      UInt64 m_region_instructions;
+      UInt64 m_region_accesses;
+      UInt64 m_region_row_hits;
+      std::unordered_set<IntPtr> m_region_lines;
+
+      UInt64 m_instructions;
+      SubsecondTime m_total_time;
+
+      void regionBegin(UInt64 region);
+      void regionEnd(UInt64 region);
+      void accessMemory(IntPtr address, UInt32 size, bool is_read);
+};
+
+#endif // PIM_PERFORMANCE_MODEL_H
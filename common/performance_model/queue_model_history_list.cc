@@ -36,10 +36,9 @@ QueueModelHistoryList::QueueModelHistoryList(String name, UInt32 id, SubsecondTi
    {
       LOG_PRINT_ERROR("Could not read parameters from cfg");
    }
-   m_max_free_interval_list_size = max_list_size;
    m_average_delay = MovingAverage<SubsecondTime>::createAvgType(MovingAverage<SubsecondTime>::ARITHMETIC_MEAN, max_list_size);
    SubsecondTime max_simulation_time = SubsecondTime::FS() << 63;
-   m_free_interval_list.push_back(std::pair<const SubsecondTime,SubsecondTime>(SubsecondTime::Zero(), max_simulation_time));
+   m_free_interval_list = new FreeIntervalList(max_list_size, m_min_processing_time, FreeIntervalList::Interval(SubsecondTime::Zero(), max_simulation_time));
 
    registerStatsMetric(name, id, "num-requests", &m_total_requests);
    registerStatsMetric(name, id, "num-requests-analytical", &m_total_requests_using_analytical_model);
@@ -50,12 +49,13 @@ QueueModelHistoryList::QueueModelHistoryList(String name, UInt32 id, SubsecondTi
 QueueModelHistoryList::~QueueModelHistoryList()
 {
    delete m_average_delay;
+   delete m_free_interval_list;
 }
 
 SubsecondTime
 QueueModelHistoryList::computeQueueDelay(SubsecondTime pkt_time, SubsecondTime processing_time, core_id_t requester)
 {
-   LOG_ASSERT_ERROR(m_free_interval_list.size() >= 1,
+   LOG_ASSERT_ERROR(m_free_interval_list->size() >= 1,
          "Free Interval list size < 1");
 
    SubsecondTime queue_delay;
@@ -63,7 +63,7 @@ QueueModelHistoryList::computeQueueDelay(SubsecondTime pkt_time, SubsecondTime p
    // Check if it is an old packet
    // If yes, use analytical model
    // If not, use the history list based queue model
-   std::pair<SubsecondTime,SubsecondTime> oldest_interval = m_free_interval_list.front();
+   const FreeIntervalList::Interval &oldest_interval = m_free_interval_list->front();
    if (m_analytical_model_enabled && ((pkt_time + processing_time) <= oldest_interval.first))
    {
       // Increment the number of requests that use the analytical model
@@ -88,7 +88,7 @@ QueueModelHistoryList::computeQueueDelay(SubsecondTime pkt_time, SubsecondTime p
 float
 QueueModelHistoryList::getQueueUtilization()
 {
-   std::pair<SubsecondTime,SubsecondTime> newest_interval = m_free_interval_list.back();
+   const FreeIntervalList::Interval &newest_interval = m_free_interval_list->back();
    SubsecondTime total_time = newest_interval.first;
 
    if (total_time == SubsecondTime::Zero())
@@ -140,57 +140,10 @@ QueueModelHistoryList::computeUsingAnalyticalModel(SubsecondTime pkt_time, Subse
 SubsecondTime
 QueueModelHistoryList::computeUsingHistoryList(SubsecondTime pkt_time, SubsecondTime processing_time)
 {
-   LOG_ASSERT_ERROR(m_free_interval_list.size() <= m_max_free_interval_list_size,
-         "Free Interval list size(%u) > %u", m_free_interval_list.size(), m_max_free_interval_list_size);
-   SubsecondTime queue_delay = SubsecondTime::MaxTime();
-
-   FreeIntervalList::iterator curr_it;
-   for (curr_it = m_free_interval_list.begin(); curr_it != m_free_interval_list.end(); curr_it ++)
-   {
-      std::pair<SubsecondTime,SubsecondTime> interval = (*curr_it);
-
-      if ((pkt_time >= interval.first) && ((pkt_time + processing_time) <= interval.second))
-      {
-         queue_delay = SubsecondTime::Zero();
-         // Adjust the data structure accordingly
-         curr_it = m_free_interval_list.erase(curr_it);
-         if ((pkt_time - interval.first) >= m_min_processing_time)
-         {
-            m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first, pkt_time));
-         }
-         if ((interval.second - (pkt_time + processing_time)) >= m_min_processing_time)
-         {
-            m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(pkt_time + processing_time, interval.second));
-         }
-         break;
-      }
-      // WH: The request comes before this free part, but doesn't fit. It doesn't make sense to me to
-      //     demand a fit and move this request down even further. In reality, this request would have most
-      //     likely executed at interval.first, while later request would/could be delayed. But it's too late
-      //     for that now.
-      //     (If we assume all wait times are additive then the average works out by shifting it down,
-      //      but since this is an interactive simulation all delays propagate through the system
-      //      so this won't be accurate.)
-      else if ((pkt_time < interval.first) /*&& ((interval.first + processing_time) <= interval.second)*/)
-      {
-         queue_delay = interval.first - pkt_time;
-         // Adjust the data structure accordingly
-         curr_it = m_free_interval_list.erase(curr_it);
-         if ((interval.second - (interval.first + processing_time)) >= m_min_processing_time)
-         {
-            m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first + processing_time, interval.second));
-         }
-         break;
-      }
-   }
+   SubsecondTime queue_delay = m_free_interval_list->allocate(pkt_time, processing_time);
 
    LOG_ASSERT_ERROR(queue_delay != SubsecondTime::MaxTime(), "queue delay(%s), free interval not found", itostr(queue_delay).c_str());
 
-   if (m_free_interval_list.size() > m_max_free_interval_list_size)
-   {
-      m_free_interval_list.erase(m_free_interval_list.begin());
-   }
-
    LOG_PRINT("HistoryList: pkt_time(%s), processing_time(%s), queue_delay(%s)", itostr(pkt_time).c_str(), itostr(processing_time).c_str(), itostr(queue_delay).c_str());
 
    return queue_delay;
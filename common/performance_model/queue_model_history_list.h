@@ -1,17 +1,14 @@
 #ifndef __QUEUE_MODEL_HISTORY_LIST_H__
 #define __QUEUE_MODEL_HISTORY_LIST_H__
 
-#include <list>
-
 #include "queue_model.h"
 #include "fixed_types.h"
 #include "moving_average.h"
+#include "free_interval_list.h"
 
 class QueueModelHistoryList : public QueueModel
 {
 public:
-   typedef std::list<std::pair<SubsecondTime,SubsecondTime> > FreeIntervalList;
-
    QueueModelHistoryList(String name, UInt32 id, SubsecondTime min_processing_time);
    ~QueueModelHistoryList();
 
@@ -22,9 +19,7 @@ public:
 
 private:
    SubsecondTime m_min_processing_time;
-   UInt32 m_max_free_interval_list_size;
-
-   FreeIntervalList m_free_interval_list;
+   FreeIntervalList *m_free_interval_list;
 
    // Tracks queue utilization
    SubsecondTime m_utilized_time;
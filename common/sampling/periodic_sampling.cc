@@ -5,7 +5,10 @@
 #include "performance_model.h"
 #include "fastforward_performance_model.h"
 #include "config.hpp"
+#include "core.h"
 #include "average.h"
+#include "reuse_profiler.h"
+#include "stats.h"
 
 
 PeriodicSampling::PeriodicSampling(SamplingManager *sampling_manager)
@@ -28,6 +31,16 @@ PeriodicSampling::PeriodicSampling(SamplingManager *sampling_manager)
    , m_periodic_last(SubsecondTime::Zero())
    , m_historic_cpi_intervals(Sim()->getConfig()->getApplicationCores(), NULL)
    , m_dispatch_width(Sim()->getCfg()->getInt("perf_model/core/interval_timer/dispatch_width"))
+   // Whether to size each warmup interval after the memory reuse latencies of the previous detailed interval
+   , m_adaptive_warmup(Sim()->getCfg()->getBool("sampling/periodic/adaptive_warmup"))
+   , m_warmup_coverage(0)
+   , m_min_warmup_interval(SubsecondTime::Zero())
+   , m_max_warmup_interval(SubsecondTime::Zero())
+   , m_current_warmup_interval(m_warmup_interval)
+   , m_adaptive_samples(0)
+   , m_adaptive_warmup_time(SubsecondTime::Zero())
+   , m_sample_reuses(0)
+   , m_sample_unwarmed_reuses(0)
 {
    LOG_ASSERT_ERROR(m_fastforward_sync_interval > SubsecondTime::Zero() && m_fastforward_sync_interval <= std::max(m_fastforward_interval, m_warmup_interval), "fastforward_sync_interval must be between 0 and max(fastforward_interval, warmup_interval)");
 
@@ -60,6 +73,69 @@ PeriodicSampling::PeriodicSampling(SamplingManager *sampling_manager)
 
    if (m_random_start)
       m_random_offset = (m_fastforward_interval + m_warmup_interval) * (m_prng.next() % 100) / 100;
+
+   if (m_adaptive_warmup)
+   {
+      m_warmup_coverage = Sim()->getCfg()->getFloat("sampling/periodic/warmup_coverage");
+      m_min_warmup_interval = SubsecondTime::NS(Sim()->getCfg()->getInt("sampling/periodic/min_warmup_interval"));
+      m_max_warmup_interval = std::min(SubsecondTime::NS(Sim()->getCfg()->getInt("sampling/periodic/max_warmup_interval")),
+                                       m_fastforward_interval + m_warmup_interval);
+      LOG_ASSERT_ERROR(m_warmup_coverage > 0 && m_warmup_coverage <= 1, "sampling/periodic/warmup_coverage must be between 0 and 1");
+      LOG_ASSERT_ERROR(m_min_warmup_interval <= m_max_warmup_interval, "sampling/periodic/min_warmup_interval must not be larger than max_warmup_interval");
+
+      registerStatsMetric("sampling", 0, "adaptive-samples", &m_adaptive_samples);
+      registerStatsMetric("sampling", 0, "adaptive-warmup-time", &m_adaptive_warmup_time);
+   }
+}
+
+PeriodicSampling::~PeriodicSampling()
+{
+   if (m_adaptive_warmup && m_adaptive_samples)
+   {
+      printf("[SNIPER] Adaptive warmup: %" PRIu64 " samples, average warmup %" PRIu64 " ns (warmup_interval %" PRIu64 " ns)",
+         m_adaptive_samples, m_adaptive_warmup_time.getNS() / m_adaptive_samples, m_warmup_interval.getNS());
+      if (m_sample_reuses)
+         printf(", estimated warmup error %.2f%% of reuses", 100. * m_sample_unwarmed_reuses / m_sample_reuses);
+      printf("\n");
+   }
+}
+
+void
+PeriodicSampling::startSample(SubsecondTime time)
+{
+   if (!m_adaptive_warmup)
+      return;
+
+   SubsecondTime warmup_start = time > m_current_warmup_interval ? time - m_current_warmup_interval : SubsecondTime::Zero();
+   for(unsigned int core_id = 0; core_id < Sim()->getConfig()->getApplicationCores(); ++core_id)
+      Sim()->getCoreManager()->getCoreFromID(core_id)->getReuseProfiler()->startSample(warmup_start);
+
+   ++m_adaptive_samples;
+   m_adaptive_warmup_time += m_current_warmup_interval;
+}
+
+SubsecondTime
+PeriodicSampling::endSample()
+{
+   if (!m_adaptive_warmup)
+      return m_warmup_interval;
+
+   UInt64 histogram[ReuseProfiler::NUM_BUCKETS] = { 0 };
+   UInt64 reuses = 0, unwarmed = 0;
+   for(unsigned int core_id = 0; core_id < Sim()->getConfig()->getApplicationCores(); ++core_id)
+      Sim()->getCoreManager()->getCoreFromID(core_id)->getReuseProfiler()->endSample(histogram, reuses, unwarmed);
+
+   m_sample_reuses += reuses;
+   m_sample_unwarmed_reuses += unwarmed;
+
+   // Nothing measured (yet), keep the current warmup
+   if (reuses == 0)
+      return m_current_warmup_interval;
+
+   // Reuses within the detailed interval itself don't need any warmup
+   SubsecondTime latency = ReuseProfiler::getPercentile(histogram, m_warmup_coverage);
+   SubsecondTime warmup = latency > m_detailed_interval ? latency - m_detailed_interval : SubsecondTime::Zero();
+   return std::max(m_min_warmup_interval, std::min(warmup, m_max_warmup_interval));
 }
 
 void
@@ -116,6 +192,8 @@ PeriodicSampling::callbackDetailed(SubsecondTime time)
       }
       //printf("\n");
 
+      SubsecondTime next_warmup_interval = endSample();
+
       if (m_random_placement) {
          // |FFFFFFWWWDFFFFFF|FFFFWWWDFFFFFFFF|
          //            ^^^^^^ ^^^^=new offset
@@ -130,7 +208,14 @@ PeriodicSampling::callbackDetailed(SubsecondTime time)
          m_fastforward_time_remaining = m_fastforward_interval;
       }
 
-      m_warmup_time_remaining = m_warmup_interval;
+      // Keep the sampling period the same, fast-forward for the part of warmup_interval we don't need
+      if (next_warmup_interval != m_warmup_interval)
+      {
+         SubsecondTime remaining = m_fastforward_time_remaining + m_warmup_interval;
+         m_fastforward_time_remaining = remaining > next_warmup_interval ? remaining - next_warmup_interval : SubsecondTime::Zero();
+      }
+      m_current_warmup_interval = next_warmup_interval;
+      m_warmup_time_remaining = m_current_warmup_interval;
       bool done = stepFastForward(time, false);
       LOG_ASSERT_ERROR(done == false, "No fastforwarding to be done");
       m_periodic_last = time;
@@ -184,6 +269,7 @@ PeriodicSampling::callbackFastForward(SubsecondTime time, bool in_warmup)
       m_sampling_manager->resetCoreHistoricCPIs();
       m_sampling_manager->disableFastForward();
       m_periodic_last = time;
+      startSample(time);
       if (m_detailed_warmup_interval > SubsecondTime::Zero())
       {
          m_detailed_warmup_time_remaining = m_detailed_warmup_interval;
@@ -39,10 +39,24 @@ class PeriodicSampling : public SamplingAlgorithm
 
       int m_dispatch_width;
 
+      // Adaptive warmup: the warmup for each detailed interval is derived from the reuse latencies of the previous one
+      bool m_adaptive_warmup;
+      double m_warmup_coverage;
+      SubsecondTime m_min_warmup_interval;
+      SubsecondTime m_max_warmup_interval;
+      SubsecondTime m_current_warmup_interval;
+      UInt64 m_adaptive_samples;
+      SubsecondTime m_adaptive_warmup_time;
+      UInt64 m_sample_reuses;
+      UInt64 m_sample_unwarmed_reuses;
+
       bool stepFastForward(SubsecondTime time, bool in_warmup);
+      void startSample(SubsecondTime time);
+      SubsecondTime endSample();
 
    public:
       PeriodicSampling(SamplingManager *sampling_manager);
+      virtual ~PeriodicSampling();
 
       virtual void callbackDetailed(SubsecondTime now);
       virtual void callbackFastForward(SubsecondTime now, bool in_warmup);
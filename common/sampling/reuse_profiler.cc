@@ -0,0 +1,143 @@
+#include "reuse_profiler.h"
+#include "simulator.h"
+#include "core.h"
+#include "performance_model.h"
+#include "config.hpp"
+#include "stats.h"
+#include "utils.h"
+#include "log.h"
+
+ReuseProfiler*
+ReuseProfiler::create(Core *core)
+{
+   if (isEnabled())
+      return new ReuseProfiler(core);
+   else
+      return NULL;
+}
+
+bool
+ReuseProfiler::isEnabled()
+{
+   static int enabled = -1;
+   if (enabled == -1)
+      enabled = Sim()->getCfg()->getBool("sampling/enabled")
+         && Sim()->getCfg()->getString("sampling/algorithm") == "periodic"
+         && Sim()->getCfg()->getBool("sampling/periodic/adaptive_warmup");
+   return enabled;
+}
+
+SubsecondTime
+ReuseProfiler::getPercentile(const UInt64 *histogram, double fraction)
+{
+   UInt64 total = 0;
+   for(UInt32 bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+      total += histogram[bucket];
+
+   UInt64 covered = 0;
+   for(UInt32 bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+   {
+      covered += histogram[bucket];
+      if (covered >= fraction * total)
+         return SubsecondTime::NS(bucket ? 1ULL << bucket : 0);
+   }
+   return SubsecondTime::NS(1ULL << (NUM_BUCKETS - 1));
+}
+
+ReuseProfiler::ReuseProfiler(Core *core)
+   : m_core(core)
+   , m_log_block_size(floorLog2(Sim()->getCfg()->getInt("perf_model/l1_dcache/cache_block_size")))
+   , m_last_use(Sim()->getCfg()->getInt("sampling/periodic/reuse_sampling"), MAX_REUSE_LINES)
+   , m_in_sample(false)
+   , m_warmup_start(SubsecondTime::Zero())
+   , m_sample_reuses(0)
+   , m_sample_unwarmed(0)
+   , m_accesses(0)
+   , m_reuses(0)
+   , m_samples(0)
+   , m_samples_reuses(0)
+   , m_samples_unwarmed(0)
+{
+   LOG_ASSERT_ERROR(Sim()->getCfg()->getInt("sampling/periodic/reuse_sampling") > 0, "sampling/periodic/reuse_sampling should be positive");
+
+   for(UInt32 bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+      m_sample_histogram[bucket] = 0;
+
+   registerStatsMetric("reuse-profile", core->getId(), "accesses", &m_accesses);
+   registerStatsMetric("reuse-profile", core->getId(), "reuses", &m_reuses);
+   registerStatsMetric("reuse-profile", core->getId(), "samples", &m_samples);
+   registerStatsMetric("reuse-profile", core->getId(), "sample-reuses", &m_samples_reuses);
+   registerStatsMetric("reuse-profile", core->getId(), "sample-unwarmed-reuses", &m_samples_unwarmed);
+}
+
+void
+ReuseProfiler::access(IntPtr address)
+{
+   IntPtr line = address >> m_log_block_size;
+   if (m_last_use.isCandidate(line))
+      record(line);
+}
+
+void
+ReuseProfiler::record(IntPtr line)
+{
+   SubsecondTime now = m_core->getPerformanceModel()->getElapsedTime();
+
+   ScopedLock sl(m_lock);
+
+   SubsecondTime last_use;
+   SampledReuseTracker<SubsecondTime>::result_t result = m_last_use.access(line, now, last_use);
+   if (result == SampledReuseTracker<SubsecondTime>::UNSAMPLED)
+      return;
+
+   ++m_accesses;
+
+   if (result == SampledReuseTracker<SubsecondTime>::REUSE)
+   {
+      ++m_reuses;
+      if (m_in_sample)
+      {
+         SubsecondTime latency = now > last_use ? now - last_use : SubsecondTime::Zero();
+         UInt64 ns = latency.getNS();
+         UInt32 bucket = ns ? std::min(64 - __builtin_clzll(ns), int(NUM_BUCKETS - 1)) : 0;
+         // Weigh by the sampling rate, so cores that had to lower theirs still count in proportion
+         UInt64 weight = m_last_use.getWeight();
+         m_sample_histogram[bucket] += weight;
+         m_sample_reuses += weight;
+         if (last_use < m_warmup_start)
+            m_sample_unwarmed += weight;
+      }
+   }
+}
+
+void
+ReuseProfiler::startSample(SubsecondTime warmup_start)
+{
+   ScopedLock sl(m_lock);
+
+   m_in_sample = true;
+   m_warmup_start = warmup_start;
+   for(UInt32 bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+      m_sample_histogram[bucket] = 0;
+   m_sample_reuses = 0;
+   m_sample_unwarmed = 0;
+}
+
+void
+ReuseProfiler::endSample(UInt64 *histogram, UInt64 &reuses, UInt64 &unwarmed)
+{
+   ScopedLock sl(m_lock);
+
+   if (!m_in_sample)
+      return;
+
+   m_in_sample = false;
+   for(UInt32 bucket = 0; bucket < NUM_BUCKETS; ++bucket)
+      histogram[bucket] += m_sample_histogram[bucket];
+   reuses += m_sample_reuses;
+   unwarmed += m_sample_unwarmed;
+
+   ++m_samples;
+   m_samples_reuses += m_sample_reuses;
+   m_samples_unwarmed += m_sample_unwarmed;
+}
@@ -0,0 +1,64 @@
+#ifndef __REUSE_PROFILER_H
+#define __REUSE_PROFILER_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "lock.h"
+#include "sampled_reuse_tracker.h"
+
+class Core;
+
+// Per-core memory reuse latency profile, for adaptive warmup in sampled simulation (sampling/periodic/adaptive_warmup)
+//
+// Sees the data accesses of its core in every instrumentation mode, including fast-forward, but only follows a subset
+// of the cache lines (one in reuse_sampling, see SampledReuseTracker) so it stays cheap. While a detailed sample is
+// being measured (startSample .. endSample), the time since the previous use of each followed line (its reuse latency)
+// goes into a histogram with power-of-two buckets in nanoseconds.
+// Following MRRL (memory reference reuse latency), the warmup a sample needs is the reuse latency that covers most
+// of its reuses. Reuses whose previous use came before the warmup started could not have been seen by the caches,
+// their fraction estimates the error due to too short a warmup.
+
+class ReuseProfiler
+{
+   public:
+      static const UInt32 NUM_BUCKETS = 48; // Bucket b holds latencies in [2^(b-1), 2^b) ns, bucket 0 holds 0 ns
+
+      static ReuseProfiler* create(Core *core);
+      // Whether profiling is configured, so frontends know to instrument accesses in fast-forward mode
+      static bool isEnabled();
+      // Reuse latency at or below which <fraction> of the reuses in <histogram> fall (rounded up to a bucket boundary)
+      static SubsecondTime getPercentile(const UInt64 *histogram, double fraction);
+
+      ReuseProfiler(Core *core);
+
+      void access(IntPtr address);
+
+      // Measure the reuses of a detailed sample, whose warmup started at <warmup_start>
+      void startSample(SubsecondTime warmup_start);
+      // Stop measuring and add this sample's histogram and counts to the arguments
+      void endSample(UInt64 *histogram, UInt64 &reuses, UInt64 &unwarmed);
+
+   private:
+      static const UInt32 MAX_REUSE_LINES = 262144;
+
+      Core *m_core;
+      const UInt32 m_log_block_size;
+
+      Lock m_lock;
+      SampledReuseTracker<SubsecondTime> m_last_use;
+      bool m_in_sample;
+      SubsecondTime m_warmup_start;
+      UInt64 m_sample_histogram[NUM_BUCKETS];
+      UInt64 m_sample_reuses;
+      UInt64 m_sample_unwarmed;
+
+      UInt64 m_accesses;
+      UInt64 m_reuses;
+      UInt64 m_samples;
+      UInt64 m_samples_reuses;
+      UInt64 m_samples_unwarmed;
+
+      void record(IntPtr line);
+};
+
+#endif // __REUSE_PROFILER_H
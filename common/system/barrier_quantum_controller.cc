@@ -0,0 +1,144 @@
+#include "barrier_quantum_controller.h"
+#include "simulator.h"
+#include "core_manager.h"
+#include "core.h"
+#include "network.h"
+#include "hooks_manager.h"
+#include "clock_skew_minimization_object.h"
+#include "mem_component.h"
+#include "stats.h"
+#include "config.hpp"
+
+BarrierQuantumController *
+BarrierQuantumController::create(void)
+{
+   if (Sim()->getCfg()->getBool("clock_skew_minimization/barrier/adaptive/enabled"))
+      return new BarrierQuantumController();
+   else
+      return NULL;
+}
+
+BarrierQuantumController::BarrierQuantumController()
+   : m_interval(SubsecondTime::NS(Sim()->getCfg()->getInt("clock_skew_minimization/barrier/adaptive/interval")))
+   , m_min_quantum(SubsecondTime::NS(Sim()->getCfg()->getInt("clock_skew_minimization/barrier/adaptive/min_quantum")))
+   , m_max_quantum(SubsecondTime::NS(Sim()->getCfg()->getInt("clock_skew_minimization/barrier/adaptive/max_quantum")))
+   , m_low_rate(Sim()->getCfg()->getFloat("clock_skew_minimization/barrier/adaptive/low_rate"))
+   , m_high_rate(Sim()->getCfg()->getFloat("clock_skew_minimization/barrier/adaptive/high_rate"))
+   , m_quantum(Sim()->getClockSkewMinimizationServer()->getBarrierInterval())
+   , m_last_time(SubsecondTime::Zero())
+   , m_last_interactions(0)
+   , m_interactions(0)
+   , m_num_widened(0)
+   , m_num_narrowed(0)
+   , m_skew_error(SubsecondTime::Zero())
+{
+   LOG_ASSERT_ERROR(m_interval > SubsecondTime::Zero(), "Adaptive barrier interval should be positive");
+   LOG_ASSERT_ERROR(m_min_quantum > SubsecondTime::Zero() && m_min_quantum <= m_max_quantum,
+                    "Invalid adaptive barrier quantum range [%s, %s]", itostr(m_min_quantum).c_str(), itostr(m_max_quantum).c_str());
+   LOG_ASSERT_ERROR(m_low_rate < m_high_rate, "Adaptive barrier low_rate (%f) should be below high_rate (%f)", m_low_rate, m_high_rate);
+
+   // Cache controllers register their coherence counters under the name of their cache object (L1-I, L1-D, L2, ...),
+   // shared caches only on the core that owns them
+   static const char *coherence_metrics[] = { "coherency-invalidates", "coherency-downgrades", "coherency-writebacks" };
+   for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id)
+   {
+      m_networks.push_back(Sim()->getCoreManager()->getCoreFromID(core_id)->getNetwork());
+      for(int component = MemComponent::FIRST_LEVEL_CACHE; component <= MemComponent::L4_CACHE; ++component)
+         for(unsigned int i = 0; i < sizeof(coherence_metrics) / sizeof(coherence_metrics[0]); ++i)
+         {
+            StatsMetricBase *metric = Sim()->getStatsManager()->getMetricObject(getCacheObjectName(MemComponent::component_t(component)), core_id, coherence_metrics[i]);
+            if (metric)
+               m_coherence_metrics.push_back(metric);
+         }
+   }
+   LOG_ASSERT_ERROR(!m_coherence_metrics.empty(), "Adaptive barrier found no cache coherence counters, it requires the parametric cache hierarchy");
+
+   m_quantum = std::min(std::max(m_quantum, m_min_quantum), m_max_quantum);
+   Sim()->getClockSkewMinimizationServer()->setBarrierInterval(m_quantum);
+
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_PERIODIC, BarrierQuantumController::hook_periodic, (UInt64)this);
+
+   registerStatsMetric("barrier", 0, "quantum", &m_quantum);
+   registerStatsMetric("barrier", 0, "interactions", &m_interactions);
+   registerStatsMetric("barrier", 0, "quantum-widened", &m_num_widened);
+   registerStatsMetric("barrier", 0, "quantum-narrowed", &m_num_narrowed);
+   registerStatsMetric("barrier", 0, "skew-error", &m_skew_error);
+}
+
+String
+BarrierQuantumController::getCacheObjectName(MemComponent::component_t component)
+{
+   // Same naming as ParametricDramDirectoryMSI::MemoryManager
+   switch(component)
+   {
+      case MemComponent::L1_ICACHE:
+         return "L1-I";
+      case MemComponent::L1_DCACHE:
+         return "L1-D";
+      default:
+         return "L" + itostr(component - MemComponent::L2_CACHE + 2);
+   }
+}
+
+UInt64
+BarrierQuantumController::countInteractions()
+{
+   UInt64 interactions = 0;
+   for(std::vector<StatsMetricBase*>::iterator it = m_coherence_metrics.begin(); it != m_coherence_metrics.end(); ++it)
+      interactions += (*it)->recordMetric();
+   for(std::vector<Network*>::iterator it = m_networks.begin(); it != m_networks.end(); ++it)
+      interactions += (*it)->getNumRemoteMemoryPackets();
+   return interactions;
+}
+
+UInt32
+BarrierQuantumController::countRunningCores()
+{
+   UInt32 running = 0;
+   for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id)
+      if (Sim()->getCoreManager()->getCoreFromID(core_id)->getState() == Core::RUNNING)
+         ++running;
+   return running;
+}
+
+void
+BarrierQuantumController::periodic(SubsecondTime time)
+{
+   if (time < m_last_time + m_interval)
+      return;
+
+   // Counters may be reset or jump (e.g. when changing between warmup and detailed), don't react to that
+   UInt64 interactions = countInteractions();
+   UInt64 delta = interactions >= m_last_interactions ? interactions - m_last_interactions : 0;
+   SubsecondTime elapsed = time - m_last_time;
+   m_last_interactions = interactions;
+   m_last_time = time;
+
+   // Only adapt while cores are being simulated in detail, during fast-forward the quantum is not used anyway
+   UInt32 running = countRunningCores();
+   if (running == 0 || Sim()->getInstrumentationMode() != InstMode::DETAILED)
+      return;
+
+   m_interactions += delta;
+   m_skew_error += m_quantum * delta / 2;
+
+   double rate = delta * 1000. / (running * elapsed.getNS());
+   SubsecondTime quantum = m_quantum;
+   if (rate < m_low_rate && m_quantum < m_max_quantum)
+   {
+      quantum = std::min(m_quantum * 2, m_max_quantum);
+      ++m_num_widened;
+   }
+   else if (rate > m_high_rate && m_quantum > m_min_quantum)
+   {
+      quantum = std::max(m_quantum / 2, m_min_quantum);
+      ++m_num_narrowed;
+   }
+
+   if (quantum != m_quantum)
+   {
+      LOG_PRINT("Barrier quantum %s -> %s (%.2f interactions per core per us)", itostr(m_quantum).c_str(), itostr(quantum).c_str(), rate);
+      m_quantum = quantum;
+      Sim()->getClockSkewMinimizationServer()->setBarrierInterval(m_quantum);
+   }
+}
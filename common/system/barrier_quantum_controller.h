@@ -0,0 +1,59 @@
+#ifndef __BARRIER_QUANTUM_CONTROLLER_H
+#define __BARRIER_QUANTUM_CONTROLLER_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "mem_component.h"
+
+#include <vector>
+
+class StatsMetricBase;
+class Network;
+
+// Adapts the barrier quantum to how much the cores interact (clock_skew_minimization/barrier/adaptive).
+//
+// Every interval of simulated time, the number of cross-core interactions is measured: coherence
+// actions (invalidations, downgrades and writebacks in all cache controllers) plus memory network
+// packets sent to another core (which carry accesses to shared NUCA/DRAM queues and directories).
+// When the rate per running core is below low_rate, the quantum is doubled (up to max_quantum), when it
+// is above high_rate, the quantum is halved (down to min_quantum).
+//
+// Any interaction can be off by up to one quantum, on average half of it. The skew-error statistic
+// accumulates this (interactions times half the quantum) as an estimate of the timing error incurred.
+
+class BarrierQuantumController
+{
+   public:
+      static BarrierQuantumController* create();
+
+      BarrierQuantumController();
+
+   private:
+      const SubsecondTime m_interval;
+      const SubsecondTime m_min_quantum;
+      const SubsecondTime m_max_quantum;
+      const double m_low_rate;            // Interactions per running core per microsecond
+      const double m_high_rate;
+
+      std::vector<StatsMetricBase*> m_coherence_metrics;
+      std::vector<Network*> m_networks;
+
+      SubsecondTime m_quantum;
+      SubsecondTime m_last_time;
+      UInt64 m_last_interactions;
+
+      UInt64 m_interactions;
+      UInt64 m_num_widened;
+      UInt64 m_num_narrowed;
+      SubsecondTime m_skew_error;
+
+      static SInt64 hook_periodic(UInt64 self, UInt64 time) { ((BarrierQuantumController*)self)->periodic(*(subsecond_time_t*)&time); return 0; }
+
+      static String getCacheObjectName(MemComponent::component_t component);
+
+      void periodic(SubsecondTime time);
+      UInt64 countInteractions();
+      UInt32 countRunningCores();
+};
+
+#endif // __BARRIER_QUANTUM_CONTROLLER_H
@@ -0,0 +1,452 @@
+#include "fast_barrier_sync_server.h"
+#include "simulator.h"
+#include "core_manager.h"
+#include "core.h"
+#include "thread.h"
+#include "thread_manager.h"
+#include "performance_model.h"
+#include "hooks_manager.h"
+#include "syscall_server.h"
+#include "config.h"
+#include "log.h"
+#include "stats.h"
+#include "config.hpp"
+#include "circular_log.h"
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+FastBarrierSyncServer::FastBarrierSyncServer()
+   : m_core_group(Sim()->getConfig()->getApplicationCores(), INVALID_CORE_ID)
+   , m_num_arrived(0)
+   , m_num_expected(0)
+   , m_global_time(SubsecondTime::Zero())
+   , m_fastforward(false)
+   , m_disable(false)
+{
+   try
+   {
+      m_barrier_interval = SubsecondTime::NS() * (UInt64) Sim()->getCfg()->getInt("clock_skew_minimization/barrier/quantum");
+      m_spin_count = Sim()->getCfg()->getInt("clock_skew_minimization/barrier_fast/spin_count");
+   }
+   catch(...)
+   {
+      LOG_PRINT_ERROR("Error Reading 'clock_skew_minimization/barrier' parameters from the config file");
+   }
+
+   // Spinning only pays off when every simulated core can have its own host core,
+   // otherwise waiting threads would take host time away from the ones still simulating
+   if (Sim()->getConfig()->getApplicationCores() > Sim()->getConfig()->getNumHostCores())
+      m_spin_count = 0;
+
+   UInt32 slots_size = Sim()->getConfig()->getApplicationCores() * sizeof(Slot);
+   __attribute__((unused)) int rc = posix_memalign((void**)&m_slots, 64, slots_size); // Align by cache line size to prevent thread contention
+   LOG_ASSERT_ERROR (rc == 0, "posix_memalign failed to allocate memory");
+   for(core_id_t core_id = 0; core_id < (core_id_t)Sim()->getConfig()->getApplicationCores(); ++core_id)
+   {
+      m_slots[core_id].waiting = 0;
+      m_slots[core_id].sleeping = 0;
+      m_slots[core_id].time = SubsecondTime::Zero();
+      m_slots[core_id].thread = INVALID_THREAD_ID;
+   }
+
+   m_next_barrier_time = m_barrier_interval;
+
+   // Order our hooks to occur after possible reschedulings (which are done with ORDER_ACTION)
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_EXIT, FastBarrierSyncServer::hookThreadExit, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_STALL, FastBarrierSyncServer::hookThreadStall, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_MIGRATE, FastBarrierSyncServer::hookThreadMigrate, (UInt64)this, HooksManager::ORDER_NOTIFY_POST);
+
+   registerStatsMetric("barrier", 0, "global_time", &m_global_time);
+}
+
+FastBarrierSyncServer::~FastBarrierSyncServer()
+{
+   free(m_slots);
+}
+
+core_id_t
+FastBarrierSyncServer::getMasterCore(core_id_t core_id, bool fastforward) const
+{
+   if (fastforward)
+      return core_id;  // In fast-forward, the SMT performance model in not active so every core (HW context) calls into the barrier
+   else
+      return m_core_group[core_id] == INVALID_CORE_ID ? core_id : m_core_group[core_id];
+}
+
+void
+FastBarrierSyncServer::synchronize(core_id_t core_id, SubsecondTime time)
+{
+   if (m_disable)
+      return;
+
+   // Everything read here without the lock is checked again after entering the barrier:
+   // if it changed in the meantime, arriveLocked() sorts it out
+   bool fastforward = m_fastforward;
+   if (time < m_next_barrier_time && !fastforward)
+   {
+      CLOG("barrier", "Core %d immediate exit", core_id);
+      return;
+   }
+
+   Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
+   core_id_t master_core_id = getMasterCore(core_id, fastforward);
+   Slot &slot = m_slots[master_core_id];
+   thread_id_t thread_me = core->getThread()->getId();
+
+   CLOG("barrier", "Core %d entry (master core %d, thread %d, ffwd %d)", core_id, master_core_id, thread_me, fastforward);
+
+   LOG_ASSERT_ERROR(core->getState() == Core::RUNNING || core->getState() == Core::INITIALIZING, "Core(%i) is not running or initializing at time(%s)", core_id, itostr(time).c_str());
+   LOG_ASSERT_ERROR(slot.waiting == 0, "Core(%i) or its sibling is already in the barrier (this is thread %d, we have thread %d)", master_core_id, thread_me, slot.thread);
+
+   Sim()->getCoreManager()->getCoreFromID(master_core_id)->getPerformanceModel()->barrierEnter();
+
+   slot.time = time;
+   slot.thread = thread_me;
+   slot.waiting = 1;
+   // Full barrier: our slot is visible before we look at the arrival count and barrier time,
+   // pairs with isBarrierReached() and barrierRelease() which update those before scanning the slots
+   SInt64 num_arrived = __sync_add_and_fetch(&m_num_arrived, 1);
+
+   if (num_arrived >= m_num_expected || m_disable || m_fastforward != fastforward || (time < m_next_barrier_time && !fastforward))
+   {
+      ScopedLock sl(Sim()->getThreadManager()->getLock());
+      arriveLocked(master_core_id, time);
+   }
+
+   waitForRelease(slot);
+
+   CLOG("barrier", "Core %d exit (master core %d, thread %d)", core_id, master_core_id, thread_me);
+}
+
+void
+FastBarrierSyncServer::arriveLocked(core_id_t master_core_id, SubsecondTime time)
+{
+   Slot &slot = m_slots[master_core_id];
+
+   // Already released while we were waiting for the lock
+   if (slot.waiting == 0)
+      return;
+
+   // Raced with setDisable() or a barrier update, we shouldn't have entered after all
+   if (m_disable || (time < m_next_barrier_time && !m_fastforward))
+      releaseCore(master_core_id);
+   // Otherwise, we may be the last core to arrive. If so, this releases us as well
+   else if (isBarrierReached())
+      barrierRelease(slot.thread);
+}
+
+void
+FastBarrierSyncServer::waitForRelease(Slot &slot)
+{
+   for(UInt64 i = 0; i < m_spin_count; ++i)
+   {
+      if (slot.waiting == 0)
+         return;
+      __asm__ __volatile__("pause");
+   }
+
+   slot.sleeping = 1;
+   // Either we see the release, or the releasing thread sees that we're going to sleep
+   __sync_synchronize();
+   while (slot.waiting)
+      syscall(SYS_futex, (void*) &slot.waiting, FUTEX_WAIT | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+   slot.sleeping = 0;
+}
+
+void
+FastBarrierSyncServer::releaseCore(core_id_t core_id)
+{
+   // Called with the lock held, but the thread in this slot may not (yet) be sleeping
+   Slot &slot = m_slots[core_id];
+   LOG_ASSERT_ERROR(slot.waiting, "Releasing Core(%d) which is not in the barrier", core_id);
+
+   Sim()->getCoreManager()->getCoreFromID(core_id)->getPerformanceModel()->barrierExit();
+   __sync_sub_and_fetch(&m_num_arrived, 1);
+   __sync_val_compare_and_swap(&slot.waiting, 1, 0);
+   if (slot.sleeping)
+      syscall(SYS_futex, (void*) &slot.waiting, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+}
+
+void
+FastBarrierSyncServer::threadExit(HooksManager::ThreadTime *argument)
+{
+   // Release thread from the barrier
+   releaseThread(argument->thread_id);
+   // Check to see if we were waiting for this thread
+   signal();
+}
+
+void
+FastBarrierSyncServer::threadStall(HooksManager::ThreadStall *argument)
+{
+   // Release thread from the barrier
+   releaseThread(argument->thread_id);
+   // Check to see if we were waiting for this thread
+   signal();
+}
+
+void
+FastBarrierSyncServer::threadMigrate(HooksManager::ThreadMigrate *argument)
+{
+   // Update the migrating thread's time so we'll be sure to release it
+   releaseThread(argument->thread_id);
+   // Migration due to thread stall/exit will generate another event later, we'll do a signal() then
+   // Migration because of pre-emption is done only inside periodic(), we'll return into barrierRelease()
+}
+
+void
+FastBarrierSyncServer::releaseThread(thread_id_t thread_id)
+{
+   for(core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+   {
+      if (m_slots[core_id].waiting && m_slots[core_id].thread == thread_id)
+      {
+         // Make sure thread is released on next barrierRelease()
+         m_slots[core_id].time = SubsecondTime::Zero();
+      }
+   }
+}
+
+void
+FastBarrierSyncServer::signal()
+{
+   if (m_disable)
+      return;
+
+   if (isBarrierReached())
+      barrierRelease(INVALID_THREAD_ID);
+}
+
+bool
+FastBarrierSyncServer::isCoreRunning(core_id_t core_id, bool siblings)
+{
+   Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
+   if (core->getState() == Core::RUNNING)
+   {
+      LOG_ASSERT_ERROR(core->getThread(), "Core (%d) is running but has no thread", core_id);
+      if (Sim()->getThreadManager()->isThreadRunning(core->getThread()->getId()))
+         return true;
+   }
+
+   if (siblings && !m_fastforward)
+   {
+      for (core_id_t sibling_core_id = 0; sibling_core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); sibling_core_id++)
+      {
+         if (m_core_group[sibling_core_id] == core_id)
+         {
+            if (isCoreRunning(sibling_core_id, false))
+               return true;
+         }
+      }
+   }
+
+   return false;
+}
+
+void
+FastBarrierSyncServer::advance()
+{
+   barrierRelease(INVALID_THREAD_ID, true);
+}
+
+void
+FastBarrierSyncServer::updateNumExpected(std::vector<bool> &participating)
+{
+   // Called with the ThreadManager lock held
+   participating.assign(Sim()->getConfig()->getApplicationCores(), false);
+   SInt64 num_expected = 0;
+   for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+   {
+      // In detailed mode, only consider group masters
+      if ((m_fastforward || m_core_group[core_id] == INVALID_CORE_ID) && isCoreRunning(core_id))
+      {
+         participating[core_id] = true;
+         ++num_expected;
+      }
+   }
+   m_num_expected = num_expected;
+   __sync_synchronize();
+}
+
+bool
+FastBarrierSyncServer::isBarrierReached()
+{
+   // First update the number of cores we expect in the barrier, so that cores arriving while we scan
+   // their slots either are seen by us, or see the new count and check the barrier themselves
+   std::vector<bool> participating;
+   updateNumExpected(participating);
+
+   bool single_core_barrier_reached = false;
+
+   // Check if all cores have reached the barrier
+   // All least one core must have (sync_time > m_next_barrier_time)
+   for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+   {
+      // In fastforward mode, it's enough that a core is waiting. In detailed mode, it needs to have advanced up to the predefined barrier time
+      if (m_fastforward)
+      {
+         if (m_slots[core_id].waiting)
+         {
+            // At least one core has reached the barrier
+            single_core_barrier_reached = true;
+         }
+         else if (participating[core_id])
+         {
+            // Core is running but hasn't checked in yet. Wait for it to sync.
+            return false;
+         }
+      }
+      else if (participating[core_id])
+      {
+         if (!m_slots[core_id].waiting || m_slots[core_id].time < m_next_barrier_time)
+         {
+            // Core running on this core has not reached the barrier
+            // Wait for it to sync
+            return false;
+         }
+         else
+         {
+            // At least one core has reached the barrier
+            single_core_barrier_reached = true;
+         }
+      }
+   }
+
+   return single_core_barrier_reached;
+}
+
+bool
+FastBarrierSyncServer::barrierRelease(thread_id_t caller_id, bool continue_until_release)
+{
+   CLOG("barrier", "Release (caller thread %d)", caller_id);
+
+   if (m_fastforward)
+   {
+      for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+      {
+         // In fast-forward mode, skip over (potentially very many) timeslots
+         if (m_slots[core_id].waiting && m_slots[core_id].time > m_next_barrier_time)
+            m_next_barrier_time = m_slots[core_id].time;
+      }
+   }
+
+   // If a core cannot be resumed, we have to advance the sync
+   // time till a core can be resumed. Then only, will we have
+   // forward progress
+
+   bool core_resumed = false;
+   bool must_wait = true;
+   while (!core_resumed)
+   {
+      m_global_time = m_next_barrier_time;
+      CLOG("barrier", "Barrier %" PRId64 "ns", m_next_barrier_time.getNS());
+      Sim()->getHooksManager()->callHooks(HookType::HOOK_PERIODIC, static_cast<subsecond_time_t>(m_next_barrier_time).m_time);
+
+      if (continue_until_release)
+      {
+         // If HOOK_PERIODIC woke someone up, this thread can safely go to sleep
+         if (Sim()->getThreadManager()->anyThreadRunning())
+            return false;
+         else
+            LOG_ASSERT_ERROR(Sim()->getSyscallServer()->getNextTimeout(m_global_time) < SubsecondTime::MaxTime(), "No threads running, no timeout. Application has deadlocked...");
+      }
+
+      // If the barrier was disabled from HOOK_PERIODIC (for instance, if roi-end was triggered from a script), break
+      if (m_disable)
+         return false;
+
+      m_next_barrier_time += m_barrier_interval;
+      // Cores entering the barrier from now on either see the new barrier time, or are seen by the scan below
+      __sync_synchronize();
+
+      for (core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+      {
+         if (m_slots[core_id].waiting && m_slots[core_id].time < m_next_barrier_time)
+         {
+            core_resumed = true;
+            if (m_slots[core_id].thread == caller_id)
+               must_wait = false;
+            releaseCore(core_id);
+         }
+      }
+   }
+
+   return must_wait;
+}
+
+void
+FastBarrierSyncServer::abortBarrier()
+{
+   CLOG("barrier", "Abort");
+   for(core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+   {
+      // Check if this core was running. If yes, release that core
+      if (m_slots[core_id].waiting)
+         releaseCore(core_id);
+   }
+
+   // Called on a mode change (release()) as well, after which a different set of cores checks in
+   std::vector<bool> participating;
+   updateNumExpected(participating);
+}
+
+void
+FastBarrierSyncServer::setDisable(bool disable)
+{
+   this->m_disable = disable;
+   if (disable)
+   {
+      // Cores entering the barrier from now on either see m_disable, or are released below
+      __sync_synchronize();
+      abortBarrier();
+   }
+}
+
+void
+FastBarrierSyncServer::setGroup(core_id_t core_id, core_id_t master_core_id)
+{
+   if (master_core_id != INVALID_CORE_ID)
+      LOG_ASSERT_ERROR(m_slots[core_id].waiting == 0, "Core(%d) is in the barrier, cannot set participate to false", core_id);
+
+   m_core_group[core_id] = master_core_id;
+}
+
+void
+FastBarrierSyncServer::setFastForward(bool fastforward, SubsecondTime next_barrier_time)
+{
+   if (m_fastforward != fastforward)
+      CLOG("barrier", "FastForward %d > %d", m_fastforward, fastforward);
+   m_fastforward = fastforward;
+   if (next_barrier_time != SubsecondTime::MaxTime())
+   {
+      m_next_barrier_time = std::max(m_next_barrier_time, next_barrier_time);
+   }
+   // Fast-forward has every HW context check in, detailed mode only the SMT group masters
+   std::vector<bool> participating;
+   updateNumExpected(participating);
+}
+
+void
+FastBarrierSyncServer::printState(void)
+{
+   printf("Barrier state:");
+   for(core_id_t core_id = 0; core_id < (core_id_t) Sim()->getConfig()->getApplicationCores(); core_id++)
+   {
+      if (m_core_group[core_id] != INVALID_CORE_ID)
+         printf(" .");
+      else if (m_slots[core_id].waiting)
+      {
+         if (m_slots[core_id].time >= m_next_barrier_time)
+            printf(" ^");
+         else
+            printf(" A");
+      }
+      else if (isCoreRunning(core_id))
+         printf(" R");
+      else
+         printf(" _");
+   }
+   printf("\n");
+}
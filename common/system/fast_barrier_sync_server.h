@@ -0,0 +1,88 @@
+#ifndef __FAST_BARRIER_SYNC_SERVER_H__
+#define __FAST_BARRIER_SYNC_SERVER_H__
+
+#include "fixed_types.h"
+#include "clock_skew_minimization_object.h"
+#include "hooks_manager.h"
+
+#include <vector>
+
+// Barrier synchronization with the same semantics as BarrierSyncServer, but without taking the
+// ThreadManager lock on every quantum (clock_skew_minimization/scheme = barrier_fast).
+//
+// Cores check in by marking their own slot and incrementing a shared arrival counter, then spin
+// (and eventually sleep on a futex) on their slot until a release clears it. Only the core that brings
+// the arrival count up to the number of participating cores takes the lock, to verify that the barrier
+// was reached, call HOOK_PERIODIC and release the waiting cores. The count of participating cores is
+// recomputed under the lock at every such check, by the thread stall/exit/migrate hooks which take
+// the lock anyway, and on every mode change (setFastForward, release), whose callers hold the lock.
+// A count that is too low costs an extra check; it is never left too high, which would miss a release.
+// Unlike BarrierSyncServer, all cores are released at once rather than N host cores at a time.
+
+class FastBarrierSyncServer : public ClockSkewMinimizationServer
+{
+   private:
+      // One cache line per (master) core, written by its own thread when it enters the barrier
+      // and by the releasing thread (with the lock held) when it leaves
+      struct Slot
+      {
+         volatile int waiting;      // In the barrier, also used as futex word
+         volatile int sleeping;     // Blocked in futex wait, needs a wakeup on release
+         SubsecondTime time;
+         thread_id_t thread;
+      } __attribute__((aligned(64)));
+
+      SubsecondTime m_barrier_interval;
+      SubsecondTime m_next_barrier_time;
+      Slot *m_slots;
+      std::vector<core_id_t> m_core_group;
+      volatile SInt64 m_num_arrived;
+      volatile SInt64 m_num_expected;
+      UInt64 m_spin_count;
+      SubsecondTime m_global_time;
+      volatile bool m_fastforward;
+      volatile bool m_disable;
+
+      core_id_t getMasterCore(core_id_t core_id, bool fastforward) const;
+      void arriveLocked(core_id_t master_core_id, SubsecondTime time);
+      void waitForRelease(Slot &slot);
+      void releaseCore(core_id_t core_id);
+      void updateNumExpected(std::vector<bool> &participating);
+      bool isBarrierReached(void);
+      bool barrierRelease(thread_id_t thread_id = INVALID_THREAD_ID, bool continue_until_release = false);
+      void abortBarrier(void);
+      bool isCoreRunning(core_id_t core_id, bool siblings = true);
+      void releaseThread(thread_id_t thread_id);
+      void signal();
+
+      static SInt64 hookThreadExit(UInt64 object, UInt64 argument) {
+         ((FastBarrierSyncServer*)object)->threadExit((HooksManager::ThreadTime*)argument); return 0;
+      }
+      static SInt64 hookThreadStall(UInt64 object, UInt64 argument) {
+         ((FastBarrierSyncServer*)object)->threadStall((HooksManager::ThreadStall*)argument); return 0;
+      }
+      static SInt64 hookThreadMigrate(UInt64 object, UInt64 argument) {
+         ((FastBarrierSyncServer*)object)->threadMigrate((HooksManager::ThreadMigrate*)argument); return 0;
+      }
+      void threadExit(HooksManager::ThreadTime *argument);
+      void threadStall(HooksManager::ThreadStall *argument);
+      void threadMigrate(HooksManager::ThreadMigrate *argument);
+
+   public:
+      FastBarrierSyncServer();
+      ~FastBarrierSyncServer();
+
+      virtual void setDisable(bool disable);
+      virtual void setGroup(core_id_t core_id, core_id_t master_core_id);
+      void synchronize(core_id_t core_id, SubsecondTime time);
+      void release() { abortBarrier(); }
+      void advance();
+      void setFastForward(bool fastforward, SubsecondTime next_barrier_time = SubsecondTime::MaxTime());
+      SubsecondTime getGlobalTime(bool upper_bound = false) { return upper_bound ? m_next_barrier_time : m_global_time; }
+      void setBarrierInterval(SubsecondTime barrier_interval) { m_barrier_interval = barrier_interval; }
+      SubsecondTime getBarrierInterval() const { return m_barrier_interval; }
+
+      void printState(void);
+};
+
+#endif /* __FAST_BARRIER_SYNC_SERVER_H__ */
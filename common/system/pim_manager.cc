@@ -0,0 +1,105 @@
+#include "pim_manager.h"
+#include "simulator.h"
+#include "core_manager.h"
+#include "core.h"
+#include "performance_model.h"
+#include "instruction.h"
+#include "hooks_manager.h"
+#include "magic_server.h"
+#include "stats.h"
+#include "config.hpp"
+#include "sim_api.h"
+
+PimManager *
+PimManager::create(void)
+{
+   if (Sim()->getCfg()->getBool("perf_model/pim/enabled"))
+      return new PimManager();
+   else
+      return NULL;
+}
+
+PimManager::PimManager()
+{
+   Sim()->getHooksManager()->registerHook(HookType::HOOK_MAGIC_MARKER, PimManager::hook_magic_marker, (UInt64)this);
+}
+
+PimManager::~PimManager()
+{
+   for(std::map<UInt64, Region*>::iterator it = m_regions.begin(); it != m_regions.end(); ++it)
+   {
+      Region *region = it->second;
+      if (region->count)
+      {
+         printf("[SNIPER] PIM region %" PRIu64 ": %" PRIu64 " invocations, %" PRIu64 " instructions, near-memory %.1f us",
+            it->first, region->count, region->instructions, region->pim_time.getNS() / 1e3);
+         if (region->host_time > SubsecondTime::Zero())
+            printf(", host %.1f us, speedup %.2fx", region->host_time.getNS() / 1e3, double(region->host_time.getFS()) / region->pim_time.getFS());
+         printf("\n");
+      }
+      delete region;
+   }
+}
+
+PimManager::Region *
+PimManager::getRegion(UInt64 id)
+{
+   ScopedLock sl(m_lock);
+
+   std::map<UInt64, Region*>::iterator it = m_regions.find(id);
+   if (it != m_regions.end())
+      return it->second;
+
+   Region *region = new Region();
+   region->count = 0;
+   region->instructions = 0;
+   region->accesses = 0;
+   region->row_hits = 0;
+   region->lines = 0;
+   region->pim_time = SubsecondTime::Zero();
+   region->host_time = SubsecondTime::Zero();
+   region->flush_time = SubsecondTime::Zero();
+   m_regions[id] = region;
+
+   registerStatsMetric("pim-region", id, "count", &region->count);
+   registerStatsMetric("pim-region", id, "instructions", &region->instructions);
+   registerStatsMetric("pim-region", id, "memory-accesses", &region->accesses);
+   registerStatsMetric("pim-region", id, "row-hits", &region->row_hits);
+   registerStatsMetric("pim-region", id, "flushed-lines", &region->lines);
+   registerStatsMetric("pim-region", id, "pim-time", &region->pim_time);
+   registerStatsMetric("pim-region", id, "host-time", &region->host_time);
+   registerStatsMetric("pim-region", id, "flush-time", &region->flush_time);
+
+   return region;
+}
+
+void
+PimManager::magicMarker(UInt64 arg)
+{
+   MagicServer::MagicMarkerType *marker = (MagicServer::MagicMarkerType *)arg;
+   if (marker->arg0 != SIM_MARKER_PIM_REGION_BEGIN && marker->arg0 != SIM_MARKER_PIM_REGION_END)
+      return;
+
+   // Regions are registered here, while holding the thread manager lock, so their statistics exist before any of them completes
+   getRegion(marker->arg1);
+
+   // Pass the marker to the performance model in order with the instructions around it
+   Core *core = Sim()->getCoreManager()->getCoreFromID(marker->core_id);
+   core->getPerformanceModel()->queuePseudoInstruction(new PimRegionInstruction(marker->arg0 == SIM_MARKER_PIM_REGION_BEGIN, marker->arg1));
+}
+
+void
+PimManager::regionDone(UInt64 id, const RegionResult &result)
+{
+   Region *region = getRegion(id);
+
+   ScopedLock sl(m_lock);
+   ++region->count;
+   region->instructions += result.instructions;
+   region->accesses += result.accesses;
+   region->row_hits += result.row_hits;
+   region->lines += result.lines;
+   region->pim_time += result.pim_time;
+   region->host_time += result.host_time;
+   region->flush_time += result.flush_time;
+}
@@ -0,0 +1,60 @@
+#ifndef __PIM_MANAGER_H
+#define __PIM_MANAGER_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "lock.h"
+
+#include <map>
+
+// Near-memory offload regions (perf_model/pim)
+//
+// Turns the SimPimRegionBegin/End markers into instructions for the performance model of the calling core,
+// which passes the region to its PimPerformanceModel, and keeps statistics for each region (pim-region[id]).
+// At the end of simulation, the near-memory and host time of each region are printed, with the speedup of
+// offloading the region if the host time is known (shadow mode).
+
+class PimManager
+{
+   public:
+      struct RegionResult
+      {
+         UInt64 instructions;
+         UInt64 accesses;
+         UInt64 row_hits;
+         UInt64 lines;
+         SubsecondTime pim_time;
+         SubsecondTime host_time;
+         SubsecondTime flush_time;
+      };
+
+      static PimManager* create();
+
+      PimManager();
+      ~PimManager();
+
+      void regionDone(UInt64 region, const RegionResult &result);
+
+   private:
+      struct Region
+      {
+         UInt64 count;
+         UInt64 instructions;
+         UInt64 accesses;
+         UInt64 row_hits;
+         UInt64 lines;
+         SubsecondTime pim_time;
+         SubsecondTime host_time;
+         SubsecondTime flush_time;
+      };
+
+      Lock m_lock;
+      std::map<UInt64, Region*> m_regions;
+
+      static SInt64 hook_magic_marker(UInt64 self, UInt64 arg) { ((PimManager*)self)->magicMarker(arg); return 0; }
+
+      void magicMarker(UInt64 arg);
+      Region* getRegion(UInt64 region);
+};
+
+#endif // __PIM_MANAGER_H
@@ -8,8 +8,10 @@
 #include "stats.h"
 #include "cache_efficiency_tracker.h"
 #include "utils.h"
+#include "config.hpp"
 
 #include <sstream>
+#include <algorithm>
 
 RoutineTracerFunctionStats::RtnThread::RtnThread(RoutineTracerFunctionStats::RtnMaster *master, Thread *thread)
    : RoutineTracerThread(thread)
@@ -104,7 +106,19 @@ UInt64 RoutineTracerFunctionStats::RtnThread::getCurrentRoutineId()
       return 0;
 }
 
+const char* RoutineTracerFunctionStats::RtnMaster::pim_stat_names[NUM_PIM_STAT_TYPES][2] = {
+   { "pim_accesses", "accesses" },
+   { "pim_llc_misses", "llc-misses" },
+   { "pim_dram_bytes", "dram-bytes" },
+   { "pim_dram_row_hits", "dram-row-hits" },
+   { "pim_reuse_samples", "reuse-samples" },
+   { "pim_reuse_distance", "reuse-distance" },
+   { "pim_miss_latency", "miss-latency" },
+   { "pim_miss_busy_time", "miss-busy-time" },
+};
+
 RoutineTracerFunctionStats::RtnMaster::RtnMaster()
+   : m_pim_candidates(Sim()->getCfg()->getBool("routine_tracer/pim_candidates/enabled"))
 {
    ThreadStatNamedStat::registerStat("fp_addsub", "interval_timer", "uop_fp_addsub");
    ThreadStatNamedStat::registerStat("fp_muldiv", "interval_timer", "uop_fp_muldiv");
@@ -116,6 +130,14 @@ RoutineTracerFunctionStats::RtnMaster::RtnMaster()
    if (ThreadStatNamedStat::registerStat("cpiBranchPredictor", "interval_timer", "cpiBranchPredictor") == ThreadStatsManager::INVALID)
       ThreadStatNamedStat::registerStat("cpiBranchPredictor", "rob_timer", "cpiBranchPredictor");
    ThreadStatCpiMem::registerStat();
+   if (m_pim_candidates)
+   {
+      for(int type = 0; type < NUM_PIM_STAT_TYPES; ++type)
+      {
+         m_pim_stats[type] = ThreadStatNamedStat::registerStat(pim_stat_names[type][0], "pim-profile", pim_stat_names[type][1]);
+         LOG_ASSERT_ERROR(m_pim_stats[type] != ThreadStatsManager::INVALID, "Statistic pim-profile.%s not found", pim_stat_names[type][1]);
+      }
+   }
    Sim()->getConfig()->setCacheEfficiencyCallbacks(__ce_get_owner, NULL, __ce_notify_evict, (UInt64)this);
 }
 
@@ -123,6 +145,8 @@ RoutineTracerFunctionStats::RtnMaster::~RtnMaster()
 {
    writeResults(Sim()->getConfig()->formatOutputFileName("sim.rtntrace").c_str());
    writeResultsFull(Sim()->getConfig()->formatOutputFileName("sim.rtntracefull").c_str());
+   if (m_pim_candidates)
+      writePimCandidates(Sim()->getConfig()->formatOutputFileName("sim.pimcandidates.json").c_str());
 }
 
 UInt64 RoutineTracerFunctionStats::RtnMaster::ce_get_owner(core_id_t core_id, UInt64 address)
@@ -300,6 +324,96 @@ void RoutineTracerFunctionStats::RtnMaster::writeResultsFull(const char *filenam
    fclose(fp);
 }
 
+static String jsonEscape(const char *str)
+{
+   String result;
+   for(const char *c = str; *c; ++c)
+   {
+      if (*c == '"' || *c == '\\')
+         result += '\\';
+      if ((unsigned char)*c >= 0x20)
+         result += *c;
+   }
+   return result;
+}
+
+// Rank routines by the time saved when offloading them to the near-memory core of perf_model/pim.
+// The near-memory estimate uses the flat profile: every instruction takes one near-memory cycle,
+// every data cache line access goes to the banks (at row_hit_latency, or row_miss_latency for host misses
+// that did not find their row open) unless the banks' bandwidth is the limit, and each call pays
+// entry_cost and exit_cost plus flush_cost_per_line for the lines it brought into the host caches.
+void RoutineTracerFunctionStats::RtnMaster::writePimCandidates(const char *filename)
+{
+   const UInt32 cache_block_size = Sim()->getCfg()->getInt("perf_model/l1_dcache/cache_block_size");
+   // Times are in femtoseconds, the configuration uses GHz, nanoseconds and GB/s
+   const double period = 1e6 / Sim()->getCfg()->getFloat("perf_model/pim/frequency");
+   const double row_hit_latency = 1e6 * Sim()->getCfg()->getFloat("perf_model/pim/row_hit_latency");
+   const double row_miss_latency = 1e6 * Sim()->getCfg()->getFloat("perf_model/pim/row_miss_latency");
+   const double call_cost = 1e6 * (Sim()->getCfg()->getFloat("perf_model/pim/entry_cost") + Sim()->getCfg()->getFloat("perf_model/pim/exit_cost"));
+   const double flush_cost_per_line = 1e6 * Sim()->getCfg()->getFloat("perf_model/pim/flush_cost_per_line");
+   const double bandwidth = Sim()->getCfg()->getInt("perf_model/pim/num_banks") * Sim()->getCfg()->getFloat("perf_model/pim/bank_bandwidth") / 1e6;
+
+   struct Candidate
+   {
+      RoutineTracerFunctionStats::Routine *rtn;
+      double host_time, pim_time;
+      bool operator<(const Candidate &other) const { return host_time - pim_time > other.host_time - other.pim_time; }
+   };
+   std::vector<Candidate> candidates;
+
+   for(RoutineMap::iterator it = m_routines.begin(); it != m_routines.end(); ++it)
+   {
+      RtnValues &values = it->second->m_values;
+      UInt64 instructions = values[ThreadStatsManager::INSTRUCTIONS];
+      if (it->second->m_calls == 0 || instructions == 0)
+         continue;
+
+      UInt64 accesses = values[m_pim_stats[PIM_ACCESSES]];
+      UInt64 misses = std::min(values[m_pim_stats[PIM_LLC_MISSES]], accesses);
+      UInt64 row_hits = std::min(values[m_pim_stats[PIM_DRAM_ROW_HITS]], misses);
+
+      double latency = (accesses - misses + row_hits) * row_hit_latency + (misses - row_hits) * row_miss_latency;
+      double transfer = accesses * cache_block_size / bandwidth;
+
+      Candidate candidate;
+      candidate.rtn = it->second;
+      candidate.host_time = values[ThreadStatsManager::ELAPSED_NONIDLE_TIME];
+      candidate.pim_time = instructions * period + std::max(latency, transfer)
+                         + it->second->m_calls * call_cost + misses * flush_cost_per_line;
+      candidates.push_back(candidate);
+   }
+
+   std::sort(candidates.begin(), candidates.end());
+
+   FILE *fp = fopen(filename, "w");
+   fprintf(fp, "[\n");
+   for(UInt32 rank = 0; rank < candidates.size(); ++rank)
+   {
+      RoutineTracerFunctionStats::Routine *rtn = candidates[rank].rtn;
+      RtnValues &values = rtn->m_values;
+      UInt64 instructions = values[ThreadStatsManager::INSTRUCTIONS];
+      UInt64 misses = values[m_pim_stats[PIM_LLC_MISSES]];
+      double row_locality = misses ? values[m_pim_stats[PIM_DRAM_ROW_HITS]] / double(misses) : 0;
+      double reuse_distance = values[m_pim_stats[PIM_REUSE_SAMPLES]] ? values[m_pim_stats[PIM_REUSE_DISTANCE]] / double(values[m_pim_stats[PIM_REUSE_SAMPLES]]) : 0;
+      double mlp = values[m_pim_stats[PIM_MISS_BUSY_TIME]] ? values[m_pim_stats[PIM_MISS_LATENCY]] / double(values[m_pim_stats[PIM_MISS_BUSY_TIME]]) : 0;
+      SubsecondTime host_time = SubsecondTime::FS(UInt64(candidates[rank].host_time));
+      SubsecondTime pim_time = SubsecondTime::FS(UInt64(candidates[rank].pim_time));
+
+      fprintf(fp, "  {\"rank\": %u, \"eip\": \"%" PRIxPTR "\", \"name\": \"%s\", \"source\": \"%s\", \"calls\": %" PRId64 ", \"instructions\": %" PRId64 ", "
+                  "\"llc_mpki\": %.3f, \"dram_bytes\": %" PRId64 ", \"row_buffer_locality\": %.3f, \"reuse_distance\": %.1f, \"mlp\": %.2f, "
+                  "\"host_time_ns\": %.1f, \"pim_time_ns\": %.1f, \"speedup\": %.3f, \"savings_ns\": %.1f}%s\n",
+         rank + 1, rtn->m_eip, jsonEscape(rtn->m_name).c_str(), jsonEscape(rtn->m_location).c_str(), rtn->m_calls, instructions,
+         1000. * misses / instructions, values[m_pim_stats[PIM_DRAM_BYTES]], row_locality, reuse_distance, mlp,
+         candidates[rank].host_time / 1e6, candidates[rank].pim_time / 1e6, candidates[rank].host_time / candidates[rank].pim_time,
+         (candidates[rank].host_time - candidates[rank].pim_time) / 1e6, rank + 1 < candidates.size() ? "," : "");
+
+      Sim()->getStatsManager()->logPimCandidate(rank + 1, rtn->m_eip, rtn->m_name, rtn->m_location, rtn->m_calls, instructions,
+         misses, values[m_pim_stats[PIM_DRAM_BYTES]], row_locality, reuse_distance, mlp, host_time, pim_time);
+   }
+   fprintf(fp, "]\n");
+   fclose(fp);
+}
+
 
 // Helper class to provide global icount/time statistics
 
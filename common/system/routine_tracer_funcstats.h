@@ -54,6 +54,22 @@ class RoutineTracerFunctionStats
             RoutineTracerFunctionStats::Routine* getRoutineFullPtr(const CallStack& stack);
 
          private:
+            // Memory behavior counters from PimProfiler (routine_tracer/pim_candidates)
+            enum PimStatType {
+               PIM_ACCESSES,
+               PIM_LLC_MISSES,
+               PIM_DRAM_BYTES,
+               PIM_DRAM_ROW_HITS,
+               PIM_REUSE_SAMPLES,
+               PIM_REUSE_DISTANCE,
+               PIM_MISS_LATENCY,
+               PIM_MISS_BUSY_TIME,
+               NUM_PIM_STAT_TYPES
+            };
+            static const char* pim_stat_names[NUM_PIM_STAT_TYPES][2];
+            bool m_pim_candidates;
+            ThreadStatsManager::ThreadStatType m_pim_stats[NUM_PIM_STAT_TYPES];
+
             Lock m_lock;
             // Flat-profile per-thread statistics (excludes statistics from child calls).
             typedef std::unordered_map<IntPtr, RoutineTracerFunctionStats::Routine*> RoutineMap;
@@ -72,6 +88,7 @@ class RoutineTracerFunctionStats
 
             void writeResults(const char *filename);
             void writeResultsFull(const char *filename);
+            void writePimCandidates(const char *filename);
       };
 
       class RtnThread : public RoutineTracerThread
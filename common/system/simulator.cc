@@ -9,9 +9,12 @@
 #include "sim_thread_manager.h"
 #include "clock_skew_minimization_object.h"
 #include "fastforward_performance_manager.h"
+#include "barrier_quantum_controller.h"
+#include "pim_manager.h"
 #include "fxsupport.h"
 #include "timer.h"
 #include "stats.h"
+#include "checkpoint.h"
 #include "thread_stats_manager.h"
 #include "pthread_emu.h"
 #include "trace_manager.h"
@@ -108,6 +111,7 @@ Simulator::Simulator()
    , m_log(m_config)
    , m_tags_manager(new TagsManager(m_config_file))
    , m_stats_manager(new StatsManager)
+   , m_checkpoint_manager(NULL)
    , m_transport(NULL)
    , m_core_manager(NULL)
    , m_thread_manager(NULL)
@@ -115,6 +119,8 @@ Simulator::Simulator()
    , m_sim_thread_manager(NULL)
    , m_clock_skew_minimization_manager(NULL)
    , m_fastforward_performance_manager(NULL)
+   , m_barrier_quantum_controller(NULL)
+   , m_pim_manager(NULL)
    , m_trace_manager(NULL)
    , m_dvfs_manager(NULL)
    , m_hooks_manager(NULL)
@@ -135,6 +141,7 @@ void Simulator::start()
    createDecoder();
    
    m_hooks_manager = new HooksManager();
+   m_checkpoint_manager = new CheckpointManager();
    m_syscall_server = new SyscallServer();
    m_sync_server = new SyncServer();
    m_magic_server = new MagicServer();
@@ -148,6 +155,8 @@ void Simulator::start()
    m_sim_thread_manager = new SimThreadManager();
    m_sampling_manager = new SamplingManager();
    m_fastforward_performance_manager = FastForwardPerformanceManager::create();
+   m_barrier_quantum_controller = BarrierQuantumController::create();
+   m_pim_manager = PimManager::create();
    m_rtn_tracer = RoutineTracer::create();
    m_thread_manager = new ThreadManager();
 
@@ -168,6 +177,8 @@ void Simulator::start()
    if (m_trace_manager)
       m_trace_manager->init();
 
+   m_checkpoint_manager->init();
+
    m_sim_thread_manager->spawnSimThreads();
 
    Instruction::initializeStaticInstructionModel();
@@ -230,6 +241,10 @@ Simulator::~Simulator()
    {
       delete m_clock_skew_minimization_server;  m_clock_skew_minimization_server = NULL;
    }
+   if (m_barrier_quantum_controller)
+   {
+      delete m_barrier_quantum_controller;      m_barrier_quantum_controller = NULL;
+   }
 
    m_sim_thread_manager->quitSimThreads();
 
@@ -251,6 +266,12 @@ Simulator::~Simulator()
    //delete m_thread_manager;            m_thread_manager = NULL;
    delete m_thread_stats_manager;      m_thread_stats_manager = NULL;
    delete m_core_manager;              m_core_manager = NULL;
+   // Cores reference the PIM manager until they are gone
+   if (m_pim_manager)
+   {
+      delete m_pim_manager;            m_pim_manager = NULL;
+   }
+   delete m_checkpoint_manager;        m_checkpoint_manager = NULL;
    delete m_dvfs_manager;              m_dvfs_manager = NULL;
    delete m_magic_server;              m_magic_server = NULL;
    delete m_sync_server;               m_sync_server = NULL;
@@ -13,6 +13,7 @@ class SyncServer;
 class MagicServer;
 class ClockSkewMinimizationServer;
 class StatsManager;
+class CheckpointManager;
 class Transport;
 class CoreManager;
 class Thread;
@@ -22,6 +23,8 @@ class SimThreadManager;
 class HooksManager;
 class ClockSkewMinimizationManager;
 class FastForwardPerformanceManager;
+class BarrierQuantumController;
+class PimManager;
 class TraceManager;
 class DvfsManager;
 class SamplingManager;
@@ -53,6 +56,7 @@ public:
    ThreadManager *getThreadManager() { return m_thread_manager; }
    ClockSkewMinimizationManager *getClockSkewMinimizationManager() { return m_clock_skew_minimization_manager; }
    FastForwardPerformanceManager *getFastForwardPerformanceManager() { return m_fastforward_performance_manager; }
+   PimManager *getPimManager() { return m_pim_manager; }
    Config *getConfig() { return &m_config; }
    config::Config *getCfg() {
       //if (! m_config_file_allowed)
@@ -61,6 +65,7 @@ public:
    }
    void hideCfg() { m_config_file_allowed = false; }
    StatsManager *getStatsManager() { return m_stats_manager; }
+   CheckpointManager *getCheckpointManager() { return m_checkpoint_manager; }
    ThreadStatsManager *getThreadStatsManager() { return m_thread_stats_manager; }
    DvfsManager *getDvfsManager() { return m_dvfs_manager; }
    HooksManager *getHooksManager() { return m_hooks_manager; }
@@ -92,6 +97,7 @@ private:
    MagicServer *m_magic_server;
    ClockSkewMinimizationServer *m_clock_skew_minimization_server;
    StatsManager *m_stats_manager;
+   CheckpointManager *m_checkpoint_manager;
    Transport *m_transport;
    CoreManager *m_core_manager;
    ThreadManager *m_thread_manager;
@@ -99,6 +105,8 @@ private:
    SimThreadManager *m_sim_thread_manager;
    ClockSkewMinimizationManager *m_clock_skew_minimization_manager;
    FastForwardPerformanceManager *m_fastforward_performance_manager;
+   BarrierQuantumController *m_barrier_quantum_controller;
+   PimManager *m_pim_manager;
    TraceManager *m_trace_manager;
    DvfsManager *m_dvfs_manager;
    HooksManager *m_hooks_manager;
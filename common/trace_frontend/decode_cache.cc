@@ -0,0 +1,138 @@
+#include "decode_cache.h"
+#include "simulator.h"
+#include "instruction.h"
+#include "micro_op.h"
+#include "stats.h"
+#include "log.h"
+
+DecodeCache::DecodeCache()
+   : m_decoded(new DecodedEntry*[NUM_BUCKETS]())
+   , m_instructions(new InstructionEntry*[NUM_BUCKETS]())
+   , m_factory(new dl::DecoderFactory())
+   , m_decoded_hits(0)
+   , m_decoded_misses(0)
+   , m_instruction_hits(0)
+   , m_instruction_misses(0)
+   , m_bytes_saved(0)
+{
+   registerStatsMetric("decode_cache", 0, "decoded_hits", &m_decoded_hits);
+   registerStatsMetric("decode_cache", 0, "decoded_misses", &m_decoded_misses);
+   registerStatsMetric("decode_cache", 0, "instruction_hits", &m_instruction_hits);
+   registerStatsMetric("decode_cache", 0, "instruction_misses", &m_instruction_misses);
+   registerStatsMetric("decode_cache", 0, "bytes_saved", &m_bytes_saved);
+}
+
+DecodeCache::~DecodeCache()
+{
+   for(UInt64 i = 0; i < NUM_BUCKETS; ++i)
+   {
+      for(DecodedEntry *entry = m_decoded[i]; entry; )
+      {
+         DecodedEntry *next = entry->next;
+         delete entry->dec_inst;
+         delete entry;
+         entry = next;
+      }
+      for(InstructionEntry *entry = m_instructions[i]; entry; )
+      {
+         InstructionEntry *next = entry->next;
+         delete entry;
+         entry = next;
+      }
+   }
+   delete [] m_decoded;
+   delete [] m_instructions;
+   delete m_factory;
+}
+
+UInt64 DecodeCache::hashBytes(const UInt8 *data, UInt8 size)
+{
+   // FNV-1a
+   UInt64 hash = 0xcbf29ce484222325ull;
+   for(UInt8 i = 0; i < size; ++i)
+   {
+      hash ^= data[i];
+      hash *= 0x100000001b3ull;
+   }
+   return hash;
+}
+
+const dl::DecodedInst* DecodeCache::getDecoded(int isa, UInt64 addr, const UInt8 *data, UInt8 size)
+{
+   LOG_ASSERT_ERROR(size <= MAX_INST_SIZE, "Instruction at %lx is %u bytes, at most %u supported", addr, size, MAX_INST_SIZE);
+
+   UInt64 hash = hashBytes(data, size);
+   UInt64 idx = bucket(addr, hash);
+
+   for(DecodedEntry *entry = m_decoded[idx]; entry; entry = entry->next)
+   {
+      if (matches(entry, isa, addr, hash, data, size))
+      {
+         __sync_fetch_and_add(&m_decoded_hits, 1);
+         return entry->dec_inst;
+      }
+   }
+
+   ScopedLock sl(m_lock);
+
+   // Another thread may have inserted it while we were waiting for the lock
+   for(DecodedEntry *entry = m_decoded[idx]; entry; entry = entry->next)
+   {
+      if (matches(entry, isa, addr, hash, data, size))
+      {
+         __sync_fetch_and_add(&m_decoded_hits, 1);
+         return entry->dec_inst;
+      }
+   }
+
+   dl::DecodedInst *dec_inst = m_factory->CreateInstruction(Sim()->getDecoder(), data, size, addr);
+   Sim()->getDecoder()->decode(dec_inst, (dl::dl_isa)isa);
+
+   DecodedEntry *entry = new DecodedEntry();
+   entry->addr = addr;
+   entry->hash = hash;
+   entry->size = size;
+   entry->isa = isa;
+   memcpy(entry->data, data, size);
+   entry->dec_inst = dec_inst;
+   entry->next = m_decoded[idx];
+   // Make sure the entry is complete before lock-free readers can see it
+   __sync_synchronize();
+   m_decoded[idx] = entry;
+
+   __sync_fetch_and_add(&m_decoded_misses, 1);
+   return dec_inst;
+}
+
+Instruction* DecodeCache::findInstruction(const dl::DecodedInst *dec_inst, IntPtr pa, bool is_branch)
+{
+   for(InstructionEntry *entry = m_instructions[bucket((UInt64)dec_inst, pa)]; entry; entry = entry->next)
+   {
+      if (entry->dec_inst == dec_inst && entry->pa == pa && entry->is_branch == is_branch)
+      {
+         __sync_fetch_and_add(&m_instruction_hits, 1);
+         __sync_fetch_and_add(&m_bytes_saved, entry->footprint);
+         return entry->instruction;
+      }
+   }
+   return NULL;
+}
+
+void DecodeCache::insertInstruction(const dl::DecodedInst *dec_inst, IntPtr pa, bool is_branch, Instruction *instruction)
+{
+   UInt64 idx = bucket((UInt64)dec_inst, pa);
+
+   InstructionEntry *entry = new InstructionEntry();
+   entry->dec_inst = dec_inst;
+   entry->pa = pa;
+   entry->is_branch = is_branch;
+   entry->instruction = instruction;
+   // What each additional thread would otherwise have allocated for its own copy
+   entry->footprint = sizeof(*instruction) + instruction->getDisassembly().size()
+                    + (instruction->getMicroOps() ? instruction->getMicroOps()->size() * sizeof(MicroOp) : 0);
+   entry->next = m_instructions[idx];
+   __sync_synchronize();
+   m_instructions[idx] = entry;
+
+   __sync_fetch_and_add(&m_instruction_misses, 1);
+}
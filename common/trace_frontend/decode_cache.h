@@ -0,0 +1,81 @@
+#ifndef __DECODE_CACHE_H
+#define __DECODE_CACHE_H
+
+#include "fixed_types.h"
+#include "lock.h"
+
+#include <decoder.h>
+#include <cstring>
+
+class Instruction;
+
+// Process-wide cache of decoded static instructions, shared by all TraceThreads.
+//
+// Decoded instructions are keyed on (ISA, PC, instruction bytes), so threads and applications
+// running the same binary decode each static instruction only once. Instruction objects (with
+// their micro-ops) also depend on the physical address the PC maps to, so they are additionally
+// keyed on that address and shared between all threads in the same address space.
+//
+// Entries are never removed until the cache is destroyed: lookups walk the hash chains without
+// taking a lock, inserts are serialized through getLock() and publish new entries atomically.
+class DecodeCache
+{
+   private:
+      static const UInt64 NUM_BUCKETS = 1 << 16;
+      static const UInt8 MAX_INST_SIZE = 16; // Same as Sift::StaticInstruction::data
+
+      struct DecodedEntry
+      {
+         UInt64 addr;
+         UInt64 hash;
+         UInt8 size;
+         int isa;
+         UInt8 data[MAX_INST_SIZE];  // Compared on a hash match, a collision must not return another instruction
+         const dl::DecodedInst *dec_inst;
+         DecodedEntry *next;
+      };
+
+      struct InstructionEntry
+      {
+         const dl::DecodedInst *dec_inst;
+         IntPtr pa;
+         bool is_branch;
+         Instruction *instruction;
+         UInt64 footprint;
+         InstructionEntry *next;
+      };
+
+      DecodedEntry * volatile *m_decoded;
+      InstructionEntry * volatile *m_instructions;
+      dl::DecoderFactory *m_factory;
+      Lock m_lock;
+
+      UInt64 m_decoded_hits;
+      UInt64 m_decoded_misses;
+      UInt64 m_instruction_hits;
+      UInt64 m_instruction_misses;
+      UInt64 m_bytes_saved;
+
+      static UInt64 hashBytes(const UInt8 *data, UInt8 size);
+      static bool matches(const DecodedEntry *entry, int isa, UInt64 addr, UInt64 hash, const UInt8 *data, UInt8 size)
+      {
+         return entry->addr == addr && entry->hash == hash && entry->size == size && entry->isa == isa
+            && memcmp(entry->data, data, size) == 0;
+      }
+      static UInt64 bucket(UInt64 a, UInt64 b) { return (a ^ (b * 0x9e3779b97f4a7c15ull)) % NUM_BUCKETS; }
+
+   public:
+      DecodeCache();
+      ~DecodeCache();
+
+      // Return the decoded instruction for these bytes, decoding them if no thread did so before
+      const dl::DecodedInst* getDecoded(int isa, UInt64 addr, const UInt8 *data, UInt8 size);
+
+      // Return the Instruction for dec_inst mapped at physical address pa, or NULL if there is none yet.
+      // To add a missing one, take getLock(), look it up again, and call insertInstruction() if still not found.
+      Instruction* findInstruction(const dl::DecodedInst *dec_inst, IntPtr pa, bool is_branch);
+      void insertInstruction(const dl::DecodedInst *dec_inst, IntPtr pa, bool is_branch, Instruction *instruction);
+      Lock& getLock() { return m_lock; }
+};
+
+#endif // __DECODE_CACHE_H
@@ -1,11 +1,13 @@
 #include "trace_manager.h"
 #include "trace_thread.h"
+#include "decode_cache.h"
 #include "simulator.h"
 #include "thread_manager.h"
 #include "hooks_manager.h"
 #include "config.hpp"
 #include "sim_api.h"
 #include "stats.h"
+#include "sift_pagemap.h"
 
 #include <unistd.h>
 #include <sys/types.h>
@@ -25,6 +27,7 @@ TraceManager::TraceManager()
    , m_app_info(m_num_apps)
    , m_tracefiles(m_num_apps)
    , m_responsefiles(m_num_apps)
+   , m_decode_cache(Sim()->getCfg()->getBool("traceinput/shared_decode_cache") ? new DecodeCache() : NULL)
 {
    setupTraceFiles(0);
 }
@@ -221,6 +224,38 @@ void TraceManager::endApplication(TraceThread *thread, SubsecondTime time)
    }
 }
 
+TraceManager::Va2paStats* TraceManager::registerVa2paStats(thread_id_t thread_id, const Sift::PageMap *page_map)
+{
+   // Called from TraceThread's constructor, with m_lock held by newThread(). Thread ids are never reused.
+   Va2paStats &stats = m_va2pa_stats[thread_id];
+   stats.page_map = page_map;
+   stats.front_hits = stats.table_hits = stats.misses = 0;
+
+   Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("trace", thread_id, "va2pa-front-hits", va2paStatsCallback, (UInt64)&stats));
+   Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("trace", thread_id, "va2pa-table-hits", va2paStatsCallback, (UInt64)&stats));
+   Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("trace", thread_id, "va2pa-misses", va2paStatsCallback, (UInt64)&stats));
+   return &stats;
+}
+
+void TraceManager::unregisterVa2paStats(Va2paStats *stats)
+{
+   stats->front_hits = stats->page_map->getFrontHits();
+   stats->table_hits = stats->page_map->getTableHits();
+   stats->misses = stats->page_map->getMisses();
+   stats->page_map = NULL;
+}
+
+UInt64 TraceManager::va2paStatsCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+{
+   const Va2paStats *stats = (const Va2paStats*)arg;
+   if (metricName == "va2pa-front-hits")
+      return stats->page_map ? stats->page_map->getFrontHits() : stats->front_hits;
+   else if (metricName == "va2pa-table-hits")
+      return stats->page_map ? stats->page_map->getTableHits() : stats->table_hits;
+   else
+      return stats->page_map ? stats->page_map->getMisses() : stats->misses;
+}
+
 void TraceManager::cleanup()
 {
    for(std::vector<TraceThread *>::iterator it = m_threads.begin(); it != m_threads.end(); ++it)
@@ -236,6 +271,8 @@ void TraceManager::cleanup()
 TraceManager::~TraceManager()
 {
    cleanup();
+   if (m_decode_cache)
+      delete m_decode_cache;
 }
 
 void TraceManager::start()
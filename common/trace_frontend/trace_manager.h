@@ -7,11 +7,25 @@
 #include "_thread.h"
 
 #include <vector>
+#include <unordered_map>
 
 class TraceThread;
+class DecodeCache;
+namespace Sift { class PageMap; }
 
 class TraceManager
 {
+   public:
+      // Page translation statistics of one TraceThread. TraceThreads are deleted between traceinput/num_runs iterations,
+      // so the statistics read the thread's page map while it exists, and keep its final counts afterwards.
+      struct Va2paStats
+      {
+         const Sift::PageMap *page_map;
+         UInt64 front_hits;
+         UInt64 table_hits;
+         UInt64 misses;
+      };
+
    private:
       class Monitor : public Runnable
       {
@@ -51,8 +65,12 @@ class TraceManager
       std::vector<String> m_tracefiles;
       std::vector<String> m_responsefiles;
       String m_trace_prefix;
+      DecodeCache *m_decode_cache;
+      std::unordered_map<thread_id_t, Va2paStats> m_va2pa_stats;
       Lock m_lock;
 
+      static UInt64 va2paStatsCallback(String objectName, UInt32 index, String metricName, UInt64 arg);
+
       String getFifoName(app_id_t app_id, UInt64 thread_num, bool response, bool create);
       thread_id_t newThread(app_id_t app_id, bool first, bool init_fifo, bool spawn, SubsecondTime time, thread_id_t creator_thread_id);
 
@@ -78,6 +96,9 @@ class TraceManager
 
       UInt64 getProgressExpect();
       UInt64 getProgressValue();
+      DecodeCache* getDecodeCache() const { return m_decode_cache; }
+      Va2paStats* registerVa2paStats(thread_id_t thread_id, const Sift::PageMap *page_map);
+      void unregisterVa2paStats(Va2paStats *stats);
 };
 
 #endif // __TRACE_MANAGER_H
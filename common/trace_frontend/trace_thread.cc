@@ -1,5 +1,6 @@
 #include "trace_thread.h"
 #include "trace_manager.h"
+#include "decode_cache.h"
 #include "simulator.h"
 #include "core_manager.h"
 #include "thread_manager.h"
@@ -13,12 +14,14 @@
 #include "syscall_model.h"
 #include "core.h"
 #include "magic_client.h"
+#include "magic_server.h"
 #include "branch_predictor.h"
 #include "rng.h"
 #include "routine_tracer.h"
 #include "sim_api.h"
 
 #include "stats.h"
+#include "reuse_profiler.h"
 
 #include <unistd.h>
 #include <sys/syscall.h>
@@ -39,10 +42,12 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
    , m_thread(thread)
    , m_time_start(time_start)
    , m_trace(tracefile.c_str(), responsefile.c_str(), thread->getId())
+   , m_page_map(m_trace.getPageMap())
    , m_trace_has_pa(false)
    , m_address_randomization(Sim()->getCfg()->getBool("traceinput/address_randomization"))
    , m_appid_from_coreid(Sim()->getCfg()->getString("scheduler/type") == "sequential" ? true : false)
    , m_stop(false)
+   , m_decode_cache(Sim()->getTraceManager()->getDecodeCache())
    , m_bbv_base(0)
    , m_bbv_count(0)
    , m_bbv_last(0)
@@ -54,6 +59,12 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
    , m_blocked(false)
    , m_cleanup(cleanup)
    , m_started(false)
+   , m_icount(0)
+   , m_roi_begin_instruction(Sim()->getCfg()->getInt("traceinput/roi_begin_instruction"))
+   , m_stop_instruction(Sim()->getCfg()->getInt("traceinput/stop_instruction"))
+   , m_warmup_batch_size(Sim()->getCfg()->getInt("traceinput/warmup_batch"))
+   , m_warmup_core(NULL)
+   , m_reuse_profiling(ReuseProfiler::isEnabled())
    , m_stopped(false)
 {
 
@@ -66,6 +77,7 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
    //   xed_initialized = true;
    //}
 
+   m_trace.setPrefetch(Sim()->getCfg()->getBool("traceinput/prefetch"));
    m_trace.setHandleInstructionCountFunc(TraceThread::__handleInstructionCountFunc, this);
    m_trace.setHandleCacheOnlyFunc(TraceThread::__handleCacheOnlyFunc, this);
    if (Sim()->getCfg()->getBool("traceinput/mirror_output"))
@@ -95,20 +107,31 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
    }
 
    thread->setVa2paFunc(_va2pa, (UInt64)this);
-   
+
+   if (m_warmup_batch_size > 1)
+      m_warmup_batch.reserve(m_warmup_batch_size);
+   else
+      m_warmup_batch_size = 0;
+
+   m_va2pa_stats = Sim()->getTraceManager()->registerVa2paStats(thread->getId(), &m_page_map);
 }
 
 TraceThread::~TraceThread()
 {
+   Sim()->getTraceManager()->unregisterVa2paStats(m_va2pa_stats);
    delete m__thread;
    if (m_cleanup)
    {
       unlink(m_tracefile.c_str());
       unlink(m_responsefile.c_str());
    }
-   for(std::unordered_map<IntPtr, const dl::DecodedInst *>::iterator i = m_decoder_cache.begin() ; i != m_decoder_cache.end() ; ++i)
+   // Decoded instructions in the shared cache are owned by it
+   if (!m_decode_cache)
    {
-      delete (*i).second;
+      for(std::unordered_map<IntPtr, StaticInst>::iterator i = m_decoder_cache.begin() ; i != m_decoder_cache.end() ; ++i)
+      {
+         delete (*i).second.dec_inst;
+      }
    }
 }
 
@@ -116,7 +139,10 @@ UInt64 TraceThread::va2pa(UInt64 va, bool *noMapping)
 {
    if (m_trace_has_pa)
    {
-      UInt64 pa = m_trace.va2pa(va);
+      // Same as m_trace.va2pa(va), but inlined as this is done several times for each instruction
+      UInt64 pp, pa = 0;
+      if (m_page_map.lookup(va / Sift::PAGE_SIZE_SIFT, pp))
+         pa = (pp * Sift::PAGE_SIZE_SIFT) | (va & (Sift::PAGE_SIZE_SIFT - 1));
       if (pa != 0)
       {
          return pa;
@@ -213,6 +239,9 @@ void TraceThread::handleOutputFunc(uint8_t fd, const uint8_t *data, uint32_t siz
 
 uint64_t TraceThread::handleSyscallFunc(uint16_t syscall_number, const uint8_t *data, uint32_t size)
 {
+   // The system call may block or move us to another core
+   flushWarmup();
+
    // We may have been blocked in a system call, if we start executing instructions again that means we're continuing
    if (m_blocked)
    {
@@ -264,6 +293,8 @@ int32_t TraceThread::handleJoinFunc(int32_t join_thread_id)
 
 uint64_t TraceThread::handleMagicFunc(uint64_t a, uint64_t b, uint64_t c)
 {
+   // Magic instructions can change the simulation mode or write out statistics
+   flushWarmup();
    return handleMagicInstruction(m_thread->getId(), a, b, c);
 }
 
@@ -395,24 +426,41 @@ Instruction* TraceThread::decode(Sift::Instruction &inst)
 {
 
    //printf("PC: %lx Size: %d num_addresses=%d is_branch=%d\n", inst.sinst->addr, inst.sinst->size, inst.num_addresses, inst.is_branch);
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst& dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   const StaticInst &static_inst = getStaticInst(inst);
+   const dl::DecodedInst &dec_inst = *static_inst.dec_inst;
+   IntPtr pa = va2pa(inst.sinst->addr);
 
+   if (m_decode_cache)
+   {
+      // Reuse the Instruction (and its micro-ops) created by another thread in the same address space
+      Instruction *instruction = m_decode_cache->findInstruction(&dec_inst, pa, inst.is_branch);
+      if (instruction)
+         return instruction;
+
+      ScopedLock sl(m_decode_cache->getLock());
+      instruction = m_decode_cache->findInstruction(&dec_inst, pa, inst.is_branch);
+      if (!instruction)
+      {
+         instruction = createInstruction(inst, static_inst, pa);
+         m_decode_cache->insertInstruction(&dec_inst, pa, inst.is_branch, instruction);
+      }
+      return instruction;
+   }
+   else
+      return createInstruction(inst, static_inst, pa);
+}
+
+Instruction* TraceThread::createInstruction(Sift::Instruction &inst, const StaticInst &static_inst, IntPtr pa)
+{
+   const dl::DecodedInst &dec_inst = *static_inst.dec_inst;
    OperandList list;
 
-   // Ignore memory-referencing operands in NOP instructions
-   if (!(dec_inst.is_nop()))
-   {
-      for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
-         if (Sim()->getDecoder()->op_read_mem(&dec_inst, mem_idx))
-            list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
+   // Memory-referencing operands in NOP instructions are not in the masks
+   for(UInt32 mask = static_inst.info.mem_read_mask; mask; mask &= mask - 1)
+      list.push_back(Operand(Operand::MEMORY, 0, Operand::READ));
 
-      for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
-         if (Sim()->getDecoder()->op_write_mem(&dec_inst, mem_idx))
-            list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
-   }
+   for(UInt32 mask = static_inst.info.mem_write_mask; mask; mask &= mask - 1)
+      list.push_back(Operand(Operand::MEMORY, 0, Operand::WRITE));
 
    Instruction *instruction;
    if (inst.is_branch)
@@ -421,9 +469,9 @@ Instruction* TraceThread::decode(Sift::Instruction &inst)
    else
       instruction = new GenericInstruction(list);
 
-   instruction->setAddress(va2pa(inst.sinst->addr));
+   instruction->setAddress(pa);
    instruction->setSize(inst.sinst->size);
-   instruction->setAtomic(dec_inst.is_atomic());
+   instruction->setAtomic(static_inst.info.is_atomic);
    char disassembly[64];
    dec_inst.disassembly_to_str(disassembly, sizeof(disassembly));  
    instruction->setDisassembly(disassembly);
@@ -473,7 +521,8 @@ Sift::Mode TraceThread::handleInstructionCountFunc(uint32_t icount)
    switch(Sim()->getInstrumentationMode())
    {
       case InstMode::FAST_FORWARD:
-         return Sift::ModeIcount;
+         // The reuse profiler needs the data addresses, see handleCacheOnlyFunc
+         return m_reuse_profiling ? Sift::ModeMemory : Sift::ModeIcount;
       case InstMode::CACHE_ONLY:
          return Sift::ModeMemory;
       case InstMode::DETAILED:
@@ -497,6 +546,14 @@ void TraceThread::handleCacheOnlyFunc(uint8_t icount, Sift::CacheOnlyType type,
    if (icount)
       core->countInstructions(0, icount);
 
+   if (Sim()->getInstrumentationMode() == InstMode::FAST_FORWARD)
+   {
+      // Only here for the reuse profiler, fast-forward does not warm up anything
+      if (type == Sift::CacheOnlyMemRead || type == Sift::CacheOnlyMemWrite)
+         core->profileMemory(va2pa(address));
+      return;
+   }
+
    switch(type)
    {
       case Sift::CacheOnlyBranchTaken:
@@ -530,18 +587,30 @@ void TraceThread::handleCacheOnlyFunc(uint8_t icount, Sift::CacheOnlyType type,
 
 const dl::DecodedInst* TraceThread::staticDecode(Sift::Instruction &inst)
 {
+   if (m_decode_cache)
+      return m_decode_cache->getDecoded(inst.isa, inst.sinst->addr, inst.sinst->data, inst.sinst->size);
+
    dl::DecodedInst *dec_inst = m_factory->CreateInstruction(Sim()->getDecoder(), inst.sinst->data, 
                                                             inst.sinst->size, inst.sinst->addr);
    Sim()->getDecoder()->decode(dec_inst, (dl::dl_isa)inst.isa);
    return dec_inst;
 }
 
+const TraceThread::StaticInst& TraceThread::getStaticInst(Sift::Instruction &inst)
+{
+   std::unordered_map<IntPtr, StaticInst>::iterator it = m_decoder_cache.find(inst.sinst->addr);
+   if (it != m_decoder_cache.end())
+      return it->second;
+
+   StaticInst &static_inst = m_decoder_cache[inst.sinst->addr];
+   static_inst.dec_inst = staticDecode(inst);
+   Sim()->getDecoder()->get_info(static_inst.dec_inst, &static_inst.info);
+   return static_inst;
+}
+
 void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size)
 {
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   const dl::DecodedInstInfo &info = getStaticInst(inst).info;
 
    // Warmup instruction caches
 
@@ -563,99 +632,117 @@ void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruc
 
    if (inst.executed)
    {
-      const bool is_atomic_update = dec_inst.is_atomic();
-      const bool is_prefetch = dec_inst.is_prefetch();
+      const bool is_atomic_update = info.is_atomic;
+      const bool is_prefetch = info.is_prefetch;
 
-      // Ignore memory-referencing operands in NOP instructions
-      if (!dec_inst.is_nop())
+      // Memory-referencing operands in NOP instructions are not in the masks
+      for(UInt32 mask = info.mem_read_mask; mask; mask &= mask - 1)
       {
-         for(uint32_t mem_idx = 0; mem_idx <  Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
+         uint32_t mem_idx = __builtin_ctz(mask);
+         UInt64 mem_address;
+         // LDP ARM instructions, second element to be loaded, using the address of the first element
+         if (info.is_mem_pair && ((int)mem_idx == (inst.num_addresses + 1)))
+         {
+            LOG_ASSERT_ERROR((int)mem_idx < (inst.num_addresses + 1), "Did not receive enough data addresses");
+
+            mem_address = inst.addresses[mem_idx - 1] + info.mem_size[mem_idx];
+         }
+         else
          {
-            if (Sim()->getDecoder()->op_read_mem(&dec_inst, mem_idx))
-            {
-               UInt64 mem_address;
-               // LDP ARM instructions, second element to be loaded, using the address of the first element
-               if (dec_inst.is_mem_pair() && ((int)mem_idx == (inst.num_addresses + 1)))  
-               {
-                  LOG_ASSERT_ERROR((int)mem_idx < (inst.num_addresses + 1), "Did not receive enough data addresses");
-                  
-                  mem_address = inst.addresses[mem_idx - 1] + Sim()->getDecoder()->size_mem_op(&dec_inst, mem_idx);
-               }
-               else
-               {
-                  LOG_ASSERT_ERROR(mem_idx < inst.num_addresses, "Did not receive enough data addresses");
-                 
-                  mem_address = inst.addresses[mem_idx];
-               }
-               
-               bool no_mapping = false;
-               UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
-               if (no_mapping)
-                  continue;
-
-               core->accessMemory(
-                     /*(is_atomic_update) ? Core::LOCK :*/ Core::NONE,
-                     (is_atomic_update) ? Core::READ_EX : Core::READ,
-                     pa,
-                     NULL,
-                     Sim()->getDecoder()->size_mem_op(&dec_inst, mem_idx),
-                     Core::MEM_MODELED_COUNT,
-                     va2pa(inst.sinst->addr));
-            }
+            LOG_ASSERT_ERROR(mem_idx < inst.num_addresses, "Did not receive enough data addresses");
+
+            mem_address = inst.addresses[mem_idx];
          }
 
-         for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
+         bool no_mapping = false;
+         UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
+         if (no_mapping)
+            continue;
+
+         if (m_warmup_batch_size)
+            addWarmupAccess(core, pa, info.mem_size[mem_idx], (is_atomic_update) ? Core::READ_EX : Core::READ);
+         else
+            core->accessMemory(
+                  /*(is_atomic_update) ? Core::LOCK :*/ Core::NONE,
+                  (is_atomic_update) ? Core::READ_EX : Core::READ,
+                  pa,
+                  NULL,
+                  info.mem_size[mem_idx],
+                  Core::MEM_MODELED_COUNT,
+                  va2pa(inst.sinst->addr));
+      }
+
+      for(UInt32 mask = info.mem_write_mask; mask; mask &= mask - 1)
+      {
+         uint32_t mem_idx = __builtin_ctz(mask);
+         UInt64 mem_address;
+         // STP ARM instructions, second element to be stored, using the address of the first element
+         if (info.is_mem_pair && ((int)mem_idx == (inst.num_addresses + 1)))
          {
-            if (Sim()->getDecoder()->op_write_mem(&dec_inst, mem_idx))
-            {
-               UInt64 mem_address;
-               // STP ARM instructions, second element to be stored, using the address of the first element
-               if (dec_inst.is_mem_pair() && ((int)mem_idx == (inst.num_addresses + 1)))  
-               {
-                  LOG_ASSERT_ERROR((int)mem_idx < (inst.num_addresses + 1), "Did not receive enough data addresses");
-                  
-                  mem_address = inst.addresses[mem_idx - 1] + Sim()->getDecoder()->size_mem_op(&dec_inst, mem_idx);
-               }
-               else
-               {
-                  LOG_ASSERT_ERROR(mem_idx < inst.num_addresses, "Did not receive enough data addresses");
-                 
-                  mem_address = inst.addresses[mem_idx];
-               }
-               
-               bool no_mapping = false;
-               UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
-               if (no_mapping)
-                  continue;
-
-               if (is_atomic_update)
-                  core->logMemoryHit(false, Core::WRITE, pa, Core::MEM_MODELED_COUNT, va2pa(inst.sinst->addr));
-               else
-                  core->accessMemory(
-                        /*(is_atomic_update) ? Core::UNLOCK :*/ Core::NONE,
-                        Core::WRITE,
-                        pa,
-                        NULL,
-                        Sim()->getDecoder()->size_mem_op(&dec_inst, mem_idx),
-                        Core::MEM_MODELED_COUNT,
-                        va2pa(inst.sinst->addr));
-            }
+            LOG_ASSERT_ERROR((int)mem_idx < (inst.num_addresses + 1), "Did not receive enough data addresses");
+
+            mem_address = inst.addresses[mem_idx - 1] + info.mem_size[mem_idx];
          }
+         else
+         {
+            LOG_ASSERT_ERROR(mem_idx < inst.num_addresses, "Did not receive enough data addresses");
+
+            mem_address = inst.addresses[mem_idx];
+         }
+
+         bool no_mapping = false;
+         UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
+         if (no_mapping)
+            continue;
+
+         if (is_atomic_update)
+            core->logMemoryHit(false, Core::WRITE, pa, Core::MEM_MODELED_COUNT, va2pa(inst.sinst->addr));
+         else if (m_warmup_batch_size)
+            addWarmupAccess(core, pa, info.mem_size[mem_idx], Core::WRITE);
+         else
+            core->accessMemory(
+                  /*(is_atomic_update) ? Core::UNLOCK :*/ Core::NONE,
+                  Core::WRITE,
+                  pa,
+                  NULL,
+                  info.mem_size[mem_idx],
+                  Core::MEM_MODELED_COUNT,
+                  va2pa(inst.sinst->addr));
       }
    }
 }
 
+void TraceThread::addWarmupAccess(Core *core, IntPtr address, UInt32 size, Core::mem_op_t mem_op_type)
+{
+   // Accesses are always done on the core that executed them
+   if (core != m_warmup_core)
+   {
+      flushWarmup();
+      m_warmup_core = core;
+   }
+
+   Core::WarmupAccess access;
+   access.address = address;
+   access.size = size;
+   access.mem_op_type = mem_op_type;
+   m_warmup_batch.push_back(access);
+
+   if (m_warmup_batch.size() >= m_warmup_batch_size)
+      flushWarmup();
+}
+
 void TraceThread::handleInstructionDetailed(Sift::Instruction &inst, Sift::Instruction &next_inst, PerformanceModel *prfmdl)
 {
 
    // Set up instruction
 
-   if (m_icache.count(inst.sinst->addr) == 0)
-      m_icache[inst.sinst->addr] = decode(inst);
-   // Here get the decoder instruction without checking, because we must have it for sure
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   std::unordered_map<IntPtr, Instruction *>::iterator it = m_icache.find(inst.sinst->addr);
+   if (it == m_icache.end())
+      it = m_icache.insert(std::make_pair(inst.sinst->addr, decode(inst))).first;
+   // decode() made sure the static instruction exists
+   const dl::DecodedInstInfo &info = m_decoder_cache.find(inst.sinst->addr)->second.info;
 
-   Instruction *ins = m_icache[inst.sinst->addr];
+   Instruction *ins = it->second;
    DynamicInstruction *dynins = prfmdl->createDynamicInstruction(ins, va2pa(inst.sinst->addr));
 
    // Add dynamic instruction info
@@ -665,26 +752,15 @@ void TraceThread::handleInstructionDetailed(Sift::Instruction &inst, Sift::Instr
       dynins->addBranch(inst.taken, va2pa(next_inst.sinst->addr));
    }
 
-   // Ignore memory-referencing operands in NOP instructions
-   if (!dec_inst.is_nop())
+   // Memory-referencing operands in NOP instructions are not in the masks
+   for(UInt32 mask = info.mem_read_mask; mask; mask &= mask - 1)
    {
-      const bool is_prefetch = dec_inst.is_prefetch();
-
-      for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
-      {
-         if (Sim()->getDecoder()->op_read_mem(&dec_inst, mem_idx))
-         {
-            addDetailedMemoryInfo(dynins, inst, dec_inst, mem_idx, Operand::READ, is_prefetch, prfmdl);
-         }
-      }
+      addDetailedMemoryInfo(dynins, inst, info, __builtin_ctz(mask), Operand::READ, prfmdl);
+   }
 
-      for(uint32_t mem_idx = 0; mem_idx < Sim()->getDecoder()->num_memory_operands(&dec_inst); ++mem_idx)
-      {
-         if (Sim()->getDecoder()->op_write_mem(&dec_inst, mem_idx))
-         {
-            addDetailedMemoryInfo(dynins, inst, dec_inst, mem_idx, Operand::WRITE, is_prefetch, prfmdl);
-         }
-      }
+   for(UInt32 mask = info.mem_write_mask; mask; mask &= mask - 1)
+   {
+      addDetailedMemoryInfo(dynins, inst, info, __builtin_ctz(mask), Operand::WRITE, prfmdl);
    }
 
    // Push instruction
@@ -696,23 +772,23 @@ void TraceThread::handleInstructionDetailed(Sift::Instruction &inst, Sift::Instr
    prfmdl->iterate();
 }
 
-void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const dl::DecodedInst &decoded_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_prefetch, PerformanceModel *prfmdl)
+void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const dl::DecodedInstInfo &info, uint32_t mem_idx, Operand::Direction op_type, PerformanceModel *prfmdl)
 {
    UInt64 mem_address;
    // LDP/STP ARM instructions, second element to be ld/st, using the address of the first element
-   if (decoded_inst.is_mem_pair() && ((int)mem_idx == inst.num_addresses))  
+   if (info.is_mem_pair && ((int)mem_idx == inst.num_addresses))
    {
       assert((int)mem_idx < (inst.num_addresses + 1));
-      mem_address = inst.addresses[mem_idx - 1] + Sim()->getDecoder()->size_mem_op(&decoded_inst, mem_idx);
+      mem_address = inst.addresses[mem_idx - 1] + info.mem_size[mem_idx];
    }
    else
    {
       assert(mem_idx < inst.num_addresses);
       mem_address = inst.addresses[mem_idx];
    }
-               
+
    bool no_mapping = false;
-   UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
+   UInt64 pa = va2pa(mem_address, info.is_prefetch ? &no_mapping : NULL);
 
    if (no_mapping)
    {
@@ -720,7 +796,7 @@ void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instru
          inst.executed,
          SubsecondTime::Zero(),
          0,
-         Sim()->getDecoder()->size_mem_op(&decoded_inst, mem_idx),
+         info.mem_size[mem_idx],
          op_type,
          0,
          HitWhere::PREFETCH_NO_MAPPING);
@@ -731,7 +807,7 @@ void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instru
          inst.executed,
          SubsecondTime::Zero(),
          pa,
-         Sim()->getDecoder()->size_mem_op(&decoded_inst, mem_idx),
+         info.mem_size[mem_idx],
          op_type,
          0,
          HitWhere::UNKNOWN);
@@ -778,6 +854,14 @@ void TraceThread::run()
    m_trace.initStream();
    m_trace_has_pa = m_trace.getTraceHasPhysicalAddresses();
 
+   UInt64 start_instruction = Sim()->getCfg()->getInt("traceinput/start_instruction");
+   if (start_instruction)
+   {
+      bool seeked = m_trace.Seek(start_instruction);
+      LOG_ASSERT_ERROR(seeked, "Cannot start trace %s at instruction %ld", m_tracefile.c_str(), start_instruction);
+      m_icount = start_instruction;
+   }
+
    if (m_thread->getCore() == NULL)
    {
       // We didn't get scheduled on startup, wait here
@@ -797,6 +881,16 @@ void TraceThread::run()
 
    while(have_first && m_trace.Read(next_inst))
    {
+      if (m_stop_instruction && m_icount >= m_stop_instruction)
+         break;
+
+      if (m_roi_begin_instruction && m_icount == m_roi_begin_instruction)
+      {
+         // Warmup is done, switch to detailed simulation (ROI ends automatically when the simulation does)
+         ScopedLock sl(Sim()->getThreadManager()->getLock());
+         Sim()->getMagicServer()->setPerformance(true);
+      }
+
       if (m_blocked)
       {
          unblock();
@@ -834,6 +928,11 @@ void TraceThread::run()
       switch(Sim()->getInstrumentationMode())
       {
          case InstMode::FAST_FORWARD:
+            flushWarmup();
+            // Fast-forward does not model memory, but adaptive sampling warmup wants to know about reuse
+            if (m_reuse_profiling && inst.executed)
+               for(UInt32 idx = 0; idx < inst.num_addresses; ++idx)
+                  core->profileMemory(va2pa(inst.addresses[idx]));
             break;
 
          case InstMode::CACHE_ONLY:
@@ -841,6 +940,7 @@ void TraceThread::run()
             break;
 
          case InstMode::DETAILED:
+            flushWarmup();
             handleInstructionDetailed(inst, next_inst, prfmdl);
             break;
 
@@ -864,8 +964,11 @@ void TraceThread::run()
          break;
 
       inst = next_inst;
+      ++m_icount;
    }
 
+   flushWarmup();
+
    printf("[TRACE:%u] -- %s --\n", m_thread->getId(), m_stop ? "STOP" : "DONE");
 
    SubsecondTime time_end = prfmdl->getElapsedTime();
@@ -6,6 +6,7 @@
 #include "thread.h"
 #include "core.h"
 #include "sift_reader.h"
+#include "trace_manager.h"
 #include "operand.h"
 #include "semaphore.h"
 
@@ -28,6 +29,7 @@
 
 class Instruction;
 class DynamicInstruction;
+class DecodeCache;
 
 class TraceThread : public Runnable
 {
@@ -54,6 +56,8 @@ class TraceThread : public Runnable
       Thread *m_thread;
       SubsecondTime m_time_start;
       Sift::Reader m_trace;
+      Sift::PageMap &m_page_map;  // Translations of m_trace, looked up here directly to avoid a call per address
+      TraceManager::Va2paStats *m_va2pa_stats;
       bool m_trace_has_pa;
       bool m_address_randomization;
       bool m_appid_from_coreid;
@@ -63,7 +67,14 @@ class TraceThread : public Runnable
       //std::unordered_map<IntPtr, const xed_decoded_inst_t *> m_decoder_cache;  // TODO convert to DecoderLib
       //static bool xed_initialized;  // TODO convert to DecoderLib
       //xed_state_t m_xed_state_init;  // TODO convert to DecoderLib
-      std::unordered_map<IntPtr, const dl::DecodedInst *> m_decoder_cache;  // TODO convert to DecoderLib
+      // Decoded instruction for each PC, with the summary of its memory operands and flags used for each dynamic instance
+      struct StaticInst
+      {
+         const dl::DecodedInst *dec_inst;
+         dl::DecodedInstInfo info;
+      };
+      std::unordered_map<IntPtr, StaticInst> m_decoder_cache;
+      DecodeCache *m_decode_cache;  // Shared with all other TraceThreads, NULL if each thread decodes on its own
       UInt64 m_bbv_base;
       UInt64 m_bbv_count;
       UInt64 m_bbv_last;
@@ -78,6 +89,13 @@ class TraceThread : public Runnable
       bool m_blocked;
       bool m_cleanup;
       bool m_started;
+      UInt64 m_icount;  // Instruction number of the current instruction in the trace file
+      UInt64 m_roi_begin_instruction;
+      UInt64 m_stop_instruction;
+      UInt32 m_warmup_batch_size;
+      std::vector<Core::WarmupAccess> m_warmup_batch;  // Data accesses not yet sent to m_warmup_core
+      Core *m_warmup_core;
+      const bool m_reuse_profiling;  // Data accesses in fast-forward go to the reuse profiler (ReuseProfiler::isEnabled)
 
       void run();
       static Sift::Mode __handleInstructionCountFunc(void* arg, uint32_t icount)
@@ -116,10 +134,13 @@ class TraceThread : public Runnable
       void handleRoutineAnnounceFunc(uint64_t eip, const char *name, const char *imgname, uint64_t offset, uint32_t line, uint32_t column, const char *filename);
 
       Instruction* decode(Sift::Instruction &inst);
+      Instruction* createInstruction(Sift::Instruction &inst, const StaticInst &static_inst, IntPtr pa);
       void handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size);
       void handleInstructionDetailed(Sift::Instruction &inst, Sift::Instruction &next_inst, PerformanceModel *prfmdl);
+      void addWarmupAccess(Core *core, IntPtr address, UInt32 size, Core::mem_op_t mem_op_type);
+      void flushWarmup() { if (!m_warmup_batch.empty()) { m_warmup_core->warmupMemory(&m_warmup_batch[0], m_warmup_batch.size()); m_warmup_batch.clear(); } }
       //void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const xed_decoded_inst_t &xed_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_pretetch, PerformanceModel *prfmdl);
-      void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const dl::DecodedInst &decoded_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_pretetch, PerformanceModel *prfmdl);
+      void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const dl::DecodedInstInfo &info, uint32_t mem_idx, Operand::Direction op_type, PerformanceModel *prfmdl);
       void unblock();
 
       SubsecondTime getCurrentTime() const;
@@ -128,6 +149,7 @@ class TraceThread : public Runnable
       dl::DecoderFactory *m_factory;  // we need a factory here to be able to create instructions of any kind
       //const xed_decoded_inst_t* staticDecode(Sift::Instruction &inst);
       const dl::DecodedInst* staticDecode(Sift::Instruction &inst);
+      const StaticInst& getStaticInst(Sift::Instruction &inst);
 
       long long *m_papi_counters;
       
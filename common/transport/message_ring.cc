@@ -0,0 +1,189 @@
+#include "message_ring.h"
+#include "log.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+MessageRing::MessageRing(UInt64 spin_count)
+   : m_head(0)
+   , m_tail(0)
+   , m_overflow_used(false)
+   , m_spin_count(spin_count)
+   , m_waiting(false)
+{
+   static_assert(sizeof(Slot) == SLOT_SIZE, "Unexpected MessageRing::Slot size");
+   static_assert((RING_SIZE & (RING_SIZE - 1)) == 0, "MessageRing::RING_SIZE must be a power of two");
+
+   int res = posix_memalign((void**)&m_ring, sizeof(Slot), RING_SIZE * sizeof(Slot));
+   LOG_ASSERT_ERROR(res == 0, "Cannot allocate message ring");
+   for (UInt32 i = 0; i < RING_SIZE; i++)
+   {
+      m_ring[i].sequence = i;
+      m_ring[i].length = 0;
+      m_ring[i].heap = NULL;
+   }
+}
+
+MessageRing::~MessageRing()
+{
+   Byte *data;
+   while ((data = tryPop()) != NULL)
+      release(data);
+   free(m_ring);
+}
+
+void MessageRing::push(const void *buffer, UInt32 length)
+{
+   if (m_overflow_used || !pushRing(buffer, length))
+   {
+      Byte *data = new Byte[length];
+      memcpy(data, buffer, length);
+
+      ScopedLock sl(m_overflow_lock);
+      m_overflow.push(data);
+      m_overflow_used = true;
+   }
+
+   wakeup();
+}
+
+bool MessageRing::pushRing(const void *buffer, UInt32 length)
+{
+   UInt64 pos = m_head;
+   Slot *slot;
+   while (true)
+   {
+      slot = &m_ring[pos & (RING_SIZE - 1)];
+      SInt64 diff = SInt64(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE)) - SInt64(pos);
+      if (diff == 0)
+      {
+         if (__sync_bool_compare_and_swap(&m_head, pos, pos + 1))
+            break;
+      }
+      else if (diff < 0)
+      {
+         // The slot still holds the message from RING_SIZE positions ago
+         return false;
+      }
+      pos = m_head;
+   }
+
+   slot->length = length;
+   if (length <= INLINE_SIZE)
+   {
+      slot->heap = NULL;
+      memcpy(slot->data, buffer, length);
+   }
+   else
+   {
+      slot->heap = new Byte[length];
+      memcpy(slot->heap, buffer, length);
+   }
+   __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+
+   return true;
+}
+
+Byte* MessageRing::popRing()
+{
+   Slot *slot = &m_ring[m_tail & (RING_SIZE - 1)];
+   if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != m_tail + 1)
+      return NULL;
+
+   ++m_tail;
+   if (slot->heap)
+   {
+      // Hand out the heap copy and free the slot right away
+      Byte *data = slot->heap;
+      __atomic_store_n(&slot->sequence, slot->sequence - 1 + RING_SIZE, __ATOMIC_RELEASE);
+      return data;
+   }
+   else
+   {
+      return slot->data;
+   }
+}
+
+Byte* MessageRing::popOverflow()
+{
+   ScopedLock sl(m_overflow_lock);
+
+   // Messages that made it into the ring before the overflow started come first.
+   // Holding the lock makes sure we see those of producers that overflowed afterwards.
+   Byte *data = popRing();
+   if (data)
+      return data;
+
+   if (m_overflow.empty())
+      return NULL;
+
+   data = m_overflow.front();
+   m_overflow.pop();
+   if (m_overflow.empty())
+      m_overflow_used = false;
+   return data;
+}
+
+Byte* MessageRing::tryPop()
+{
+   Byte *data = popRing();
+   if (!data && m_overflow_used)
+      data = popOverflow();
+   return data;
+}
+
+void MessageRing::release(Byte *buffer)
+{
+   if (buffer >= (Byte*)m_ring && buffer < (Byte*)(m_ring + RING_SIZE))
+   {
+      Slot *slot = &m_ring[(buffer - (Byte*)m_ring) / sizeof(Slot)];
+      // Published as position + 1, free it for position + RING_SIZE
+      __atomic_store_n(&slot->sequence, slot->sequence - 1 + RING_SIZE, __ATOMIC_RELEASE);
+   }
+   else
+   {
+      delete [] buffer;
+   }
+}
+
+bool MessageRing::empty()
+{
+   return __atomic_load_n(&m_ring[m_tail & (RING_SIZE - 1)].sequence, __ATOMIC_ACQUIRE) != m_tail + 1 && !m_overflow_used;
+}
+
+Byte* MessageRing::pop(bool block)
+{
+   Byte *data = tryPop();
+   if (data || !block)
+      return data;
+
+   for (UInt64 i = 0; i < m_spin_count; ++i)
+   {
+      __asm__ __volatile__("pause");
+      if ((data = tryPop()) != NULL)
+         return data;
+   }
+
+   m_lock.acquire();
+   m_waiting = true;
+   // Either we see the new message, or its producer sees that we're going to sleep
+   __sync_synchronize();
+   while ((data = tryPop()) == NULL)
+      m_cond.wait(m_lock);
+   m_waiting = false;
+   m_lock.release();
+
+   return data;
+}
+
+void MessageRing::wakeup()
+{
+   __sync_synchronize();
+   if (m_waiting)
+   {
+      // Taking the lock makes sure the consumer is either still checking for messages, or waiting
+      m_lock.acquire();
+      m_lock.release();
+      m_cond.broadcast();
+   }
+}
@@ -0,0 +1,75 @@
+#ifndef MESSAGE_RING_H
+#define MESSAGE_RING_H
+
+#include "fixed_types.h"
+#include "lock.h"
+#include "cond.h"
+
+#include <queue>
+
+// Lock-free multi-producer, single-consumer message queue used by SmTransport nodes.
+//
+// Messages are copied into a ring of fixed-size slots. A slot holds up to INLINE_SIZE bytes of message inline,
+// larger messages are copied to the heap and the slot holds a pointer. pop() returns a pointer into the slot,
+// which stays valid until the consumer hands it back through release(), so the common (small) message is
+// delivered without any allocation. Producers claim slots with a compare-and-swap on the head position and
+// publish them through the slot's sequence number (Vyukov's bounded queue).
+//
+// When the ring is full, producers fall back to a locked std::queue rather than waiting for the consumer,
+// which could be waiting to send to them. Once a message has gone to the overflow queue, all following ones
+// do until the consumer has emptied it, so messages are still delivered in the order they were sent.
+//
+// A consumer that finds the ring empty spins for spin_count iterations before sleeping on a condition variable.
+
+class MessageRing
+{
+public:
+   MessageRing(UInt64 spin_count);
+   ~MessageRing();
+
+   // Can be called by any thread
+   void push(const void *buffer, UInt32 length);
+
+   // Consumer only: returns NULL if there is no message and block is false
+   Byte* pop(bool block);
+   void release(Byte *buffer);
+   bool empty();
+
+private:
+   static const UInt32 RING_SIZE = 256;     // Must be a power of two
+   static const UInt32 SLOT_SIZE = 256;
+   static const UInt32 INLINE_SIZE = SLOT_SIZE - 3 * sizeof(UInt64);
+
+   struct Slot
+   {
+      volatile UInt64 sequence;  // Position this slot is free for, or position + 1 once it holds that message
+      UInt32 length;
+      Byte *heap;                // Copy of messages larger than INLINE_SIZE
+      Byte data[INLINE_SIZE];
+   } __attribute__((aligned(64)));
+
+   Slot *m_ring;
+   // Keep producer and consumer positions on separate cache lines
+   char m_pad0[64];
+   volatile UInt64 m_head;    // Next position to be claimed by a producer
+   char m_pad1[64];
+   UInt64 m_tail;             // Next position to be read by the consumer
+   char m_pad2[64];
+
+   volatile bool m_overflow_used;
+   Lock m_overflow_lock;
+   std::queue<Byte*> m_overflow;
+
+   const UInt64 m_spin_count;
+   volatile bool m_waiting;
+   Lock m_lock;
+   ConditionVariable m_cond;
+
+   bool pushRing(const void *buffer, UInt32 length);
+   Byte* popRing();
+   Byte* popOverflow();
+   Byte* tryPop();
+   void wakeup();
+};
+
+#endif // MESSAGE_RING_H
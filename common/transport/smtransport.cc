@@ -1,13 +1,20 @@
 #include <string.h>
 
 #include "smtransport.h"
+#include "simulator.h"
 #include "config.h"
+#include "config.hpp"
 #include "log.h"
 
 // -- SmTransport -- //
 
 SmTransport::SmTransport()
+   : m_spin_count(Sim()->getCfg()->getInt("transport/shmem/spin_count"))
 {
+   // Every simulated core has a thread waiting for messages, spinning only pays off if they all have a host core
+   if (Sim()->getConfig()->getApplicationCores() > Sim()->getConfig()->getNumHostCores())
+      m_spin_count = 0;
+
    m_global_node = new SmNode(-1, this);
    m_core_nodes = new SmNode* [ Config::getSingleton()->getTotalCores() ];
    for (UInt32 i = 0; i < Config::getSingleton()->getTotalCores(); i++)
@@ -68,13 +75,14 @@ void SmTransport::clearNodeForId(core_id_t core_id)
 
 SmTransport::SmNode::SmNode(core_id_t core_id, SmTransport *smt)
    : Node(core_id)
+   , m_ring(smt->m_spin_count)
    , m_smt(smt)
 {
 }
 
 SmTransport::SmNode::~SmNode()
 {
-   LOG_ASSERT_WARNING(m_queue.empty(), "Unread messages in queue for core: %d", getCoreId());
+   LOG_ASSERT_WARNING(m_ring.empty(), "Unread messages in queue for core: %d", getCoreId());
    m_smt->clearNodeForId(getCoreId());
 }
 
@@ -93,49 +101,28 @@ void SmTransport::SmNode::send(SInt32 dest_id, const void* buffer, UInt32 length
 
 void SmTransport::SmNode::send(SmNode *dest_node, const void *buffer, UInt32 length)
 {
-   Byte *data = new Byte[length];
-   memcpy(data, buffer, length);
-
-   LOG_PRINT("sending msg -- size: %i, data: %p, dest: %p", length, data, dest_node);
+   LOG_PRINT("sending msg -- size: %i, dest: %p", length, dest_node);
 
-   dest_node->m_lock.acquire();
-   dest_node->m_queue.push(data);
-   dest_node->m_lock.release();
-   dest_node->m_cond.broadcast();
+   dest_node->m_ring.push(buffer, length);
 }
 
 Byte* SmTransport::SmNode::recv()
 {
    LOG_PRINT("attempting recv -- this: %p", this);
 
-   m_lock.acquire();
-
-   while (true)
-   {
-      if (!m_queue.empty())
-      {
-         Byte *data = m_queue.front();
-         m_queue.pop();
-         m_lock.release();
-
-         LOG_PRINT("msg recv'd -- data: %p, this: %p", data, this);
-
-         return data;
-      }
-      else
-      {
-         m_cond.wait(m_lock);
-      }
-   }
+   Byte *data = m_ring.pop(true);
+
+   LOG_PRINT("msg recv'd -- data: %p, this: %p", data, this);
+
+   return data;
 }
 
-bool SmTransport::SmNode::query()
+void SmTransport::SmNode::release(Byte *buffer)
 {
-   bool result = false;
-
-   m_lock.acquire();
-   result = !m_queue.empty();
-   m_lock.release();
+   m_ring.release(buffer);
+}
 
-   return result;
+bool SmTransport::SmNode::query()
+{
+   return !m_ring.empty();
 }
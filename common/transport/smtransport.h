@@ -1,10 +1,8 @@
 #ifndef SMTRANSPORT_H
 #define SMTRANSPORT_H
 
-#include <queue>
-
 #include "transport.h"
-#include "cond.h"
+#include "message_ring.h"
 
 class SmTransport : public Transport
 {
@@ -21,14 +19,13 @@ public:
       void globalSend(SInt32, const void*, UInt32);
       void send(core_id_t, const void*, UInt32);
       Byte* recv();
+      void release(Byte *buffer);
       bool query();
 
    private:
       void send(SmNode *dest, const void *buffer, UInt32 length);
 
-      std::queue<Byte*> m_queue;
-      Lock m_lock;
-      ConditionVariable m_cond;
+      MessageRing m_ring;
       SmTransport *m_smt;
    };
 
@@ -38,6 +35,7 @@ public:
    Node* getGlobalNode();
 
 private:
+   UInt64 m_spin_count;
    Node *m_global_node;
    SmNode **m_core_nodes;
 
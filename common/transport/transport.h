@@ -5,6 +5,13 @@
 
 #include <map>
 
+// Delivers network packets between the nodes (one per core, plus the global node) of a simulation.
+//
+// All nodes live in a single process: the only implementation is SmTransport. This is not an abstraction over
+// processes. Packets may carry pointers into the sender's address space (for instance the data buffers of
+// ShmemMsg), and the cores, caches, network models and thread manager that both ends talk to are process-wide
+// objects reached through Sim(). Spreading tiles over several processes would first require serializing those
+// messages and splitting the simulator state, a transport by itself cannot provide it.
 class Transport
 {
 public:
@@ -18,6 +25,8 @@ public:
       virtual void globalSend(SInt32 dest_proc, const void *buffer, UInt32 length) = 0;
       virtual void send(core_id_t dest, const void *buffer, UInt32 length) = 0;
       virtual Byte* recv() = 0;
+      // Hand back a buffer returned by recv() once its contents have been used
+      virtual void release(Byte *buffer) { delete [] buffer; }
       virtual bool query() = 0;
 
    protected:
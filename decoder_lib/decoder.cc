@@ -26,6 +26,35 @@ dl_syntax Decoder::get_syntax()
   return m_syntax;
 }
 
+void Decoder::get_info(const DecodedInst * inst, DecodedInstInfo * info)
+{
+  info->is_nop = inst->is_nop();
+  info->is_atomic = inst->is_atomic();
+  info->is_prefetch = inst->is_prefetch();
+  info->is_mem_pair = inst->is_mem_pair();
+
+  info->num_memory_operands = 0;
+  info->mem_read_mask = 0;
+  info->mem_write_mask = 0;
+  for (unsigned int mem_idx = 0; mem_idx < DecodedInstInfo::MAX_MEMORY_OPERANDS; ++mem_idx)
+    info->mem_size[mem_idx] = 0;
+
+  if (info->is_nop)
+    return;
+
+  unsigned int num_memory_operands = this->num_memory_operands(inst);
+  assert(num_memory_operands <= DecodedInstInfo::MAX_MEMORY_OPERANDS);
+  info->num_memory_operands = num_memory_operands;
+  for (unsigned int mem_idx = 0; mem_idx < num_memory_operands; ++mem_idx)
+  {
+    if (op_read_mem(inst, mem_idx))
+      info->mem_read_mask |= 1 << mem_idx;
+    if (op_write_mem(inst, mem_idx))
+      info->mem_write_mask |= 1 << mem_idx;
+    info->mem_size[mem_idx] = size_mem_op(inst, mem_idx);
+  }
+}
+
 // DecodedInst
 
 DecodedInst::~DecodedInst() {}
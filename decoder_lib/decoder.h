@@ -37,7 +37,23 @@ typedef enum dl_isa {
 } dl_isa;
   
 class DecodedInst;
-  
+
+/// Flat summary of a decoded instruction's memory operands and flags, filled in once per static
+/// instruction by Decoder::get_info, so per-instruction loops don't need to query the decoder
+struct DecodedInstInfo
+{
+  static const unsigned int MAX_MEMORY_OPERANDS = 8;
+
+  uint8_t num_memory_operands;    ///< Zero for NOPs, which ignore their memory operands
+  uint8_t mem_read_mask;          ///< Bit i set if memory operand i is read
+  uint8_t mem_write_mask;         ///< Bit i set if memory operand i is written
+  bool is_nop;
+  bool is_atomic;
+  bool is_prefetch;
+  bool is_mem_pair;
+  uint16_t mem_size[MAX_MEMORY_OPERANDS];  ///< Size of each memory operand
+};
+
 class Decoder
 {
   public:
@@ -140,6 +156,9 @@ class Decoder
   
     /// Get the value of the last register in the enumeration
     virtual decoder_reg last_reg() = 0;
+
+    /// Fill in the DecodedInstInfo summary of a decoded instruction
+    void get_info(const DecodedInst * inst, DecodedInstInfo * info);
     
     /// Get the target architecture of the decoder
     dl_arch get_arch();
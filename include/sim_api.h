@@ -18,6 +18,9 @@
 #define SIM_CMD_NAMED_MARKER    13
 #define SIM_CMD_SET_THREAD_NAME 14
 
+#define SIM_MARKER_PIM_REGION_BEGIN 0x50494d01  // "PIM" + 1
+#define SIM_MARKER_PIM_REGION_END   0x50494d02
+
 #define SIM_OPT_INSTRUMENT_DETAILED    0
 #define SIM_OPT_INSTRUMENT_WARMUP      1
 #define SIM_OPT_INSTRUMENT_FASTFORWARD 2
@@ -131,5 +134,8 @@
 #define SimUser(cmd, arg)         SimMagic2(SIM_CMD_USER, cmd, arg)
 #define SimSetInstrumentMode(opt) SimMagic1(SIM_CMD_INSTRUMENT_MODE, opt)
 #define SimInSimulator()          (SimMagic0(SIM_CMD_IN_SIMULATOR)!=SIM_CMD_IN_SIMULATOR)
+// Code between these markers is timed on a near-memory core when perf_model/pim/enabled is set
+#define SimPimRegionBegin(id)     SimMarker(SIM_MARKER_PIM_REGION_BEGIN, id)
+#define SimPimRegionEnd(id)       SimMarker(SIM_MARKER_PIM_REGION_END, id)
 
 #endif /* __SIM_API */
@@ -11,6 +11,7 @@
 #include "inst_mode_macros.h"
 #include "local_storage.h"
 #include "toolreg.h"
+#include "reuse_profiler.h"
 
 namespace lite
 {
@@ -21,6 +22,22 @@ void addMemoryModeling(TRACE trace, INS ins, InstMode::inst_mode_t inst_mode)
 {
    if (INS_IsMemoryRead (ins) || INS_IsMemoryWrite (ins))
    {
+      // Fast-forward does not model memory, but adaptive sampling warmup wants to know about reuse
+      if (ReuseProfiler::isEnabled())
+      {
+         for (unsigned int i = 0; i < INS_MemoryOperandCount(ins); i++)
+         {
+            INSTRUMENT(
+                  INSTR_IF_FASTFORWARD(inst_mode),
+                  trace, ins, IPOINT_BEFORE,
+                  AFUNPTR(lite::handleMemoryProfile),
+                  IARG_THREAD_ID,
+                  IARG_EXECUTING,
+                  IARG_MEMORYOP_EA, i,
+                  IARG_END);
+         }
+      }
+
       for (unsigned int i = 0; i < INS_MemoryOperandCount(ins); i++)
       {
          if (INS_MemoryOperandIsRead(ins, i))
@@ -176,6 +193,13 @@ void addMemoryModeling(TRACE trace, INS ins, InstMode::inst_mode_t inst_mode)
    }
 }
 
+void handleMemoryProfile(THREADID thread_id, BOOL executing, IntPtr address)
+{
+   Core *core = localStore[thread_id].thread->getCore();
+   if (executing && core)
+      core->profileMemory(address);
+}
+
 void handleMemoryRead(THREADID thread_id, BOOL executing, ADDRINT eip, bool is_atomic_update, IntPtr read_address, UInt32 read_data_size)
 {
    Core *core = localStore[thread_id].thread->getCore();
@@ -9,6 +9,9 @@ KNOB<UINT64> KnobDetailedTarget(KNOB_MODE_WRITEONCE, "pintool", "d", "0", "instr
 KNOB<UINT64> KnobUseResponseFiles(KNOB_MODE_WRITEONCE, "pintool", "r", "0", "use response files (required for multithreaded applications or when emulating syscalls, default = 0)");
 KNOB<UINT64> KnobEmulateSyscalls(KNOB_MODE_WRITEONCE, "pintool", "e", "0", "emulate syscalls (required for multithreaded applications, default = 0)");
 KNOB<BOOL>   KnobSendPhysicalAddresses(KNOB_MODE_WRITEONCE, "pintool", "pa", "0", "send logical to physical address mapping");
+KNOB<std::string> KnobCodec(KNOB_MODE_WRITEONCE, "pintool", "codec", "zlib", "trace compression: zlib, lz4 or zstd (default = zlib)");
+KNOB<BOOL>   KnobAddressDelta(KNOB_MODE_WRITEONCE, "pintool", "delta", "0", "encode memory addresses as deltas to their predicted stride");
+KNOB<UINT64> KnobSeekableBlocks(KNOB_MODE_WRITEONCE, "pintool", "blocks", "0", "write a seekable trace with this many instructions per block (default = 0, not seekable)");
 KNOB<UINT64> KnobFlowControl(KNOB_MODE_WRITEONCE, "pintool", "flow", "1000", "number of instructions to send before syncing up");
 KNOB<UINT64> KnobFlowControlFF(KNOB_MODE_WRITEONCE, "pintool", "flowff", "100000", "number of instructions to batch up before sending instruction counts in fast-forward mode");
 KNOB<INT64> KnobSiftAppId(KNOB_MODE_WRITEONCE, "pintool", "s", "0", "sift app id (default = 0)");
@@ -370,7 +370,14 @@ void openFile(THREADID threadid)
    #else
       const bool arch32 = false;
    #endif
-   thread_data[threadid].output = new Sift::Writer(filename, getCode, KnobUseResponseFiles.Value() ? false : true, response_filename, threadid, arch32, false, KnobSendPhysicalAddresses.Value());
+   uint64_t compression = Sift::CompressionZlib;
+   if (KnobCodec.Value() == "lz4")
+      compression = Sift::CompressionLz4;
+   else if (KnobCodec.Value() == "zstd")
+      compression = Sift::CompressionZstd;
+   else if (KnobCodec.Value() != "zlib")
+      std::cerr << "[SIFT_RECORDER] Unknown codec " << KnobCodec.Value() << ", using zlib" << std::endl;
+   thread_data[threadid].output = new Sift::Writer(filename, getCode, KnobUseResponseFiles.Value() ? false : true, response_filename, threadid, arch32, false, KnobSendPhysicalAddresses.Value(), NULL, NULL, KnobSeekableBlocks.Value(), compression, KnobAddressDelta.Value());
 
    if (!thread_data[threadid].output->IsOpen())
    {
@@ -18,6 +18,14 @@
 # define SIFT_USE_ZLIB 1
 #endif
 
+// LZ4 and Zstandard codecs are optional, enable with SIFT_USE_LZ4=1 / SIFT_USE_ZSTD=1 in Makefile.config
+#ifndef SIFT_USE_LZ4
+# define SIFT_USE_LZ4 0
+#endif
+#ifndef SIFT_USE_ZSTD
+# define SIFT_USE_ZSTD 0
+#endif
+
 namespace Sift
 {
 
@@ -42,8 +50,53 @@ namespace Sift
       ArchIA32 = 2,
       IcacheVariable = 4,
       PhysicalAddress = 8,
+      SeekableBlocks = 16,
+      AddressDelta = 32,
+      CompressionLz4 = 64,
+      CompressionZstd = 128,
    } Option;
 
+   const uint64_t CompressionMask = CompressionZlib | CompressionLz4 | CompressionZstd;
+
+   // Address encoding (AddressDelta option)
+   //
+   // Memory addresses of Instruction and InstructionExt records are not written as uint64_t, but as the
+   // difference with the address predicted for that operand of that static instruction: its previous address
+   // plus its previous stride. Differences are zig-zag encoded and written as LEB128 varints, so regular
+   // strides take a single byte. In seekable traces, predictions are reset at the start of every block.
+
+   // Seekable container (SeekableBlocks option)
+   //
+   // After the Header, the trace is stored as a sequence of blocks, each made up of a BlockHeader and the
+   // block's records, compressed on their own when one of the Compression* options is also set. Blocks can be decoded
+   // without any of the blocks before them: the writer starts each block with an InstructionExt record and
+   // resends instruction bytes, address mappings and the ISA mode. The file ends with an array of
+   // BlockIndexEntry, one per block, followed by a BlockFooter.
+
+   const uint32_t BlockFooterMagic = 0x58464953; // "SIFX"
+
+   typedef struct
+   {
+      uint32_t compressed_size;  //< Size of the block data in the file, equal to size when stored uncompressed
+      uint32_t size;             //< Size of the uncompressed block data
+      uint64_t icount;           //< Number of instructions in the trace before this block
+   } __attribute__ ((__packed__)) BlockHeader;
+
+   typedef struct
+   {
+      uint64_t icount;           //< Number of instructions in the trace before this block
+      uint64_t offset;           //< File offset of the block's BlockHeader
+   } __attribute__ ((__packed__)) BlockIndexEntry;
+
+   typedef struct
+   {
+      uint64_t index_offset;     //< File offset of the first BlockIndexEntry
+      uint64_t num_blocks;
+      uint64_t icount;           //< Number of instructions in the trace
+      uint32_t magic;
+      uint32_t reserved;
+   } __attribute__ ((__packed__)) BlockFooter;
+
    typedef union
    {
       // Simple format for common instructions
@@ -0,0 +1,146 @@
+#ifndef __SIFT_PAGEMAP_H
+#define __SIFT_PAGEMAP_H
+
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+
+namespace Sift
+{
+   // Page translation cache, maps virtual page numbers onto physical page numbers.
+   //
+   // Lookups first check a small direct-mapped front cache that holds the most recently used pages,
+   // which catches nearly all of the repeated translations for the same instruction and data pages.
+   // Misses go to an open-addressing table (linear probing, power-of-two size, at most half full)
+   // that stores the page pairs inline, so neither lookups nor inserts allocate per entry.
+   class PageMap
+   {
+      public:
+         PageMap()
+            : m_front_hits(0)
+            , m_table_hits(0)
+            , m_misses(0)
+            , m_size(0)
+            , m_mask(INITIAL_SIZE - 1)
+         {
+            for(uint32_t i = 0; i < FRONT_SIZE; ++i)
+               m_front[i].vp = EMPTY;
+            m_table = allocTable(INITIAL_SIZE);
+         }
+
+         ~PageMap()
+         {
+            free(m_table);
+         }
+
+         // Look up the translation for vp, returns false if there is none
+         bool lookup(uint64_t vp, uint64_t &pp)
+         {
+            Entry &front = m_front[vp & (FRONT_SIZE - 1)];
+            if (front.vp == vp)
+            {
+               ++m_front_hits;
+               pp = front.pp;
+               return true;
+            }
+
+            for(uint64_t i = hash(vp) & m_mask; m_table[i].vp != EMPTY; i = (i + 1) & m_mask)
+            {
+               if (m_table[i].vp == vp)
+               {
+                  ++m_table_hits;
+                  front = m_table[i];
+                  pp = front.pp;
+                  return true;
+               }
+            }
+
+            ++m_misses;
+            return false;
+         }
+
+         // Add a translation for vp, or replace the existing one
+         void insert(uint64_t vp, uint64_t pp)
+         {
+            if (vp == EMPTY)
+               return;
+
+            Entry &front = m_front[vp & (FRONT_SIZE - 1)];
+            if (front.vp == vp)
+               front.pp = pp;
+
+            if (2 * (m_size + 1) > m_mask + 1)
+               grow();
+            if (place(m_table, m_mask, vp, pp))
+               ++m_size;
+         }
+
+         uint64_t getFrontHits() const { return m_front_hits; }
+         uint64_t getTableHits() const { return m_table_hits; }
+         uint64_t getMisses() const { return m_misses; }
+         uint64_t getSize() const { return m_size; }
+
+      private:
+         struct Entry
+         {
+            uint64_t vp;
+            uint64_t pp;
+         };
+
+         static const uint64_t EMPTY = ~0ULL;
+         static const uint32_t FRONT_SIZE = 16;
+         static const uint64_t INITIAL_SIZE = 1024;
+
+         uint64_t m_front_hits;
+         uint64_t m_table_hits;
+         uint64_t m_misses;
+
+         Entry m_front[FRONT_SIZE];
+         Entry *m_table;
+         uint64_t m_size;
+         uint64_t m_mask;
+
+         // Consecutive pages differ only in their low bits, mix them into the whole word
+         static uint64_t hash(uint64_t vp)
+         {
+            return (vp * 0x9e3779b97f4a7c15ULL) >> 20;
+         }
+
+         static Entry* allocTable(uint64_t size)
+         {
+            Entry *table = (Entry*)malloc(size * sizeof(Entry));
+            memset(table, 0xff, size * sizeof(Entry)); // All entries EMPTY
+            return table;
+         }
+
+         // Returns true if a new entry was used
+         static bool place(Entry *table, uint64_t mask, uint64_t vp, uint64_t pp)
+         {
+            uint64_t i = hash(vp) & mask;
+            while(table[i].vp != EMPTY && table[i].vp != vp)
+               i = (i + 1) & mask;
+            bool is_new = table[i].vp == EMPTY;
+            table[i].vp = vp;
+            table[i].pp = pp;
+            return is_new;
+         }
+
+         void grow()
+         {
+            uint64_t mask = 2 * (m_mask + 1) - 1;
+            Entry *table = allocTable(mask + 1);
+            for(uint64_t i = 0; i <= m_mask; ++i)
+               if (m_table[i].vp != EMPTY)
+                  place(table, mask, m_table[i].vp, m_table[i].pp);
+            free(m_table);
+            m_table = table;
+            m_mask = mask;
+         }
+
+         // Not copyable, the table is owned
+         PageMap(const PageMap&);
+         PageMap& operator=(const PageMap&);
+   };
+};
+
+#endif // __SIFT_PAGEMAP_H
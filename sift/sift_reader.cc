@@ -10,6 +10,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <sched.h>
+#include <memory>
 
 // Enable (>0) to print out everything we read
 #define VERBOSE 0
@@ -43,6 +45,11 @@ Sift::Reader::Reader(const char *filename, const char *response_filename, uint32
    , handleRoutineAnnounceFunc(NULL)
    , handleRoutineArg(NULL)   
    , filesize(0)
+   , inputstream(NULL)
+   , m_blocks(NULL)
+   , m_input_is_file(false)
+   , m_icount(0)
+   , m_address_delta(false)
    , last_address(0)
    , icache()
    , m_id(id)
@@ -50,6 +57,16 @@ Sift::Reader::Reader(const char *filename, const char *response_filename, uint32
    , m_seen_end(false)
    , m_last_sinst(NULL)
    , m_isa(0)
+   , m_prefetch(false)
+   , m_prefetch_running(false)
+   , m_prefetch_ring(NULL)
+   , m_prefetch_head(0)
+   , m_prefetch_tail(0)
+   , m_prefetch_position(0)
+   , m_prefetch_stop(false)
+   , m_prefetch_index(0)
+   , m_prefetch_count(0)
+   , m_prefetch_failed(false)
 {
 //   if (!xed_initialized)
 //   {
@@ -69,6 +86,20 @@ Sift::Reader::Reader(const char *filename, const char *response_filename, uint32
 
 Sift::Reader::~Reader()
 {
+   if (m_prefetch_running)
+   {
+      m_prefetch_stop = true;
+      pthread_join(m_prefetch_thread, NULL);
+      // Free payloads of records that were never consumed
+      for(uint64_t b = m_prefetch_tail; b != m_prefetch_head; ++b)
+      {
+         PrefetchBatch &batch = m_prefetch_ring[b % PREFETCH_BATCHES];
+         for(uint32_t i = 0; i < batch.count; ++i)
+            if (batch.entries[i].kind == PrefetchOther)
+               delete [] batch.entries[i].payload;
+      }
+      delete [] m_prefetch_ring;
+   }
    free(m_filename);
    free(m_response_filename);
    if (input)
@@ -117,18 +148,46 @@ bool Sift::Reader::initStream()
       std::cerr << "[SIFT:" << m_id << "] Invalid header size\n";
    }
 
-#if SIFT_USE_ZLIB
-   if (hdr.options & CompressionZlib)
+   uint64_t codec = hdr.options & CompressionMask;
+   hdr.options &= ~CompressionMask;
+   if ((codec == CompressionZlib && !SIFT_USE_ZLIB)
+      || (codec == CompressionLz4 && !SIFT_USE_LZ4)
+      || (codec == CompressionZstd && !SIFT_USE_ZSTD))
    {
-      input = new izstream(input);
-      hdr.options &= ~CompressionZlib;
+      std::cerr << "[SIFT:" << m_id << "] Error: Compression requested, but disabled at compile time.\n";
+      return false;
    }
-#else
-   if (hdr.options & CompressionZlib)
+
+   if (hdr.options & SeekableBlocks)
    {
-      std::cerr << "[SIFT:" << m_id << "] Error: Compression requested, but disabled at compile time.\n";
+      if (!S_ISREG(filestatus.st_mode))
+      {
+         std::cerr << "[SIFT:" << m_id << "] Seekable traces can only be read from a file\n";
+         return false;
+      }
+      // Blocks are compressed individually, and read through a memory mapping instead of the ifstream
+      delete input;
+      inputstream = NULL;
+      input = m_blocks = new iblockstream(m_filename, codec);
+      if (m_blocks->fail())
+      {
+         std::cerr << "[SIFT:" << m_id << "] Invalid block index\n";
+         return false;
+      }
+      hdr.options &= ~SeekableBlocks;
+   }
+   else if (codec == CompressionZlib)
+      input = new izstream(input);
+   else if (codec == CompressionLz4)
+      input = new ilz4stream(input);
+   else if (codec == CompressionZstd)
+      input = new izstdstream(input);
+
+   if (hdr.options & AddressDelta)
+   {
+      m_address_delta = true;
+      hdr.options &= ~AddressDelta;
    }
-#endif
 
    if (hdr.options & ArchIA32)
    {
@@ -160,6 +219,8 @@ bool Sift::Reader::initStream()
    std::cerr << "[DEBUG:" << m_id << "] InitStream Connection Open" << std::endl;
    #endif
 
+   m_input_is_file = S_ISREG(filestatus.st_mode);
+
    return true;
 }
 
@@ -195,6 +256,11 @@ bool Sift::Reader::Read(Instruction &inst)
       }
    }
 
+   if (m_prefetch)
+      startPrefetch();
+   if (m_prefetch_running)
+      return readPrefetched(inst);
+
    while(!m_seen_end)
    {
       Record rec;
@@ -209,358 +275,646 @@ bool Sift::Reader::Read(Instruction &inst)
       {
          // Other
          input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
-         switch(rec.Other.type)
-         {
-            case RecOtherEnd:
-               assert(rec.Other.size == 0);
-               m_seen_end = true;
-               // disable EndResponse as it causes lockups with sift_recorder
-               //sendSimpleResponse(RecOtherEndResponse);
-               return false;
-            case RecOtherIcache:
-            {
-               assert(rec.Other.size == sizeof(uint64_t) + ICACHE_SIZE);
-               uint64_t address;
-               uint8_t *bytes = new uint8_t[ICACHE_SIZE];
-               input->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(bytes), ICACHE_SIZE);
-               icache[address] = bytes;
-               break;
-            }
-            case RecOtherIcacheVariable:
-            {
-               #if VERBOSE_ICACHE
-               std::cerr << __FUNCTION__ << ": rec=" << std::endl;
-               hexdump(&rec, sizeof(rec.Other));
-               #endif
-               uint64_t address;
-               size_t size = rec.Other.size - sizeof(uint64_t);
-               input->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
-               size_t size_left = size;
-               while (size_left > 0)
-               {
-                  uint64_t base_addr = address & ICACHE_PAGE_MASK;
-                  if (icache.count(base_addr) == 0)
-                     icache[base_addr] = new uint8_t[ICACHE_SIZE];
-                  uint64_t offset = address & ICACHE_OFFSET_MASK;
-                  size_t read_amount = std::min(size_left, size_t(ICACHE_SIZE - offset));
-                  input->read(const_cast<char*>(reinterpret_cast<const char*>(&(icache[base_addr][offset]))), read_amount);
-
-                  #if VERBOSE_ICACHE
-                  std::cerr << __FUNCTION__ << ": Wrote " << read_amount << " bytes to 0x" << std::hex << (void*)&(icache[base_addr][offset]) << std::dec << std::endl;
-                  hexdump(&(icache[base_addr][offset]), read_amount);
-                  #endif
-
-                  size_left -= read_amount;
-                  address = base_addr + ICACHE_SIZE;
-               }
-               break;
-            }
-            case RecOtherLogical2Physical:
-            {
-               assert(rec.Other.size == 2 * sizeof(uint64_t));
-               uint64_t vp, pp;
-               input->read(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
-               vcache[vp] = pp;
-               break;
-            }
-            case RecOtherInstructionCount:
-            {
-               #if VERBOSE > 0
-               std::cerr << "[DEBUG:" << m_id << "] Read InstructionCount" << std::endl;
-               #endif
-               assert(rec.Other.size == sizeof(uint32_t));
-               uint32_t icount;
-               input->read(reinterpret_cast<char*>(&icount), sizeof(icount));
-               Mode mode = ModeUnknown;
-               if (handleInstructionCountFunc)
-                  mode = handleInstructionCountFunc(handleInstructionCountArg, icount);
-               sendSimpleResponse(RecOtherSyncResponse, &mode, sizeof(Mode));
-               break;
-            }
-            case RecOtherCacheOnly:
-            {
-               #if VERBOSE > 0
-               std::cerr << "[DEBUG:" << m_id << "] Read CacheOnly" << std::endl;
-               #endif
-               assert(rec.Other.size == sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint64_t) + sizeof(uint64_t));
-               uint8_t icount, type;
-               uint64_t eip, address;
-               input->read(reinterpret_cast<char*>(&icount), sizeof(uint8_t));
-               input->read(reinterpret_cast<char*>(&type), sizeof(uint8_t));
-               input->read(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
-               if (handleCacheOnlyFunc)
-                  handleCacheOnlyFunc(handleCacheOnlyArg, icount, (Sift::CacheOnlyType)type, eip, address);
-               break;
-            }
-            case RecOtherOutput:
-            {
-               #if VERBOSE > 0
-               std::cerr << "[DEBUG:" << m_id << "] Read Output" << std::endl;
-               #endif
-               assert(rec.Other.size > sizeof(uint8_t));
-               uint8_t fd;
-               uint32_t size = rec.Other.size - sizeof(uint8_t);
-               uint8_t *bytes = new uint8_t[size];
-               input->read(reinterpret_cast<char*>(&fd), sizeof(uint8_t));
-               input->read(reinterpret_cast<char*>(bytes), size);
-               if (handleOutputFunc)
-                  handleOutputFunc(handleOutputArg, fd, bytes, size);
-               delete [] bytes;
-               break;
-            }
-            case RecOtherSyscallRequest:
-            {
-               #if VERBOSE > 0
-               std::cerr << "[DEBUG:" << m_id << "] Read SyscallRequest" << std::endl;
-               #endif
-               assert(rec.Other.size > sizeof(uint16_t));
-               uint16_t syscall_number;
-               uint32_t size = rec.Other.size - sizeof(uint16_t);
-               uint8_t *bytes = new uint8_t[size];
-               input->read(reinterpret_cast<char*>(&syscall_number), sizeof(uint16_t));
-               input->read(reinterpret_cast<char*>(bytes), size);
-               #if VERBOSE_HEX > 0
-               hexdump((char*)&rec, sizeof(rec.Other));
-               hexdump((char*)&syscall_number, sizeof(syscall_number));
-               hexdump((char*)bytes, size);
-               #endif
-               #if VERBOSE > 1
-               for (int i = 0 ; i < (size/8) ; i++)
-               {
-                  std::cerr << __FUNCTION__ << ": syscall args[" << i << "] = " << ((uint64_t*)bytes)[i] << std::endl;
-               }
-               #endif
-
-               assert(handleSyscallFunc);
-               if (handleSyscallFunc)
-               {
-                  #if VERBOSE > 0
-                  std::cerr << "[DEBUG:" << m_id << "] HandleSyscall" << std::endl;
-                  #endif
-                  uint64_t ret = handleSyscallFunc(handleSyscallArg, syscall_number, bytes, size);
-                  sendSyscallResponse(ret);
-               }
-               delete [] bytes;
-               break;
-            }
-            case RecOtherNewThread:
-            {
-               assert(rec.Other.size == 0);
-               assert(handleNewThreadFunc);
-               if (handleNewThreadFunc)
-               {
-                  #if VERBOSE > 0
-                  std::cerr << "[DEBUG:" << m_id << "] HandleNewThread" << std::endl;
-                  #endif
-                  int32_t ret = handleNewThreadFunc(handleNewThreadArg);
-                  sendSimpleResponse(RecOtherNewThreadResponse, &ret, sizeof(ret));
-                  #if VERBOSE > 0
-                  std::cerr << "[DEBUG:" << m_id << "] HandleNewThread Done" << std::endl;
-                  #endif
-               }
-               break;
-            }
-            case RecOtherJoin:
-            {
-               int32_t thread;
-               assert(rec.Other.size == sizeof(thread));
-               input->read(reinterpret_cast<char*>(&thread), sizeof(thread));
-               assert(handleJoinFunc);
-               if (handleJoinFunc)
-               {
-                  #if VERBOSE > 0
-                  std::cerr << "[DEBUG:" << m_id << "] HandleJoin" << std::endl;
-                  #endif
-                  int32_t ret = handleJoinFunc(handleJoinArg, thread);
-                  sendSimpleResponse(RecOtherJoinResponse, &ret, sizeof(ret));
-                  #if VERBOSE > 0
-                  std::cerr << "[DEBUG:" << m_id << "] HandleJoin Done" << std::endl;
-                  #endif
-               }
-               break;
-            }
-            case RecOtherSync:
-            {
-               assert(rec.Other.size == 0);
-               Mode mode = ModeUnknown;
-               if (handleInstructionCountFunc)
-                  mode = handleInstructionCountFunc(handleInstructionCountArg, 0);
-               sendSimpleResponse(RecOtherSyncResponse, &mode, sizeof(Mode));
-               break;
-            }
-            case RecOtherFork:
-            {
-               assert(rec.Other.size == 0);
-               assert(handleForkFunc);
-               if(handleForkFunc)
-               {
-                  #if VERBOSE > 0
-                  std::cerr << "[DEBUG:" << m_id << "] HandleFork" << std::endl;
-                  #endif
-                  int32_t ret = handleForkFunc(handleForkArg);
-                  sendSimpleResponse(RecOtherForkResponse, &ret, sizeof(ret));
-                  #if VERBOSE > 0
-                  std::cerr << "[DEBUG:" << m_id << "] HandleFork Done" << std::endl;
-                  #endif
-               }
-               break;
-            }
-            case RecOtherMagicInstruction:
-            {
-               assert(rec.Other.size == 3 * sizeof(uint64_t));
-               uint64_t a, b, c;
-               input->read(reinterpret_cast<char*>(&a), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&b), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&c), sizeof(uint64_t));
-               uint64_t result;
-               if (handleMagicFunc)
-               {
-                  result = handleMagicFunc(handleMagicArg, a, b, c);
-               }
-               else
-               {
-                  result = a; // Do not modify GAX register
-               }
-               sendSimpleResponse(RecOtherMagicInstructionResponse, &result, sizeof(result));
-               break;
-            }
-            case RecOtherEmu:
-            {
-               assert(rec.Other.size <= sizeof(uint16_t) + sizeof(EmuRequest));
-               uint16_t type; EmuRequest req;
-               input->read(reinterpret_cast<char*>(&type), sizeof(uint16_t));
-               input->read(reinterpret_cast<char*>(&req), rec.Other.size - sizeof(uint16_t));
-               bool result = false; EmuReply res = {};
-               if (handleEmuFunc)
-               {
-                  result = handleEmuFunc(handleEmuArg, EmuType(type), req, res);
-               }
-               sendEmuResponse(result, res);
-               break;
-            }
-            case RecOtherRoutineChange:
-            {
-               assert(rec.Other.size == sizeof(uint8_t) + 3 * sizeof(uint64_t));
-               uint8_t event;
-               uint64_t eip, esp, callEip;
-               input->read(reinterpret_cast<char*>(&event), sizeof(uint8_t));
-               input->read(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&esp), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&callEip), sizeof(uint64_t));
-               if (handleRoutineChangeFunc)
-                  handleRoutineChangeFunc(handleRoutineArg, Sift::RoutineOpType(event), eip, esp, callEip);
-               break;
-            }
-            case RecOtherRoutineAnnounce:
-            {
-               uint64_t eip, offset;
-               uint16_t len_name, len_imgname, len_filename;
-               char *name, *imgname, *filename;
-               uint32_t line, column;
-               input->read(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&len_name), sizeof(uint16_t));
-               name = (char*)malloc(len_name);
-               input->read(name, len_name);
-               input->read(reinterpret_cast<char*>(&len_imgname), sizeof(uint16_t));
-               imgname = (char*)malloc(len_imgname);
-               input->read(imgname, len_imgname);
-               input->read(reinterpret_cast<char*>(&offset), sizeof(uint64_t));
-               input->read(reinterpret_cast<char*>(&line), sizeof(uint32_t));
-               input->read(reinterpret_cast<char*>(&column), sizeof(uint32_t));
-               input->read(reinterpret_cast<char*>(&len_filename), sizeof(uint16_t));
-               filename = (char*)malloc(len_filename);
-               input->read(filename, len_filename);
-               if (handleRoutineAnnounceFunc)
-                  handleRoutineAnnounceFunc(handleRoutineArg, eip, name, imgname, offset, line, column, filename);
-               free(name);
-               free(filename);
-               break;
-            }            
-            case RecOtherISAChange:
-            { 
-               assert(rec.Other.size == sizeof(uint32_t));
-               uint32_t new_isa;
-               input->read(reinterpret_cast<char*>(&new_isa), sizeof(new_isa));
-               m_isa = new_isa; // save here new ISA mode value
-
-               break;
-            }
-            default:
-            {
-               uint8_t *bytes = new uint8_t[rec.Other.size];
-               input->read(reinterpret_cast<char*>(bytes), rec.Other.size);
-               delete [] bytes;
-               break;
-            }
-         }
+         if (!handleOtherRecord(input, rec))
+            return false;
          continue;
       }
 
-      uint8_t size;
-      uint64_t addr;
+      readInstruction(input, byte, inst);
+      return true;
+   }
 
-      if ((byte & 0xf) != 0)
-      {
-         // Instruction
-         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Instruction));
+   // We should not return false (no more instructions) unless we get the End packet.
+   // Return true in case we get to this point (which we shouldn't).
+   return true;
+}
 
-         #if VERBOSE_HEX > 2
-         hexdump(&rec, sizeof(rec.Instruction));
+bool Sift::Reader::handleOtherRecord(vistream *in, Record &rec)
+{
+   switch(rec.Other.type)
+   {
+      case RecOtherEnd:
+         assert(rec.Other.size == 0);
+         m_seen_end = true;
+         // disable EndResponse as it causes lockups with sift_recorder
+         //sendSimpleResponse(RecOtherEndResponse);
+         return false;
+      case RecOtherIcache:
+      {
+         assert(rec.Other.size == sizeof(uint64_t) + ICACHE_SIZE);
+         uint64_t address;
+         uint8_t *bytes = new uint8_t[ICACHE_SIZE];
+         in->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(bytes), ICACHE_SIZE);
+         icache[address] = bytes;
+         break;
+      }
+      case RecOtherIcacheVariable:
+      {
+         #if VERBOSE_ICACHE
+         std::cerr << __FUNCTION__ << ": rec=" << std::endl;
+         hexdump(&rec, sizeof(rec.Other));
          #endif
-
-         size = rec.Instruction.size;
-         addr = last_address;
-         inst.num_addresses = rec.Instruction.num_addresses;
-         inst.is_branch = rec.Instruction.is_branch;
-         inst.taken = rec.Instruction.taken;
-         inst.is_predicate = false;
-         inst.executed = true;
-         inst.isa = m_isa;
+         uint64_t address;
+         size_t size = rec.Other.size - sizeof(uint64_t);
+         in->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+         size_t size_left = size;
+         while (size_left > 0)
+         {
+            uint64_t base_addr = address & ICACHE_PAGE_MASK;
+            if (icache.count(base_addr) == 0)
+               icache[base_addr] = new uint8_t[ICACHE_SIZE];
+            uint64_t offset = address & ICACHE_OFFSET_MASK;
+            size_t read_amount = std::min(size_left, size_t(ICACHE_SIZE - offset));
+            in->read(const_cast<char*>(reinterpret_cast<const char*>(&(icache[base_addr][offset]))), read_amount);
+
+            #if VERBOSE_ICACHE
+            std::cerr << __FUNCTION__ << ": Wrote " << read_amount << " bytes to 0x" << std::hex << (void*)&(icache[base_addr][offset]) << std::dec << std::endl;
+            hexdump(&(icache[base_addr][offset]), read_amount);
+            #endif
+
+            size_left -= read_amount;
+            address = base_addr + ICACHE_SIZE;
+         }
+         break;
       }
-      else
+      case RecOtherLogical2Physical:
       {
-         // InstructionExt
-         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.InstructionExt));
-
-         #if VERBOSE_HEX > 2
-         hexdump(&rec, sizeof(rec.InstructionExt));
+         assert(rec.Other.size == 2 * sizeof(uint64_t));
+         uint64_t vp, pp;
+         in->read(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
+         vcache.insert(vp, pp);
+         break;
+      }
+      case RecOtherInstructionCount:
+      {
+         #if VERBOSE > 0
+         std::cerr << "[DEBUG:" << m_id << "] Read InstructionCount" << std::endl;
+         #endif
+         assert(rec.Other.size == sizeof(uint32_t));
+         uint32_t icount;
+         in->read(reinterpret_cast<char*>(&icount), sizeof(icount));
+         Mode mode = ModeUnknown;
+         if (handleInstructionCountFunc)
+            mode = handleInstructionCountFunc(handleInstructionCountArg, icount);
+         sendSimpleResponse(RecOtherSyncResponse, &mode, sizeof(Mode));
+         break;
+      }
+      case RecOtherCacheOnly:
+      {
+         #if VERBOSE > 0
+         std::cerr << "[DEBUG:" << m_id << "] Read CacheOnly" << std::endl;
+         #endif
+         assert(rec.Other.size == sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint64_t) + sizeof(uint64_t));
+         uint8_t icount, type;
+         uint64_t eip, address;
+         in->read(reinterpret_cast<char*>(&icount), sizeof(uint8_t));
+         in->read(reinterpret_cast<char*>(&type), sizeof(uint8_t));
+         in->read(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+         if (handleCacheOnlyFunc)
+            handleCacheOnlyFunc(handleCacheOnlyArg, icount, (Sift::CacheOnlyType)type, eip, address);
+         break;
+      }
+      case RecOtherOutput:
+      {
+         #if VERBOSE > 0
+         std::cerr << "[DEBUG:" << m_id << "] Read Output" << std::endl;
+         #endif
+         assert(rec.Other.size > sizeof(uint8_t));
+         uint8_t fd;
+         uint32_t size = rec.Other.size - sizeof(uint8_t);
+         uint8_t *bytes = new uint8_t[size];
+         in->read(reinterpret_cast<char*>(&fd), sizeof(uint8_t));
+         in->read(reinterpret_cast<char*>(bytes), size);
+         if (handleOutputFunc)
+            handleOutputFunc(handleOutputArg, fd, bytes, size);
+         delete [] bytes;
+         break;
+      }
+      case RecOtherSyscallRequest:
+      {
+         #if VERBOSE > 0
+         std::cerr << "[DEBUG:" << m_id << "] Read SyscallRequest" << std::endl;
+         #endif
+         assert(rec.Other.size > sizeof(uint16_t));
+         uint16_t syscall_number;
+         uint32_t size = rec.Other.size - sizeof(uint16_t);
+         uint8_t *bytes = new uint8_t[size];
+         in->read(reinterpret_cast<char*>(&syscall_number), sizeof(uint16_t));
+         in->read(reinterpret_cast<char*>(bytes), size);
+         #if VERBOSE_HEX > 0
+         hexdump((char*)&rec, sizeof(rec.Other));
+         hexdump((char*)&syscall_number, sizeof(syscall_number));
+         hexdump((char*)bytes, size);
+         #endif
+         #if VERBOSE > 1
+         for (int i = 0 ; i < (size/8) ; i++)
+         {
+            std::cerr << __FUNCTION__ << ": syscall args[" << i << "] = " << ((uint64_t*)bytes)[i] << std::endl;
+         }
          #endif
 
-         size = rec.InstructionExt.size;
-         addr = rec.InstructionExt.addr;
-         inst.num_addresses = rec.InstructionExt.num_addresses;
-         inst.is_branch = rec.InstructionExt.is_branch;
-         inst.taken = rec.InstructionExt.taken;
-         inst.is_predicate = rec.InstructionExt.is_predicate;
-         inst.executed = rec.InstructionExt.executed;
-         inst.isa = m_isa;
-
-         last_address = addr;
+         assert(handleSyscallFunc);
+         if (handleSyscallFunc)
+         {
+            #if VERBOSE > 0
+            std::cerr << "[DEBUG:" << m_id << "] HandleSyscall" << std::endl;
+            #endif
+            uint64_t ret = handleSyscallFunc(handleSyscallArg, syscall_number, bytes, size);
+            sendSyscallResponse(ret);
+         }
+         delete [] bytes;
+         break;
       }
+      case RecOtherNewThread:
+      {
+         assert(rec.Other.size == 0);
+         assert(handleNewThreadFunc);
+         if (handleNewThreadFunc)
+         {
+            #if VERBOSE > 0
+            std::cerr << "[DEBUG:" << m_id << "] HandleNewThread" << std::endl;
+            #endif
+            int32_t ret = handleNewThreadFunc(handleNewThreadArg);
+            sendSimpleResponse(RecOtherNewThreadResponse, &ret, sizeof(ret));
+            #if VERBOSE > 0
+            std::cerr << "[DEBUG:" << m_id << "] HandleNewThread Done" << std::endl;
+            #endif
+         }
+         break;
+      }
+      case RecOtherJoin:
+      {
+         int32_t thread;
+         assert(rec.Other.size == sizeof(thread));
+         in->read(reinterpret_cast<char*>(&thread), sizeof(thread));
+         assert(handleJoinFunc);
+         if (handleJoinFunc)
+         {
+            #if VERBOSE > 0
+            std::cerr << "[DEBUG:" << m_id << "] HandleJoin" << std::endl;
+            #endif
+            int32_t ret = handleJoinFunc(handleJoinArg, thread);
+            sendSimpleResponse(RecOtherJoinResponse, &ret, sizeof(ret));
+            #if VERBOSE > 0
+            std::cerr << "[DEBUG:" << m_id << "] HandleJoin Done" << std::endl;
+            #endif
+         }
+         break;
+      }
+      case RecOtherSync:
+      {
+         assert(rec.Other.size == 0);
+         Mode mode = ModeUnknown;
+         if (handleInstructionCountFunc)
+            mode = handleInstructionCountFunc(handleInstructionCountArg, 0);
+         sendSimpleResponse(RecOtherSyncResponse, &mode, sizeof(Mode));
+         break;
+      }
+      case RecOtherFork:
+      {
+         assert(rec.Other.size == 0);
+         assert(handleForkFunc);
+         if(handleForkFunc)
+         {
+            #if VERBOSE > 0
+            std::cerr << "[DEBUG:" << m_id << "] HandleFork" << std::endl;
+            #endif
+            int32_t ret = handleForkFunc(handleForkArg);
+            sendSimpleResponse(RecOtherForkResponse, &ret, sizeof(ret));
+            #if VERBOSE > 0
+            std::cerr << "[DEBUG:" << m_id << "] HandleFork Done" << std::endl;
+            #endif
+         }
+         break;
+      }
+      case RecOtherMagicInstruction:
+      {
+         assert(rec.Other.size == 3 * sizeof(uint64_t));
+         uint64_t a, b, c;
+         in->read(reinterpret_cast<char*>(&a), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(&b), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(&c), sizeof(uint64_t));
+         uint64_t result;
+         if (handleMagicFunc)
+         {
+            result = handleMagicFunc(handleMagicArg, a, b, c);
+         }
+         else
+         {
+            result = a; // Do not modify GAX register
+         }
+         sendSimpleResponse(RecOtherMagicInstructionResponse, &result, sizeof(result));
+         break;
+      }
+      case RecOtherEmu:
+      {
+         assert(rec.Other.size <= sizeof(uint16_t) + sizeof(EmuRequest));
+         uint16_t type; EmuRequest req;
+         in->read(reinterpret_cast<char*>(&type), sizeof(uint16_t));
+         in->read(reinterpret_cast<char*>(&req), rec.Other.size - sizeof(uint16_t));
+         bool result = false; EmuReply res = {};
+         if (handleEmuFunc)
+         {
+            result = handleEmuFunc(handleEmuArg, EmuType(type), req, res);
+         }
+         sendEmuResponse(result, res);
+         break;
+      }
+      case RecOtherRoutineChange:
+      {
+         assert(rec.Other.size == sizeof(uint8_t) + 3 * sizeof(uint64_t));
+         uint8_t event;
+         uint64_t eip, esp, callEip;
+         in->read(reinterpret_cast<char*>(&event), sizeof(uint8_t));
+         in->read(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(&esp), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(&callEip), sizeof(uint64_t));
+         if (handleRoutineChangeFunc)
+            handleRoutineChangeFunc(handleRoutineArg, Sift::RoutineOpType(event), eip, esp, callEip);
+         break;
+      }
+      case RecOtherRoutineAnnounce:
+      {
+         uint64_t eip, offset;
+         uint16_t len_name, len_imgname, len_filename;
+         char *name, *imgname, *filename;
+         uint32_t line, column;
+         in->read(reinterpret_cast<char*>(&eip), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(&len_name), sizeof(uint16_t));
+         name = (char*)malloc(len_name);
+         in->read(name, len_name);
+         in->read(reinterpret_cast<char*>(&len_imgname), sizeof(uint16_t));
+         imgname = (char*)malloc(len_imgname);
+         in->read(imgname, len_imgname);
+         in->read(reinterpret_cast<char*>(&offset), sizeof(uint64_t));
+         in->read(reinterpret_cast<char*>(&line), sizeof(uint32_t));
+         in->read(reinterpret_cast<char*>(&column), sizeof(uint32_t));
+         in->read(reinterpret_cast<char*>(&len_filename), sizeof(uint16_t));
+         filename = (char*)malloc(len_filename);
+         in->read(filename, len_filename);
+         if (handleRoutineAnnounceFunc)
+            handleRoutineAnnounceFunc(handleRoutineArg, eip, name, imgname, offset, line, column, filename);
+         free(name);
+         free(filename);
+         break;
+      }            
+      case RecOtherISAChange:
+      { 
+         assert(rec.Other.size == sizeof(uint32_t));
+         uint32_t new_isa;
+         in->read(reinterpret_cast<char*>(&new_isa), sizeof(new_isa));
+         m_isa = new_isa; // save here new ISA mode value
+
+         break;
+      }
+      default:
+      {
+         uint8_t *bytes = new uint8_t[rec.Other.size];
+         in->read(reinterpret_cast<char*>(bytes), rec.Other.size);
+         delete [] bytes;
+         break;
+      }
+   }
+   return true;
+}
 
-      last_address += size;
+uint64_t Sift::Reader::readVarint(vistream *in)
+{
+   uint64_t value = 0;
+   for(uint32_t shift = 0; shift < 7 * MAX_VARINT_SIZE; shift += 7)
+   {
+      uint8_t byte;
+      in->read(reinterpret_cast<char*>(&byte), sizeof(byte));
+      value |= uint64_t(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+         break;
+   }
+   return value;
+}
 
-      for(int i = 0; i < inst.num_addresses; ++i)
-         input->read(reinterpret_cast<char*>(&inst.addresses[i]), sizeof(uint64_t));
+void Sift::Reader::readInstruction(vistream *in, uint8_t byte, Instruction &inst)
+{
+   Record rec;
+   uint8_t size;
+   uint64_t addr;
 
-      inst.sinst = getStaticInstruction(addr, size);
+   if ((byte & 0xf) != 0)
+   {
+      // Instruction
+      in->read(reinterpret_cast<char*>(&rec), sizeof(rec.Instruction));
 
       #if VERBOSE_HEX > 2
-      hexdump(inst.sinst->data, inst.sinst->size);
+      hexdump(&rec, sizeof(rec.Instruction));
       #endif
-      #if VERBOSE > 2
-      printf("%016lx (%d) A%u %c%c %c%c\n", inst.sinst->addr, inst.sinst->size, inst.num_addresses, inst.is_branch?'B':'.', inst.is_branch?(inst.taken?'T':'.'):'.', inst.is_predicate?'C':'.', inst.is_predicate?(inst.executed?'E':'n'):'.');
+
+      size = rec.Instruction.size;
+      addr = last_address;
+      inst.num_addresses = rec.Instruction.num_addresses;
+      inst.is_branch = rec.Instruction.is_branch;
+      inst.taken = rec.Instruction.taken;
+      inst.is_predicate = false;
+      inst.executed = true;
+      inst.isa = m_isa;
+   }
+   else
+   {
+      // InstructionExt
+      in->read(reinterpret_cast<char*>(&rec), sizeof(rec.InstructionExt));
+
+      #if VERBOSE_HEX > 2
+      hexdump(&rec, sizeof(rec.InstructionExt));
       #endif
 
-      return true;
+      size = rec.InstructionExt.size;
+      addr = rec.InstructionExt.addr;
+      inst.num_addresses = rec.InstructionExt.num_addresses;
+      inst.is_branch = rec.InstructionExt.is_branch;
+      inst.taken = rec.InstructionExt.taken;
+      inst.is_predicate = rec.InstructionExt.is_predicate;
+      inst.executed = rec.InstructionExt.executed;
+      inst.isa = m_isa;
+
+      last_address = addr;
    }
 
-   // We should not return false (no more instructions) unless we get the End packet.
-   // Return true in case we get to this point (which we shouldn't).
-   return true;
+   last_address += size;
+
+   inst.sinst = getStaticInstruction(addr, size);
+   ++m_icount;
+
+   if (m_address_delta)
+   {
+      // Predictions start over in every block of a seekable trace
+      uint64_t generation = m_blocks ? m_blocks->getGeneration() : 0;
+      if (inst.sinst->predictors_generation != generation)
+      {
+         inst.sinst->predictors = AddressPredictors();
+         inst.sinst->predictors_generation = generation;
+      }
+      for(int i = 0; i < inst.num_addresses; ++i)
+      {
+         AddressPredictor &predictor = inst.sinst->predictors.operands[i];
+         inst.addresses[i] = predictor.predict() + zigzagDecode(readVarint(in));
+         predictor.update(inst.addresses[i]);
+      }
+   }
+   else
+   {
+      for(int i = 0; i < inst.num_addresses; ++i)
+         in->read(reinterpret_cast<char*>(&inst.addresses[i]), sizeof(uint64_t));
+   }
+
+   #if VERBOSE_HEX > 2
+   hexdump(inst.sinst->data, inst.sinst->size);
+   #endif
+   #if VERBOSE > 2
+   printf("%016lx (%d) A%u %c%c %c%c\n", inst.sinst->addr, inst.sinst->size, inst.num_addresses, inst.is_branch?'B':'.', inst.is_branch?(inst.taken?'T':'.'):'.', inst.is_predicate?'C':'.', inst.is_predicate?(inst.executed?'E':'n'):'.');
+   #endif
+}
+
+void Sift::Reader::startPrefetch()
+{
+   m_prefetch = false;
+
+   // Reading ahead of a FIFO could block the helper thread on data the recorder only sends
+   // after receiving a response from us, so only do this for trace files
+   if (!m_input_is_file)
+      return;
+
+   m_prefetch_ring = new PrefetchBatch[PREFETCH_BATCHES];
+   if (pthread_create(&m_prefetch_thread, NULL, __prefetchThread, this) == 0)
+   {
+      m_prefetch_running = true;
+   }
+   else
+   {
+      std::cerr << "[SIFT:" << m_id << "] Cannot start read-ahead thread, reading synchronously\n";
+      delete [] m_prefetch_ring;
+      m_prefetch_ring = NULL;
+   }
+}
+
+void* Sift::Reader::__prefetchThread(void *arg)
+{
+   static_cast<Reader*>(arg)->prefetchThread();
+   return NULL;
+}
+
+void Sift::Reader::prefetchThread()
+{
+   // From here on, this thread owns input, icache, scache and m_isa.
+   // Records that only serve to build static instructions are consumed here,
+   // everything else is passed on to the simulation thread in order.
+   bool done = false;
+   while (!done)
+   {
+      uint32_t spins = 0;
+      while (m_prefetch_head - m_prefetch_tail == PREFETCH_BATCHES)
+      {
+         if (m_prefetch_stop)
+            return;
+         prefetchWait(spins);
+      }
+
+      PrefetchBatch &batch = m_prefetch_ring[m_prefetch_head % PREFETCH_BATCHES];
+      batch.count = 0;
+      while (batch.count < PREFETCH_BATCH_SIZE && !done)
+      {
+         PrefetchEntry &entry = batch.entries[batch.count];
+         uint8_t byte = input->peek();
+         if (input->fail())
+         {
+            entry.kind = PrefetchFail;
+            entry.error = errno;
+            ++batch.count;
+            done = true;
+         }
+         else if (byte == 0)
+         {
+            Record rec;
+            input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+            if (rec.Other.type == RecOtherIcache || rec.Other.type == RecOtherIcacheVariable || rec.Other.type == RecOtherISAChange)
+            {
+               handleOtherRecord(input, rec);
+            }
+            else
+            {
+               entry.kind = PrefetchOther;
+               entry.type = rec.Other.type;
+               entry.size = rec.Other.size;
+               entry.payload = entry.size ? new uint8_t[entry.size] : NULL;
+               if (entry.size)
+                  input->read(reinterpret_cast<char*>(entry.payload), entry.size);
+               ++batch.count;
+               if (rec.Other.type == RecOtherEnd)
+                  done = true;
+            }
+         }
+         else
+         {
+            entry.kind = PrefetchInstruction;
+            readInstruction(input, byte, entry.inst);
+            ++batch.count;
+         }
+      }
+
+      m_prefetch_position = currentPosition();
+      // Make sure the batch is complete before the simulation thread can see it
+      __sync_synchronize();
+      ++m_prefetch_head;
+   }
+}
+
+void Sift::Reader::prefetchWait(uint32_t &spins)
+{
+   if (++spins < 64)
+      sched_yield();
+   else
+      usleep(10);
+}
+
+Sift::Reader::PrefetchEntry& Sift::Reader::nextPrefetched()
+{
+   if (m_prefetch_index == m_prefetch_count)
+   {
+      if (m_prefetch_count)
+      {
+         // Hand the batch we're done with back to the helper thread
+         __sync_synchronize();
+         ++m_prefetch_tail;
+      }
+      uint32_t spins = 0;
+      while (m_prefetch_tail == m_prefetch_head)
+         prefetchWait(spins);
+      __sync_synchronize();
+      m_prefetch_index = 0;
+      m_prefetch_count = m_prefetch_ring[m_prefetch_tail % PREFETCH_BATCHES].count;
+   }
+   return m_prefetch_ring[m_prefetch_tail % PREFETCH_BATCHES].entries[m_prefetch_index++];
+}
+
+bool Sift::Reader::readPrefetched(Instruction &inst)
+{
+   while(!m_seen_end && !m_prefetch_failed)
+   {
+      PrefetchEntry &entry = nextPrefetched();
+      switch(entry.kind)
+      {
+         case PrefetchInstruction:
+            inst = entry.inst;
+            return true;
+         case PrefetchOther:
+         {
+            Record rec;
+            rec.Other.zero = 0;
+            rec.Other.type = entry.type;
+            rec.Other.size = entry.size;
+            imstream payload(entry.payload, entry.size);
+            bool more = handleOtherRecord(&payload, rec);
+            delete [] entry.payload;
+            entry.payload = NULL;
+            if (!more)
+               return false;
+            break;
+         }
+         case PrefetchFail:
+            std::cerr << "[SIFT:" << m_id << "] Error: " << strerror(entry.error) << "\n";
+            m_prefetch_failed = true;
+            return false;
+      }
+   }
+   return false;
+}
+
+bool Sift::Reader::Seek(uint64_t icount)
+{
+   if (input == NULL)
+   {
+      if (!initStream())
+      {
+         std::cerr << "[SIFT:" << m_id << "] Error: initStream failed\n";
+         return false;
+      }
+   }
+
+   if (m_prefetch_running)
+   {
+      std::cerr << "[SIFT:" << m_id << "] Error: Cannot seek once read-ahead has started\n";
+      return false;
+   }
+   // Skipping over records would drop requests the recorder waits on
+   if (!m_input_is_file)
+   {
+      std::cerr << "[SIFT:" << m_id << "] Error: Can only seek in trace files\n";
+      return false;
+   }
+
+   if (m_blocks)
+   {
+      uint64_t block = m_blocks->findBlock(icount);
+      if (block >= m_blocks->getNumBlocks() || !m_blocks->seekBlock(block))
+      {
+         std::cerr << "[SIFT:" << m_id << "] Error: Cannot seek to instruction " << icount << "\n";
+         return false;
+      }
+      // Blocks do not depend on any state from earlier blocks
+      m_icount = m_blocks->getBlockIcount(block);
+      last_address = 0;
+      m_last_sinst = NULL;
+      m_isa = 0;
+      m_seen_end = false;
+   }
+   else if (icount < m_icount)
+   {
+      std::cerr << "[SIFT:" << m_id << "] Error: Cannot seek backwards in a trace without block index\n";
+      return false;
+   }
+
+   return skipInstructions(icount - m_icount);
+}
+
+bool Sift::Reader::skipInstructions(uint64_t count)
+{
+   while (count > 0 && !m_seen_end)
+   {
+      Record rec;
+      uint8_t byte = input->peek();
+      if (input->fail())
+         return false;
+
+      if (byte == 0)
+      {
+         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+         switch(rec.Other.type)
+         {
+            // Keep the state needed to decode the instructions that follow
+            case RecOtherIcache:
+            case RecOtherIcacheVariable:
+            case RecOtherLogical2Physical:
+            case RecOtherISAChange:
+            case RecOtherEnd:
+               handleOtherRecord(input, rec);
+               break;
+            default:
+            {
+               uint8_t *bytes = new uint8_t[rec.Other.size];
+               input->read(reinterpret_cast<char*>(bytes), rec.Other.size);
+               delete [] bytes;
+               break;
+            }
+         }
+      }
+      else
+      {
+         Instruction inst;
+         readInstruction(input, byte, inst);
+         --count;
+      }
+   }
+   return count == 0;
 }
 
 bool Sift::Reader::AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op, uint64_t d_addr, uint8_t *data_buffer, uint32_t data_size)
@@ -611,7 +965,28 @@ bool Sift::Reader::AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op,
    #endif
    uint64_t addr;
    MemoryOpType type;
-   input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+   vistream *in = input;
+   std::unique_ptr<uint8_t[]> payload_data;
+   imstream payload(NULL, 0);
+   if (m_prefetch_running)
+   {
+      PrefetchEntry &entry = nextPrefetched();
+      if (entry.kind != PrefetchOther)
+      {
+         std::cerr << "[SIFT:" << m_id << "] Error: Invalid response. Expected RecOtherMemoryResponse\n";
+         return false;
+      }
+      rec.Other.type = entry.type;
+      rec.Other.size = entry.size;
+      payload_data.reset(entry.payload);
+      entry.payload = NULL;
+      payload = imstream(payload_data.get(), entry.size);
+      in = &payload;
+   }
+   else
+   {
+      input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+   }
    #if VERBOSE_HEX > 0
    hexdump((char*)&rec, sizeof(rec.Other));
    #endif
@@ -620,8 +995,8 @@ bool Sift::Reader::AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op,
       std::cerr << "[SIFT:" << m_id << "] Error: Invalid response. Expected RecOtherMemoryResponse\n";
       return false;
    }
-   input->read(reinterpret_cast<char*>(&addr), sizeof(addr));
-   input->read(reinterpret_cast<char*>(&type), sizeof(type));
+   in->read(reinterpret_cast<char*>(&addr), sizeof(addr));
+   in->read(reinterpret_cast<char*>(&type), sizeof(type));
    #if VERBOSE_HEX > 0
    hexdump((char*)&addr, sizeof(addr));
    hexdump((char*)&type, sizeof(type));
@@ -644,7 +1019,7 @@ bool Sift::Reader::AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op,
 	 std::cerr << "[SIFT:" << m_id << "] Error: Invalid response. Expected payload size to match\n";
 	 return false;
       }
-      input->read(reinterpret_cast<char*>(data_buffer), data_size);
+      in->read(reinterpret_cast<char*>(data_buffer), data_size);
       #if VERBOSE_HEX > 0
       hexdump((char*)data_buffer, data_size);
       #endif
@@ -791,12 +1166,27 @@ void Sift::Reader::sendSimpleResponse(RecOtherType type, void *data, uint32_t si
 
 uint64_t Sift::Reader::getPosition()
 {
-   if (inputstream)
+   if (m_prefetch_running)
+      return m_prefetch_position;
+   else
+      return currentPosition();
+}
+
+uint64_t Sift::Reader::currentPosition()
+{
+   if (m_blocks)
+      return m_blocks->getPosition();
+   else if (inputstream)
       return inputstream->tellg();
    else
       return 0;
 }
 
+uint64_t Sift::Reader::getNumInstructions() const
+{
+   return m_blocks ? m_blocks->getIcount() : 0;
+}
+
 uint64_t Sift::Reader::getLength()
 {
    return filesize;
@@ -806,18 +1196,14 @@ uint64_t Sift::Reader::va2pa(uint64_t va)
 {
    if (m_trace_has_pa)
    {
-      intptr_t vp = va / PAGE_SIZE_SIFT;
-      intptr_t vo = va & (PAGE_SIZE_SIFT-1);
+      uint64_t vp = va / PAGE_SIZE_SIFT;
+      uint64_t vo = va & (PAGE_SIZE_SIFT-1);
+      uint64_t pp;
 
-      if (vcache.count(vp) == 0)
-      {
-         return 0;
-      }
-      else
-      {
-         intptr_t pp = vcache[vp];
+      if (vcache.lookup(vp, pp))
          return (pp * PAGE_SIZE_SIFT) | vo;
-      }
+      else
+         return 0;
    }
    else
    {
@@ -3,6 +3,8 @@
 
 #include "sift.h"
 #include "sift_format.h"
+#include "sift_utils.h"
+#include "sift_pagemap.h"
 
 //extern "C" {
 //#include "xed-interface.h"
@@ -11,9 +13,11 @@
 #include <unordered_map>
 #include <fstream>
 #include <cassert>
+#include <pthread.h>
 
 class vistream;
 class vostream;
+class iblockstream;
 
 namespace Sift
 {
@@ -28,6 +32,9 @@ namespace Sift
          uint8_t data[16];
          //xed_decoded_inst_t xed_inst;
          const StaticInstruction *next;
+         // Reader state for the AddressDelta encoding
+         mutable AddressPredictors predictors;
+         mutable uint64_t predictors_generation;
    };
 
    // Dynamic information
@@ -57,6 +64,34 @@ namespace Sift
       typedef void (*HandleRoutineAnnounce)(void* arg, uint64_t eip, const char *name, const char *imgname, uint64_t offset, uint32_t line, uint32_t column, const char *filename);
       typedef int32_t (*HandleForkFunc)(void* arg);
 
+      // Read-ahead: a helper thread decompresses and parses the trace into batches of ready records,
+      // and hands them to the simulation thread through a single-producer/single-consumer ring
+      static const uint32_t PREFETCH_BATCHES = 16;
+      static const uint32_t PREFETCH_BATCH_SIZE = 1024;
+
+      enum PrefetchKind
+      {
+         PrefetchInstruction,
+         PrefetchOther,
+         PrefetchFail,
+      };
+
+      struct PrefetchEntry
+      {
+         uint8_t kind;
+         uint8_t type;     // PrefetchOther: record type
+         uint32_t size;    // PrefetchOther: payload size
+         uint8_t *payload; // PrefetchOther: payload, NULL if size == 0
+         int error;        // PrefetchFail: errno
+         Instruction inst; // PrefetchInstruction
+      };
+
+      struct PrefetchBatch
+      {
+         uint32_t count;
+         PrefetchEntry entries[PREFETCH_BATCH_SIZE];
+      };
+
       private:
          vistream *input;
          vostream *response;
@@ -83,6 +118,10 @@ namespace Sift
          void *handleRoutineArg;
          uint64_t filesize;
          std::ifstream *inputstream;
+         iblockstream *m_blocks;
+         bool m_input_is_file;
+         uint64_t m_icount;
+         bool m_address_delta;
 
          char *m_filename;
          char *m_response_filename;
@@ -93,7 +132,7 @@ namespace Sift
          uint64_t last_address;
          std::unordered_map<uint64_t, const uint8_t*> icache;
          std::unordered_map<uint64_t, const StaticInstruction*> scache;
-         std::unordered_map<uint64_t, uint64_t> vcache;
+         PageMap vcache;
 
          uint32_t m_id;
 
@@ -103,12 +142,37 @@ namespace Sift
          
          int m_isa;
 
+         bool m_prefetch;
+         bool m_prefetch_running;
+         pthread_t m_prefetch_thread;
+         PrefetchBatch *m_prefetch_ring;
+         volatile uint64_t m_prefetch_head; // Batches published by the helper thread
+         volatile uint64_t m_prefetch_tail; // Batches released by the simulation thread
+         volatile uint64_t m_prefetch_position;
+         volatile bool m_prefetch_stop;
+         uint32_t m_prefetch_index;         // Next entry in the batch at m_prefetch_tail
+         uint32_t m_prefetch_count;         // Entries in the batch at m_prefetch_tail, 0 if we don't hold one
+         bool m_prefetch_failed;
+
          bool initResponse();
          const Sift::StaticInstruction* staticInfoInstruction(uint64_t addr, uint8_t size);
          const Sift::StaticInstruction* getStaticInstruction(uint64_t addr, uint8_t size);
          void sendSyscallResponse(uint64_t return_code);
          void sendEmuResponse(bool handled, EmuReply res);
          void sendSimpleResponse(RecOtherType type, void *data = NULL, uint32_t size = 0);
+         bool handleOtherRecord(vistream *in, Record &rec);
+         void readInstruction(vistream *in, uint8_t byte, Instruction &inst);
+         uint64_t readVarint(vistream *in);
+
+         bool skipInstructions(uint64_t count);
+         uint64_t currentPosition();
+
+         void startPrefetch();
+         static void* __prefetchThread(void *arg);
+         void prefetchThread();
+         static void prefetchWait(uint32_t &spins);
+         PrefetchEntry& nextPrefetched();
+         bool readPrefetched(Instruction &inst);
 
       public:
          Reader(const char *filename, const char *response_filename = "", uint32_t id = 0);
@@ -116,6 +180,15 @@ namespace Sift
          bool initStream();
          bool Read(Instruction&);
          bool AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op, uint64_t d_addr, uint8_t *data_buffer, uint32_t data_size);
+         // Parse the trace ahead of time on a helper thread. Only takes effect for regular (non-FIFO) trace files,
+         // must be called before the first Read().
+         void setPrefetch(bool enable) { m_prefetch = enable; }
+         // Continue reading at instruction number icount. Seekable traces jump straight to the block holding it,
+         // other trace files are read up to that point. Must be called before read-ahead starts on the first Read().
+         bool Seek(uint64_t icount);
+         bool isSeekable() const { return m_blocks != NULL; }
+         // Total number of instructions in a seekable trace, 0 if unknown
+         uint64_t getNumInstructions() const;
 
          void setHandleInstructionCountFunc(HandleInstructionCountFunc func, void* arg = NULL) { handleInstructionCountFunc = func; handleInstructionCountArg = arg; }
          void setHandleCacheOnlyFunc(HandleCacheOnlyFunc func, void* arg = NULL) { handleCacheOnlyFunc = func; handleCacheOnlyArg = arg; }
@@ -132,6 +205,8 @@ namespace Sift
          uint64_t getLength();
          bool getTraceHasPhysicalAddresses() const { return m_trace_has_pa; }
          uint64_t va2pa(uint64_t va);
+         // Translations received from the trace (if it has physical addresses), with their hit counters
+         PageMap& getPageMap() { return vcache; }
    };
 };
 
@@ -6,6 +6,39 @@
 namespace Sift
 {
    void hexdump(const void * data, uint32_t size);
+
+   // Stride prediction for one memory operand of a static instruction (AddressDelta option)
+   struct AddressPredictor
+   {
+      uint64_t last;
+      uint64_t stride;
+      uint64_t predict() const { return last + stride; }
+      void update(uint64_t address) { stride = address - last; last = address; }
+   };
+
+   struct AddressPredictors
+   {
+      AddressPredictor operands[MAX_DYNAMIC_ADDRESSES];
+   };
+
+   // Zig-zag encoding maps small negative and positive differences to small unsigned numbers
+   inline uint64_t zigzagEncode(uint64_t value) { return (value << 1) ^ -(value >> 63); }
+   inline uint64_t zigzagDecode(uint64_t value) { return (value >> 1) ^ -(value & 1); }
+
+   const uint32_t MAX_VARINT_SIZE = 10;
+
+   // Write value as an LEB128 varint into buffer, return the number of bytes used
+   inline uint32_t encodeVarint(uint64_t value, uint8_t *buffer)
+   {
+      uint32_t size = 0;
+      while (value >= 0x80)
+      {
+         buffer[size++] = uint8_t(value) | 0x80;
+         value >>= 7;
+      }
+      buffer[size++] = uint8_t(value);
+      return size;
+   }
 };
 
 #endif // __SIFT_UTILS_H
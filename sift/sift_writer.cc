@@ -35,7 +35,7 @@ __sift_assert_fail(__const char *__assertion, __const char *__file,
 }
 
 
-Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping, GetCodeFunc2 getCodeFunc2, void* getCodeFunc2Data)
+Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression, const char *response_filename, uint32_t id, bool arch32, bool requires_icache_per_insn, bool send_va2pa_mapping, GetCodeFunc2 getCodeFunc2, void* getCodeFunc2Data, uint64_t block_instructions, uint64_t compression, bool address_delta)
    : response(NULL)
    , getCodeFunc(getCodeFunc)
    , getCodeFunc2(getCodeFunc2)
@@ -52,6 +52,10 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
    , m_id(id)
    , m_requires_icache_per_insn(requires_icache_per_insn)
    , m_send_va2pa_mapping(send_va2pa_mapping)
+   , m_block_output(NULL)
+   , m_block_instructions(block_instructions)
+   , m_isa(0)
+   , m_address_delta(address_delta)
 {
    memset(hsize, 0, sizeof(hsize));
    memset(haddr, 0, sizeof(haddr));
@@ -59,20 +63,38 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
    m_response_filename = strdup(response_filename);
 
    uint64_t options = 0;
-#if SIFT_USE_ZLIB
    if (useCompression)
-      options |= CompressionZlib;
-#else
-   if (useCompression) {
-      std::cerr << "[SIFT:" << m_id << "] Warning: Compression disabled, ignoring request.\n";
+   {
+      if ((compression == CompressionZlib && SIFT_USE_ZLIB)
+         || (compression == CompressionLz4 && SIFT_USE_LZ4)
+         || (compression == CompressionZstd && SIFT_USE_ZSTD))
+      {
+         options |= compression;
+      }
+      else
+      {
+         std::cerr << "[SIFT:" << m_id << "] Warning: Compression disabled, ignoring request.\n";
+      }
    }
-#endif
+   if (address_delta)
+      options |= AddressDelta;
    if (arch32)
       options |= ArchIA32;
    if (requires_icache_per_insn)
       options |= IcacheVariable;
    if (m_send_va2pa_mapping)
       options |= PhysicalAddress;
+   if (m_block_instructions)
+   {
+      // Blocks are only written out once they are complete, so nothing can wait for a response
+      if (strcmp(response_filename, "") != 0)
+      {
+         std::cerr << "[SIFT:" << m_id << "] Warning: Seekable traces cannot be used with response files, ignoring request.\n";
+         m_block_instructions = 0;
+      }
+      else
+         options |= SeekableBlocks;
+   }
 
    output = new vofstream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
 
@@ -91,8 +113,14 @@ Sift::Writer::Writer(const char *filename, GetCodeFunc getCodeFunc, bool useComp
    output->write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
    output->flush();
 
-   if (options & CompressionZlib)
+   if (options & SeekableBlocks)
+      output = m_block_output = new oblockstream(output, sizeof(hdr), options & CompressionMask);
+   else if (options & CompressionZlib)
       output = new ozstream(output);
+   else if (options & CompressionLz4)
+      output = new olz4stream(output);
+   else if (options & CompressionZstd)
+      output = new ozstdstream(output);
 }
 
 // Modified from http://stackoverflow.com/questions/2203159/is-there-a-c-equivalent-to-getcwd
@@ -126,6 +154,8 @@ void Sift::Writer::End()
       rec.Other.size = 0;
       output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
       output->flush();
+      if (m_block_output)
+         m_block_output->close(ninstrs);
    }
 
    if (response)
@@ -149,6 +179,7 @@ void Sift::Writer::End()
    {
       delete output;
       output = NULL;
+      m_block_output = NULL;
    }
 }
 
@@ -180,6 +211,9 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
       return;
    }
 
+   if (m_block_output && ninstrs - m_block_output->getBlockIcount() >= m_block_instructions)
+      newBlock();
+
    if (m_requires_icache_per_insn)
    {
       if (! icache[addr])
@@ -295,8 +329,24 @@ void Sift::Writer::Instruction(uint64_t addr, uint8_t size, uint8_t num_addresse
       ninstrext++;
    }
 
-   for(int i = 0; i < num_addresses; ++i)
-      output->write(reinterpret_cast<char*>(&addresses[i]), sizeof(uint64_t));
+   if (m_address_delta)
+   {
+      AddressPredictors &predictors = m_address_predictors[addr];
+      uint8_t buffer[MAX_DYNAMIC_ADDRESSES * MAX_VARINT_SIZE];
+      uint32_t length = 0;
+      for(int i = 0; i < num_addresses; ++i)
+      {
+         AddressPredictor &predictor = predictors.operands[i];
+         length += encodeVarint(zigzagEncode(addresses[i] - predictor.predict()), buffer + length);
+         predictor.update(addresses[i]);
+      }
+      output->write(reinterpret_cast<char*>(buffer), length);
+   }
+   else
+   {
+      for(int i = 0; i < num_addresses; ++i)
+         output->write(reinterpret_cast<char*>(&addresses[i]), sizeof(uint64_t));
+   }
 
    last_address += size;
 
@@ -889,6 +939,26 @@ void Sift::Writer::ISAChange(uint32_t new_isa)
 
    output->write(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
    output->write(reinterpret_cast<char*>(&new_isa), sizeof(new_isa));
+
+   m_isa = new_isa;
+}
+
+void Sift::Writer::newBlock()
+{
+   #if VERBOSE > 0
+   std::cerr << "[DEBUG:" << m_id << "] Write new block at instruction " << ninstrs << std::endl;
+   #endif
+
+   m_block_output->newBlock(ninstrs);
+
+   // Make the new block decodable on its own: start with a full instruction,
+   // and send code and address mappings again when they are first used
+   last_address = 0;
+   icache.clear();
+   m_va2pa.clear();
+   m_address_predictors.clear();
+   if (m_isa)
+      ISAChange(m_isa);
 }
 
 bool Sift::Writer::IsOpen()
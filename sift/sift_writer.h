@@ -3,6 +3,7 @@
 
 #include "sift.h"
 #include "sift_format.h"
+#include "sift_utils.h"
 
 #include <unordered_map>
 #include <fstream>
@@ -10,6 +11,7 @@
 
 class vistream;
 class vostream;
+class oblockstream;
 
 namespace Sift
 {
@@ -37,14 +39,20 @@ namespace Sift
          uint32_t m_id;
          bool m_requires_icache_per_insn;
          bool m_send_va2pa_mapping;
+         oblockstream *m_block_output;
+         uint64_t m_block_instructions;
+         uint32_t m_isa;
+         bool m_address_delta;
+         std::unordered_map<uint64_t, AddressPredictors> m_address_predictors;
 
          void initResponse();
          void handleMemoryRequest(Record &respRec);
          void send_va2pa(uint64_t va);
          uint64_t va2pa_lookup(uint64_t va);
+         void newBlock();
 
       public:
-         Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression = false, const char *response_filename = "", uint32_t id = 0, bool arch32 = false, bool requires_icache_per_insn = false, bool send_va2pa_mapping = false, GetCodeFunc2 getCodeFunc2 = NULL, void *GetCodeFunc2Data = NULL);
+         Writer(const char *filename, GetCodeFunc getCodeFunc, bool useCompression = false, const char *response_filename = "", uint32_t id = 0, bool arch32 = false, bool requires_icache_per_insn = false, bool send_va2pa_mapping = false, GetCodeFunc2 getCodeFunc2 = NULL, void *GetCodeFunc2Data = NULL, uint64_t block_instructions = 0, uint64_t compression = CompressionZlib, bool address_delta = false);
          ~Writer();
          void End();
          void Instruction(uint64_t addr, uint8_t size, uint8_t num_addresses, uint64_t addresses[], bool is_branch, bool taken, bool is_predicate, bool executed);
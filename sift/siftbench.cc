@@ -0,0 +1,240 @@
+#define __STDC_FORMAT_MACROS
+
+// Compare SIFT encodings: trace size and decode speed of every supported codec, with and without AddressDelta.
+//
+// Usage: siftbench [-n <instructions>] [-o <directory>] [<file.sift>]
+//
+// Instructions are taken from the given trace, or generated when no trace is given.
+
+#include "sift_reader.h"
+#include "sift_writer.h"
+
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+struct BenchInstruction
+{
+   uint64_t addr;
+   uint8_t size;
+   uint8_t num_addresses;
+   bool is_branch;
+   bool taken;
+   uint64_t addresses[Sift::MAX_DYNAMIC_ADDRESSES];
+};
+
+struct Format
+{
+   const char *name;
+   bool compress;
+   uint64_t compression;
+   bool address_delta;
+};
+
+static std::unordered_map<uint64_t, std::vector<uint8_t> > code_pages;
+
+static void getCode(uint8_t *dst, const uint8_t *src, uint32_t size)
+{
+   uint64_t addr = reinterpret_cast<uint64_t>(src);
+   for(uint32_t i = 0; i < size; ++i, ++addr)
+   {
+      auto it = code_pages.find(addr & Sift::ICACHE_PAGE_MASK);
+      dst[i] = it == code_pages.end() ? 0 : it->second[addr & Sift::ICACHE_OFFSET_MASK];
+   }
+}
+
+static void addCode(uint64_t addr, const uint8_t *data, uint8_t size)
+{
+   for(uint8_t i = 0; i < size; ++i, ++addr)
+   {
+      std::vector<uint8_t> &page = code_pages[addr & Sift::ICACHE_PAGE_MASK];
+      if (page.empty())
+         page.resize(Sift::ICACHE_SIZE);
+      page[addr & Sift::ICACHE_OFFSET_MASK] = data[i];
+   }
+}
+
+static double now()
+{
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static uint64_t fileSize(const std::string &filename)
+{
+   struct stat filestatus;
+   return stat(filename.c_str(), &filestatus) == 0 ? filestatus.st_size : 0;
+}
+
+static void loadTrace(const char *filename, uint64_t max_instructions, std::vector<BenchInstruction> &instructions)
+{
+   Sift::Reader reader(filename);
+   Sift::Instruction inst;
+   while(instructions.size() < max_instructions && reader.Read(inst))
+   {
+      BenchInstruction bi;
+      bi.addr = inst.sinst->addr;
+      bi.size = inst.sinst->size;
+      bi.num_addresses = inst.num_addresses;
+      bi.is_branch = inst.is_branch;
+      bi.taken = inst.taken;
+      for(int i = 0; i < inst.num_addresses; ++i)
+         bi.addresses[i] = inst.addresses[i];
+      instructions.push_back(bi);
+      addCode(bi.addr, inst.sinst->data, bi.size);
+   }
+}
+
+// A loop nest with streaming, strided, stack and irregular memory accesses
+static void generateTrace(uint64_t num_instructions, std::vector<BenchInstruction> &instructions)
+{
+   const uint64_t code_base = 0x400000, loop_size = 48;
+   uint64_t seed = 1;
+   uint64_t iteration = 0;
+   while(instructions.size() < num_instructions)
+   {
+      for(uint64_t i = 0; i < loop_size && instructions.size() < num_instructions; ++i)
+      {
+         BenchInstruction bi;
+         bi.addr = code_base + 4 * i;
+         bi.size = 4;
+         bi.is_branch = (i == loop_size - 1);
+         bi.taken = bi.is_branch && (iteration % 1000 != 999);
+         bi.num_addresses = 0;
+         switch(i % 6)
+         {
+            case 0: // Streaming load
+               bi.addresses[bi.num_addresses++] = 0x10000000 + 8 * iteration;
+               break;
+            case 1: // Strided load and store
+               bi.addresses[bi.num_addresses++] = 0x20000000 + 64 * iteration + 8 * (i % 8);
+               bi.addresses[bi.num_addresses++] = 0x30000000 + 256 * iteration;
+               break;
+            case 2: // Stack access
+               bi.addresses[bi.num_addresses++] = 0x7fff0000 - 8 * (i % 4);
+               break;
+            case 3: // Irregular access
+               seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+               bi.addresses[bi.num_addresses++] = 0x40000000 + ((seed >> 20) & 0xffffff8);
+               break;
+         }
+         instructions.push_back(bi);
+         uint8_t code[4] = { uint8_t(0x48), uint8_t(0x8b), uint8_t(i), uint8_t(i >> 8) };
+         addCode(bi.addr, code, bi.size);
+      }
+      ++iteration;
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   uint64_t max_instructions = 10000000;
+   const char *directory = "/tmp";
+   const char *filename = NULL;
+   for(int i = 1; i < argc; ++i)
+   {
+      if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+         max_instructions = strtoull(argv[++i], NULL, 0);
+      else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+         directory = argv[++i];
+      else if (argv[i][0] == '-')
+      {
+         printf("Usage: %s [-n <instructions>] [-o <directory>] [<file.sift>]\n", argv[0]);
+         return 1;
+      }
+      else
+         filename = argv[i];
+   }
+
+   std::vector<BenchInstruction> instructions;
+   if (filename)
+      loadTrace(filename, max_instructions, instructions);
+   else
+      generateTrace(max_instructions, instructions);
+   if (instructions.empty())
+   {
+      fprintf(stderr, "No instructions\n");
+      return 1;
+   }
+
+   const Format formats[] = {
+      { "raw",        false, 0,                     false },
+      { "delta",      false, 0,                     true },
+#if SIFT_USE_ZLIB
+      { "zlib",       true,  Sift::CompressionZlib, false },
+      { "zlib+delta", true,  Sift::CompressionZlib, true },
+#endif
+#if SIFT_USE_LZ4
+      { "lz4",        true,  Sift::CompressionLz4,  false },
+      { "lz4+delta",  true,  Sift::CompressionLz4,  true },
+#endif
+#if SIFT_USE_ZSTD
+      { "zstd",       true,  Sift::CompressionZstd, false },
+      { "zstd+delta", true,  Sift::CompressionZstd, true },
+#endif
+   };
+
+   uint64_t expected_checksum = 0;
+   for(BenchInstruction &bi : instructions)
+      for(int i = 0; i < bi.num_addresses; ++i)
+         expected_checksum += bi.addresses[i];
+
+   printf("%" PRIu64 " instructions\n", (uint64_t)instructions.size());
+   printf("%-12s %14s %10s %12s %12s %12s\n", "format", "bytes", "bytes/ins", "encode MB/s", "decode MB/s", "decode MIPS");
+
+   // MB/s are relative to the size of the raw (uncompressed, absolute addresses) trace
+   uint64_t raw_size = 0;
+   for(const Format &format : formats)
+   {
+      std::string tracefile = std::string(directory) + "/siftbench." + std::to_string(getpid()) + "." + format.name + ".sift";
+
+      double start = now();
+      {
+         Sift::Writer writer(tracefile.c_str(), getCode, format.compress, "", 0, false, false, false, NULL, NULL, 0, format.compression, format.address_delta);
+         if (!writer.IsOpen())
+         {
+            fprintf(stderr, "Cannot create %s\n", tracefile.c_str());
+            return 1;
+         }
+         for(BenchInstruction &bi : instructions)
+            writer.Instruction(bi.addr, bi.size, bi.num_addresses, bi.addresses, bi.is_branch, bi.taken, false, true);
+         writer.End();
+      }
+      double encode_time = now() - start;
+      uint64_t size = fileSize(tracefile);
+      if (!raw_size)
+         raw_size = size;
+
+      start = now();
+      uint64_t icount = 0, checksum = 0;
+      {
+         Sift::Reader reader(tracefile.c_str());
+         Sift::Instruction inst;
+         while(reader.Read(inst))
+         {
+            ++icount;
+            for(int i = 0; i < inst.num_addresses; ++i)
+               checksum += inst.addresses[i];
+         }
+      }
+      double decode_time = now() - start;
+      unlink(tracefile.c_str());
+
+      if (icount != instructions.size() || checksum != expected_checksum)
+      {
+         fprintf(stderr, "%s: trace does not match, read %" PRIu64 " of %" PRIu64 " instructions\n", format.name, icount, (uint64_t)instructions.size());
+         return 1;
+      }
+
+      printf("%-12s %14" PRIu64 " %10.2f %12.1f %12.1f %12.1f\n", format.name, size, double(size) / icount,
+         raw_size / encode_time / 1e6, raw_size / decode_time / 1e6, icount / decode_time / 1e6);
+   }
+}
@@ -6,6 +6,7 @@
 #include <cassert>
 #include <cstdio>
 #include <cstring>
+#include <cstdlib>
 #include <map>
 #include <unordered_map>
 
@@ -17,9 +18,24 @@ extern "C" {
 
 int main(int argc, char* argv[])
 {
-   if (argc > 1 && strcmp(argv[1], "-d") == 0)
+   bool disasm = false;
+   uint64_t start = 0;
+   const char *filename = NULL;
+   for(int i = 1; i < argc; ++i)
    {
-      Sift::Reader reader(argv[2]);
+      if (strcmp(argv[i], "-d") == 0)
+         disasm = true;
+      else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+         start = strtoull(argv[++i], NULL, 0);
+      else
+         filename = argv[i];
+   }
+
+   if (filename && disasm)
+   {
+      Sift::Reader reader(filename);
+      if (start && !reader.Seek(start))
+         return 1;
       //const xed_syntax_enum_t syntax = XED_SYNTAX_ATT;
 
       uint64_t icount = 0;
@@ -65,9 +81,11 @@ int main(int argc, char* argv[])
          eip_last = it->first + it->second->size;
       }
    }
-   else if (argc > 1)
+   else if (filename)
    {
-      Sift::Reader reader(argv[1]);
+      Sift::Reader reader(filename);
+      if (start && !reader.Seek(start))
+         return 1;
       //const xed_syntax_enum_t syntax = XED_SYNTAX_ATT;
 
       Sift::Instruction inst;
@@ -100,6 +118,6 @@ int main(int argc, char* argv[])
    }
    else
    {
-      printf("Usage: %s [-d] <file.sift>\n", argv[0]);
+      printf("Usage: %s [-d] [-s <start instruction>] <file.sift>\n", argv[0]);
    }
 }
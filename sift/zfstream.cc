@@ -1,6 +1,11 @@
 #include "zfstream.h"
 
 #include <cassert>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #if !SIFT_USE_ZLIB
 
@@ -160,3 +165,483 @@ int izstream::peek()
 }
 
 #endif /*SIFT_USE_ZLIB*/
+
+#if SIFT_USE_LZ4
+
+olz4stream::olz4stream(vostream *output)
+   : output(output)
+{
+   LZ4F_errorCode_t ret = LZ4F_createCompressionContext(&cctx, LZ4F_VERSION);
+   assert(!LZ4F_isError(ret));
+   buffer.resize(LZ4F_compressBound(chunksize, NULL));
+   size_t size = LZ4F_compressBegin(cctx, buffer.data(), buffer.size(), NULL);
+   assert(!LZ4F_isError(size));
+   output->write(buffer.data(), size);
+}
+
+olz4stream::~olz4stream()
+{
+   size_t size = LZ4F_compressEnd(cctx, buffer.data(), buffer.size(), NULL);
+   assert(!LZ4F_isError(size));
+   output->write(buffer.data(), size);
+   LZ4F_freeCompressionContext(cctx);
+   delete output;
+}
+
+void olz4stream::write(const char* s, std::streamsize n)
+{
+   while (n > 0)
+   {
+      size_t amount = std::min(size_t(n), chunksize);
+      size_t size = LZ4F_compressUpdate(cctx, buffer.data(), buffer.size(), s, amount, NULL);
+      assert(!LZ4F_isError(size));
+      output->write(buffer.data(), size);
+      s += amount;
+      n -= amount;
+   }
+}
+
+ilz4stream::ilz4stream(vistream *input)
+   : input(input)
+   , m_eof(false)
+   , m_fail(false)
+   , in_pos(0)
+   , in_size(0)
+   , peek_valid(false)
+{
+   LZ4F_errorCode_t ret = LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION);
+   assert(!LZ4F_isError(ret));
+}
+
+ilz4stream::~ilz4stream()
+{
+   LZ4F_freeDecompressionContext(dctx);
+   delete input;
+}
+
+void ilz4stream::read(char* s, std::streamsize n)
+{
+   if (peek_valid)
+   {
+      s[0] = peek_value;
+      peek_valid = false;
+      ++s;
+      --n;
+   }
+
+   while (n > 0)
+   {
+      if (m_eof)
+      {
+         m_fail = true;
+         return;
+      }
+      if (in_pos == in_size)
+      {
+         input->read(buffer, chunksize);
+         in_pos = 0;
+         in_size = chunksize;
+      }
+      size_t out_size = n, src_size = in_size - in_pos;
+      size_t ret = LZ4F_decompress(dctx, s, &out_size, buffer + in_pos, &src_size, NULL);
+      if (LZ4F_isError(ret))
+      {
+         m_fail = true;
+         return;
+      }
+      in_pos += src_size;
+      s += out_size;
+      n -= out_size;
+      if (ret == 0)
+         m_eof = true;
+   }
+}
+
+int ilz4stream::peek()
+{
+   if (peek_valid == true)
+      return peek_value;
+
+   read(&peek_value, 1);
+   peek_valid = true;
+
+   return peek_value;
+}
+
+#else /*SIFT_USE_LZ4*/
+
+olz4stream::olz4stream(vostream *output) : output(output) { assert(false); }
+olz4stream::~olz4stream() {}
+void olz4stream::write(const char* s, std::streamsize n) {}
+ilz4stream::ilz4stream(vistream *input) : input(input), m_eof(false), m_fail(true), peek_valid(false) {}
+ilz4stream::~ilz4stream() {}
+void ilz4stream::read(char* s, std::streamsize n) {}
+int ilz4stream::peek() { return 0; }
+
+#endif /*SIFT_USE_LZ4*/
+
+#if SIFT_USE_ZSTD
+
+ozstdstream::ozstdstream(vostream *output)
+   : output(output)
+{
+   cctx = ZSTD_createCCtx();
+   assert(cctx);
+   ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+}
+
+ozstdstream::~ozstdstream()
+{
+   doCompress(NULL, 0, true);
+   ZSTD_freeCCtx(cctx);
+   delete output;
+}
+
+void ozstdstream::write(const char* s, std::streamsize n)
+{
+   doCompress(s, n, false);
+}
+
+void ozstdstream::doCompress(const char* s, size_t n, bool finish)
+{
+   ZSTD_inBuffer in = { s, n, 0 };
+   size_t remaining;
+   do
+   {
+      ZSTD_outBuffer out = { buffer, chunksize, 0 };
+      remaining = ZSTD_compressStream2(cctx, &out, &in, finish ? ZSTD_e_end : ZSTD_e_continue);
+      assert(!ZSTD_isError(remaining));
+      output->write(buffer, out.pos);
+   } while (finish ? remaining != 0 : in.pos < in.size);
+}
+
+izstdstream::izstdstream(vistream *input)
+   : input(input)
+   , m_eof(false)
+   , m_fail(false)
+   , in_pos(0)
+   , in_size(0)
+   , peek_valid(false)
+{
+   dctx = ZSTD_createDCtx();
+   assert(dctx);
+}
+
+izstdstream::~izstdstream()
+{
+   ZSTD_freeDCtx(dctx);
+   delete input;
+}
+
+void izstdstream::read(char* s, std::streamsize n)
+{
+   if (peek_valid)
+   {
+      s[0] = peek_value;
+      peek_valid = false;
+      ++s;
+      --n;
+   }
+
+   ZSTD_outBuffer out = { s, size_t(n), 0 };
+   while (out.pos < out.size)
+   {
+      if (m_eof)
+      {
+         m_fail = true;
+         return;
+      }
+      if (in_pos == in_size)
+      {
+         input->read(buffer, chunksize);
+         in_pos = 0;
+         in_size = chunksize;
+      }
+      ZSTD_inBuffer in = { buffer, in_size, in_pos };
+      size_t ret = ZSTD_decompressStream(dctx, &out, &in);
+      if (ZSTD_isError(ret))
+      {
+         m_fail = true;
+         return;
+      }
+      in_pos = in.pos;
+      if (ret == 0)
+         m_eof = true;
+   }
+}
+
+int izstdstream::peek()
+{
+   if (peek_valid == true)
+      return peek_value;
+
+   read(&peek_value, 1);
+   peek_valid = true;
+
+   return peek_value;
+}
+
+#else /*SIFT_USE_ZSTD*/
+
+ozstdstream::ozstdstream(vostream *output) : output(output) { assert(false); }
+ozstdstream::~ozstdstream() {}
+void ozstdstream::write(const char* s, std::streamsize n) {}
+izstdstream::izstdstream(vistream *input) : input(input), m_eof(false), m_fail(true), peek_valid(false) {}
+izstdstream::~izstdstream() {}
+void izstdstream::read(char* s, std::streamsize n) {}
+int izstdstream::peek() { return 0; }
+
+#endif /*SIFT_USE_ZSTD*/
+
+size_t compressBlock(uint64_t codec, const char *data, size_t size, std::vector<char> &output)
+{
+   switch(codec)
+   {
+#if SIFT_USE_ZLIB
+      case Sift::CompressionZlib:
+      {
+         uLongf csize = compressBound(size);
+         output.resize(csize);
+         int ret = compress2((Bytef*)output.data(), &csize, (const Bytef*)data, size, Z_DEFAULT_COMPRESSION);
+         assert(ret == Z_OK);
+         return csize;
+      }
+#endif
+#if SIFT_USE_LZ4
+      case Sift::CompressionLz4:
+      {
+         output.resize(LZ4_compressBound(size));
+         int csize = LZ4_compress_default(data, output.data(), size, output.size());
+         assert(csize > 0);
+         return csize;
+      }
+#endif
+#if SIFT_USE_ZSTD
+      case Sift::CompressionZstd:
+      {
+         output.resize(ZSTD_compressBound(size));
+         size_t csize = ZSTD_compress(output.data(), output.size(), data, size, ozstdstream::level);
+         assert(!ZSTD_isError(csize));
+         return csize;
+      }
+#endif
+      default:
+         assert(false);
+         return size;
+   }
+}
+
+bool decompressBlock(uint64_t codec, const char *data, size_t csize, char *output, size_t size)
+{
+   switch(codec)
+   {
+#if SIFT_USE_ZLIB
+      case Sift::CompressionZlib:
+      {
+         uLongf dsize = size;
+         return uncompress((Bytef*)output, &dsize, (const Bytef*)data, csize) == Z_OK && dsize == size;
+      }
+#endif
+#if SIFT_USE_LZ4
+      case Sift::CompressionLz4:
+         return LZ4_decompress_safe(data, output, csize, size) == int(size);
+#endif
+#if SIFT_USE_ZSTD
+      case Sift::CompressionZstd:
+         return ZSTD_decompress(output, size, data, csize) == size;
+#endif
+      default:
+         return false;
+   }
+}
+
+oblockstream::oblockstream(vostream *output, uint64_t offset, uint64_t codec)
+   : output(output)
+   , codec(codec)
+   , closed(false)
+   , offset(offset)
+   , block_icount(0)
+{
+}
+
+oblockstream::~oblockstream()
+{
+   close(block_icount);
+   delete output;
+}
+
+void oblockstream::writeBlock()
+{
+   Sift::BlockHeader hdr;
+   hdr.size = buffer.size();
+   hdr.compressed_size = hdr.size;
+   hdr.icount = block_icount;
+
+   const char *block_data = buffer.data();
+   if (codec)
+   {
+      size_t csize = compressBlock(codec, buffer.data(), buffer.size(), cbuffer);
+      // Store blocks that do not compress as-is, so the reader can use them in place
+      if (csize < buffer.size())
+      {
+         hdr.compressed_size = csize;
+         block_data = cbuffer.data();
+      }
+   }
+
+   Sift::BlockIndexEntry entry = { block_icount, offset };
+   index.push_back(entry);
+
+   output->write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   output->write(block_data, hdr.compressed_size);
+   offset += sizeof(hdr) + hdr.compressed_size;
+   buffer.clear();
+}
+
+void oblockstream::newBlock(uint64_t icount)
+{
+   if (!buffer.empty())
+      writeBlock();
+   block_icount = icount;
+}
+
+void oblockstream::close(uint64_t icount)
+{
+   if (closed)
+      return;
+   closed = true;
+
+   if (!buffer.empty())
+      writeBlock();
+
+   Sift::BlockFooter footer;
+   footer.index_offset = offset;
+   footer.num_blocks = index.size();
+   footer.icount = icount;
+   footer.magic = Sift::BlockFooterMagic;
+   footer.reserved = 0;
+   output->write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Sift::BlockIndexEntry));
+   output->write(reinterpret_cast<char*>(&footer), sizeof(footer));
+   output->flush();
+}
+
+iblockstream::iblockstream(const char *filename, uint64_t codec)
+   : codec(codec)
+   , data(NULL)
+   , length(0)
+   , index(NULL)
+   , num_blocks(0)
+   , icount(0)
+   , block(0)
+   , block_data(NULL)
+   , block_size(0)
+   , block_offset(0)
+   , generation(0)
+   , m_fail(true)
+{
+   int fd = open(filename, O_RDONLY);
+   if (fd < 0)
+      return;
+   struct stat filestatus;
+   if (fstat(fd, &filestatus) == 0 && uint64_t(filestatus.st_size) >= sizeof(Sift::BlockFooter))
+   {
+      void *ptr = mmap(NULL, filestatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr != MAP_FAILED)
+      {
+         data = static_cast<const char*>(ptr);
+         length = filestatus.st_size;
+      }
+   }
+   ::close(fd);
+   if (!data)
+      return;
+
+   madvise(const_cast<char*>(data), length, MADV_SEQUENTIAL);
+
+   const Sift::BlockFooter *footer = reinterpret_cast<const Sift::BlockFooter*>(data + length - sizeof(Sift::BlockFooter));
+   if (footer->magic != Sift::BlockFooterMagic
+      || footer->index_offset + footer->num_blocks * sizeof(Sift::BlockIndexEntry) + sizeof(Sift::BlockFooter) != length)
+      return;
+
+   index = reinterpret_cast<const Sift::BlockIndexEntry*>(data + footer->index_offset);
+   num_blocks = footer->num_blocks;
+   icount = footer->icount;
+   m_fail = !loadBlock(0) && num_blocks > 0;
+}
+
+iblockstream::~iblockstream()
+{
+   if (data)
+      munmap(const_cast<char*>(data), length);
+}
+
+bool iblockstream::loadBlock(uint64_t b)
+{
+   ++generation;
+   block = b;
+   block_data = NULL;
+   block_size = 0;
+   block_offset = 0;
+   if (b >= num_blocks)
+      return false;
+
+   const Sift::BlockHeader *hdr = reinterpret_cast<const Sift::BlockHeader*>(data + index[b].offset);
+   const char *payload = data + index[b].offset + sizeof(Sift::BlockHeader);
+   if (payload + hdr->compressed_size > data + length)
+      return false;
+
+   if (hdr->compressed_size == hdr->size)
+   {
+      block_data = payload;
+   }
+   else
+   {
+      buffer.resize(hdr->size);
+      if (!decompressBlock(codec, payload, hdr->compressed_size, buffer.data(), hdr->size))
+         return false;
+      block_data = buffer.data();
+   }
+   block_size = hdr->size;
+   return true;
+}
+
+uint64_t iblockstream::findBlock(uint64_t icount) const
+{
+   // First block starting after icount, the one before it contains icount
+   const Sift::BlockIndexEntry *it = std::upper_bound(index, index + num_blocks, icount,
+      [](uint64_t icount, const Sift::BlockIndexEntry &entry) { return icount < entry.icount; });
+   return it == index ? 0 : (it - index) - 1;
+}
+
+bool iblockstream::seekBlock(uint64_t b)
+{
+   m_fail = !loadBlock(b);
+   return !m_fail;
+}
+
+void iblockstream::read(char* s, std::streamsize n)
+{
+   while (n > 0)
+   {
+      if (block_offset == block_size && !loadBlock(block + 1))
+      {
+         m_fail = true;
+         return;
+      }
+      uint32_t amount = std::min(uint64_t(n), uint64_t(block_size - block_offset));
+      memcpy(s, block_data + block_offset, amount);
+      block_offset += amount;
+      s += amount;
+      n -= amount;
+   }
+}
+
+int iblockstream::peek()
+{
+   if (block_offset == block_size && !loadBlock(block + 1))
+   {
+      m_fail = true;
+      return EOF;
+   }
+   return (unsigned char)block_data[block_offset];
+}
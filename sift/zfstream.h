@@ -6,10 +6,20 @@
 #include <ostream>
 #include <istream>
 #include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <vector>
 
 #if SIFT_USE_ZLIB
 # include <zlib.h>
 #endif
+#if SIFT_USE_LZ4
+# include <lz4.h>
+# include <lz4frame.h>
+#endif
+#if SIFT_USE_ZSTD
+# include <zstd.h>
+#endif
 
 class vostream
 {
@@ -63,8 +73,87 @@ class ozstream : public vostream
       virtual bool is_open()
          { return output->is_open(); }
 };
+class olz4stream : public vostream
+{
+   private:
+      vostream *output;
+#if SIFT_USE_LZ4
+      LZ4F_cctx *cctx;
+#endif
+      static const size_t chunksize = 64*1024;
+      std::vector<char> buffer;
+   public:
+      olz4stream(vostream *output);
+      virtual ~olz4stream();
+      virtual void write(const char* s, std::streamsize n);
+      virtual void flush()
+         { output->flush(); }
+      virtual bool fail()
+         { return output->fail(); }
+      virtual bool is_open()
+         { return output->is_open(); }
+};
+
+class ozstdstream : public vostream
+{
+   private:
+      vostream *output;
+#if SIFT_USE_ZSTD
+      ZSTD_CCtx *cctx;
+#endif
+      static const size_t chunksize = 64*1024;
+      char buffer[chunksize];
+      void doCompress(const char* s, size_t n, bool finish);
+   public:
+      static const int level = 3;
+      ozstdstream(vostream *output);
+      virtual ~ozstdstream();
+      virtual void write(const char* s, std::streamsize n);
+      virtual void flush()
+         { output->flush(); }
+      virtual bool fail()
+         { return output->fail(); }
+      virtual bool is_open()
+         { return output->is_open(); }
+};
+
+// Compress a SeekableBlocks block with codec (one of the Compression* options), return the compressed size
+size_t compressBlock(uint64_t codec, const char *data, size_t size, std::vector<char> &output);
+bool decompressBlock(uint64_t codec, const char *data, size_t csize, char *output, size_t size);
 
+// Writes the SeekableBlocks container (see sift_format.h). Data is collected until newBlock() closes
+// the current block; the last block, block index and footer are written on close() or destruction.
+class oblockstream : public vostream
+{
+   private:
+      vostream *output;
+      uint64_t codec;
+      bool closed;
+      uint64_t offset;
+      uint64_t block_icount;
+      std::vector<char> buffer;
+      std::vector<char> cbuffer;
+      std::vector<Sift::BlockIndexEntry> index;
+      void writeBlock();
+   public:
+      // offset: file offset at which the first block will be written, codec: Compression* option or 0
+      oblockstream(vostream *output, uint64_t offset, uint64_t codec);
+      virtual ~oblockstream();
+      virtual void write(const char* s, std::streamsize n)
+         { buffer.insert(buffer.end(), s, s + n); }
+      // Blocks are only written out as a whole
+      virtual void flush() {}
+      virtual bool fail()
+         { return output->fail(); }
+      virtual bool is_open()
+         { return output->is_open(); }
 
+      // Close the current block, the next data written starts a block at instruction number icount
+      void newBlock(uint64_t icount);
+      // Write the last block and the index, icount is the total number of instructions
+      void close(uint64_t icount);
+      uint64_t getBlockIcount() const { return block_icount; }
+};
 
 class vistream
 {
@@ -92,6 +181,69 @@ class vifstream : public vistream
       virtual bool fail() const { return stream->fail(); }
 };
 
+class imstream : public vistream
+{
+   private:
+      const char *data;
+      size_t size;
+      size_t offset;
+      bool m_fail;
+   public:
+      imstream(const void *data, size_t size)
+         : data(static_cast<const char*>(data)), size(size), offset(0), m_fail(false) {}
+      virtual void read(char* s, std::streamsize n)
+      {
+         if (offset + n > size)
+         {
+            n = size - offset;
+            m_fail = true;
+         }
+         memcpy(s, data + offset, n);
+         offset += n;
+      }
+      virtual int peek()
+         { return offset < size ? (unsigned char)data[offset] : EOF; }
+      virtual bool fail() const { return m_fail; }
+};
+
+// Reads the SeekableBlocks container (see sift_format.h) through a read-only memory mapping of the file.
+// Uncompressed blocks are read in place, compressed blocks are inflated one at a time.
+class iblockstream : public vistream
+{
+   private:
+      uint64_t codec;
+      const char *data;
+      uint64_t length;
+      const Sift::BlockIndexEntry *index;
+      uint64_t num_blocks;
+      uint64_t icount;
+      uint64_t block;
+      const char *block_data;
+      uint32_t block_size;
+      uint32_t block_offset;
+      uint64_t generation;
+      std::vector<char> buffer;
+      bool m_fail;
+      bool loadBlock(uint64_t block);
+   public:
+      iblockstream(const char *filename, uint64_t codec);
+      virtual ~iblockstream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek();
+      virtual bool fail() const { return m_fail; }
+
+      uint64_t getNumBlocks() const { return num_blocks; }
+      uint64_t getIcount() const { return icount; }
+      uint64_t getBlockIcount(uint64_t b) const { return index[b].icount; }
+      // Last block that starts at or before instruction number icount
+      uint64_t findBlock(uint64_t icount) const;
+      bool seekBlock(uint64_t b);
+      // File offset of the current block
+      uint64_t getPosition() const { return block < num_blocks ? index[block].offset : length; }
+      // Changes every time a block is entered, either sequentially or through seekBlock()
+      uint64_t getGeneration() const { return generation; }
+};
+
 class izstream : public vistream
 {
    private:
@@ -114,4 +266,50 @@ class izstream : public vistream
       virtual bool fail() const { return m_fail; }
 };
 
+class ilz4stream : public vistream
+{
+   private:
+      vistream *input;
+      bool m_eof;
+      bool m_fail;
+#if SIFT_USE_LZ4
+      LZ4F_dctx *dctx;
+#endif
+      static const size_t chunksize = 64*1024;
+      char buffer[chunksize];
+      size_t in_pos, in_size;
+      char peek_value;
+      bool peek_valid;
+   public:
+      ilz4stream(vistream *input);
+      virtual ~ilz4stream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek();
+      virtual bool eof() const { return m_eof; }
+      virtual bool fail() const { return m_fail; }
+};
+
+class izstdstream : public vistream
+{
+   private:
+      vistream *input;
+      bool m_eof;
+      bool m_fail;
+#if SIFT_USE_ZSTD
+      ZSTD_DCtx *dctx;
+#endif
+      static const size_t chunksize = 64*1024;
+      char buffer[chunksize];
+      size_t in_pos, in_size;
+      char peek_value;
+      bool peek_valid;
+   public:
+      izstdstream(vistream *input);
+      virtual ~izstdstream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek();
+      virtual bool eof() const { return m_eof; }
+      virtual bool fail() const { return m_fail; }
+};
+
 #endif // __ZFSTREAM_H
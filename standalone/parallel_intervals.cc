@@ -0,0 +1,326 @@
+#include "parallel_intervals.h"
+#include "config_file.hpp"
+#include "itostr.h"
+#include "sift_reader.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <fcntl.h>
+#include <sqlite3.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+// Statistics snapshots that are merged, as (begin, end) pairs: the merged end snapshot is the
+// first worker's begin snapshot plus the sum of the end - begin differences of all workers
+static const char* merge_prefixes[][2] = {
+   { "start", "stop" },
+   { "roi-begin", "roi-end" },
+};
+
+// Tables of sim.stats.sqlite3 that mergeStats knows how to combine: the statistics are merged, the topology is
+// the same for all workers and kept from the first one, and events are dropped as their times are per interval.
+// Any other table (such as pimcandidates) holds results of a single run that cannot be added up.
+static const char* merge_tables[] = { "names", "prefixes", "values", "topology", "event" };
+
+ParallelIntervals::ParallelIntervals(config::ConfigFile *cfg)
+   : m_cfg(cfg)
+   , m_output_dir(cfg->getString("general/output_dir"))
+   , m_num_workers(cfg->getInt("traceinput/parallel_workers"))
+{
+   if (m_num_workers <= 0)
+      m_num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+bool ParallelIntervals::split()
+{
+   if (!m_cfg->getBool("traceinput/enabled") || m_cfg->getString("traceinput/trace_prefix") != "")
+   {
+      fprintf(stderr, "[SNIPER] Parallel intervals require trace files as input\n");
+      return false;
+   }
+   if (m_cfg->getInt("traceinput/num_apps") != 1 || m_cfg->getInt("traceinput/num_runs") != 1)
+   {
+      fprintf(stderr, "[SNIPER] Parallel intervals require a single application and a single run\n");
+      return false;
+   }
+
+   String tracefile = m_cfg->getString("traceinput/thread_0");
+   Sift::Reader reader(tracefile.c_str());
+   if (!reader.initStream() || !reader.isSeekable())
+   {
+      fprintf(stderr, "[SNIPER] Parallel intervals require a seekable trace (recorded with -blocks), %s is not\n", tracefile.c_str());
+      return false;
+   }
+
+   UInt64 num_instructions = reader.getNumInstructions();
+   UInt64 num_intervals = m_cfg->getInt("traceinput/parallel_intervals");
+   UInt64 warmup = m_cfg->getInt("traceinput/parallel_warmup");
+
+   for(UInt64 i = 0; i < num_intervals; ++i)
+   {
+      Interval interval;
+      interval.begin = num_instructions * i / num_intervals;
+      interval.end = num_instructions * (i + 1) / num_intervals;
+      interval.warmup = interval.begin > warmup ? interval.begin - warmup : 0;
+      interval.output_dir = m_output_dir + "/interval-" + itostr(i);
+      interval.pid = 0;
+      if (interval.end > interval.begin)
+         m_intervals.push_back(interval);
+   }
+
+   printf("[SNIPER] Simulating %lu instructions as %lu intervals using %d workers\n", num_instructions, m_intervals.size(), m_num_workers);
+   return !m_intervals.empty();
+}
+
+int ParallelIntervals::startWorker(Interval &interval)
+{
+   mkdir(interval.output_dir.c_str(), 0777);
+
+   fflush(NULL);
+   int pid = fork();
+   if (pid != 0)
+      return pid;
+
+   // Worker: write everything into its own output directory
+   String logfile = interval.output_dir + "/sim.log";
+   int fd = open(logfile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+   if (fd >= 0)
+   {
+      dup2(fd, STDOUT_FILENO);
+      dup2(fd, STDERR_FILENO);
+      close(fd);
+   }
+
+   m_cfg->set("general/output_dir", interval.output_dir);
+   m_cfg->set("traceinput/start_instruction", (SInt64)interval.warmup);
+   m_cfg->set("traceinput/stop_instruction", (SInt64)interval.end);
+   if (interval.begin > interval.warmup)
+   {
+      // Warm up in inst_mode_init, the trace thread starts the ROI when it reaches the interval.
+      // ROI markers in the trace belong to the application, ignore them.
+      m_cfg->set("general/roi_script", "true");
+      m_cfg->set("traceinput/roi_begin_instruction", (SInt64)interval.begin);
+   }
+   else
+   {
+      m_cfg->set("general/roi_script", "false");
+      m_cfg->set("general/magic", "false");
+      m_cfg->set("traceinput/roi_begin_instruction", (SInt64)0);
+   }
+   m_cfg->set("traceinput/parallel_intervals", (SInt64)0);
+
+   return 0;
+}
+
+bool ParallelIntervals::run(bool &success)
+{
+   success = split();
+   if (!success)
+      return true;
+
+   int running = 0;
+   std::vector<Interval>::iterator next = m_intervals.begin();
+   while(next != m_intervals.end() || running)
+   {
+      if (next != m_intervals.end() && running < m_num_workers)
+      {
+         next->pid = startWorker(*next);
+         if (next->pid == 0)
+            return false;
+         if (next->pid < 0)
+         {
+            perror("[SNIPER] Cannot start worker");
+            success = false;
+            next->pid = 0;
+         }
+         else
+            ++running;
+         ++next;
+         continue;
+      }
+
+      int status;
+      int pid = wait(&status);
+      if (pid < 0)
+         break;
+      --running;
+      for(std::vector<Interval>::iterator it = m_intervals.begin(); it != m_intervals.end(); ++it)
+      {
+         if (it->pid != pid)
+            continue;
+         if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+            printf("[SNIPER] Interval %lu-%lu done\n", it->begin, it->end);
+         else
+         {
+            fprintf(stderr, "[SNIPER] Interval %lu-%lu failed, see %s/sim.log\n", it->begin, it->end, it->output_dir.c_str());
+            success = false;
+         }
+      }
+   }
+
+   if (success)
+      success = mergeStats();
+   return true;
+}
+
+bool ParallelIntervals::mergeStats()
+{
+   typedef std::pair<String, String> Name;
+   typedef std::pair<int, int> Key;  // (merged nameid, core)
+   typedef std::map<Key, SInt64> Values;
+
+   std::map<Name, int> names;
+   std::map<String, Values> merged;
+
+   for(std::vector<Interval>::iterator it = m_intervals.begin(); it != m_intervals.end(); ++it)
+   {
+      String filename = it->output_dir + "/sim.stats.sqlite3";
+      sqlite3 *db;
+      if (sqlite3_open_v2(filename.c_str(), &db, SQLITE_OPEN_READONLY, NULL) != SQLITE_OK)
+      {
+         fprintf(stderr, "[SNIPER] Cannot open %s\n", filename.c_str());
+         sqlite3_close(db);
+         return false;
+      }
+
+      sqlite3_stmt *stmt;
+      sqlite3_prepare_v2(db, "SELECT name FROM `sqlite_master` WHERE type = 'table';", -1, &stmt, NULL);
+      while(sqlite3_step(stmt) == SQLITE_ROW)
+      {
+         String table = (const char*)sqlite3_column_text(stmt, 0);
+         bool known = false;
+         for(unsigned int t = 0; t < sizeof(merge_tables) / sizeof(merge_tables[0]); ++t)
+            if (table == merge_tables[t])
+               known = true;
+         if (known)
+            continue;
+
+         sqlite3_stmt *stmt_count;
+         sqlite3_prepare_v2(db, ("SELECT COUNT(*) FROM `" + table + "`;").c_str(), -1, &stmt_count, NULL);
+         bool empty = sqlite3_step(stmt_count) != SQLITE_ROW || sqlite3_column_int64(stmt_count, 0) == 0;
+         sqlite3_finalize(stmt_count);
+         if (!empty)
+         {
+            fprintf(stderr, "[SNIPER] Cannot merge table %s of %s, it only describes that interval. See the output of each interval instead\n", table.c_str(), filename.c_str());
+            sqlite3_finalize(stmt);
+            sqlite3_close(db);
+            return false;
+         }
+      }
+      sqlite3_finalize(stmt);
+
+      std::map<int, int> nameids;
+      sqlite3_prepare_v2(db, "SELECT nameid, objectname, metricname FROM `names`;", -1, &stmt, NULL);
+      while(sqlite3_step(stmt) == SQLITE_ROW)
+      {
+         Name name((const char*)sqlite3_column_text(stmt, 1), (const char*)sqlite3_column_text(stmt, 2));
+         if (names.count(name) == 0)
+         {
+            int nameid = names.size() + 1;
+            names[name] = nameid;
+         }
+         nameids[sqlite3_column_int(stmt, 0)] = names[name];
+      }
+      sqlite3_finalize(stmt);
+
+      std::map<String, Values> values;
+      sqlite3_prepare_v2(db, "SELECT prefixname, nameid, core, value FROM `values` JOIN `prefixes` USING (prefixid);", -1, &stmt, NULL);
+      while(sqlite3_step(stmt) == SQLITE_ROW)
+      {
+         String prefix = (const char*)sqlite3_column_text(stmt, 0);
+         values[prefix][Key(nameids[sqlite3_column_int(stmt, 1)], sqlite3_column_int(stmt, 2))] = sqlite3_column_int64(stmt, 3);
+      }
+      sqlite3_finalize(stmt);
+      sqlite3_close(db);
+
+      for(unsigned int p = 0; p < sizeof(merge_prefixes) / sizeof(merge_prefixes[0]); ++p)
+      {
+         const char *begin = merge_prefixes[p][0], *end = merge_prefixes[p][1];
+         if (values.count(begin) == 0 || values.count(end) == 0)
+            continue;
+         if (merged.count(begin) == 0)
+         {
+            merged[begin] = values[begin];
+            merged[end] = values[begin];
+         }
+         for(Values::iterator vit = values[end].begin(); vit != values[end].end(); ++vit)
+            merged[end][vit->first] += vit->second - values[begin][vit->first];
+      }
+   }
+
+   // Start from the first worker's database for the schema and topology, and replace its statistics
+   String filename = m_output_dir + "/sim.stats.sqlite3";
+   {
+      std::ifstream src((m_intervals[0].output_dir + "/sim.stats.sqlite3").c_str(), std::ios::binary);
+      std::ofstream dst(filename.c_str(), std::ios::binary | std::ios::trunc);
+      dst << src.rdbuf();
+   }
+
+   sqlite3 *db;
+   if (sqlite3_open(filename.c_str(), &db) != SQLITE_OK)
+   {
+      fprintf(stderr, "[SNIPER] Cannot create %s\n", filename.c_str());
+      sqlite3_close(db);
+      return false;
+   }
+   sqlite3_exec(db, "PRAGMA synchronous = OFF", NULL, NULL, NULL);
+   sqlite3_exec(db, "BEGIN TRANSACTION", NULL, NULL, NULL);
+   sqlite3_exec(db, "DELETE FROM `names`; DELETE FROM `prefixes`; DELETE FROM `values`; DELETE FROM `event`;", NULL, NULL, NULL);
+
+   sqlite3_stmt *stmt;
+   sqlite3_prepare_v2(db, "INSERT INTO `names` (nameid, objectname, metricname) VALUES (?, ?, ?);", -1, &stmt, NULL);
+   for(std::map<Name, int>::iterator it = names.begin(); it != names.end(); ++it)
+   {
+      sqlite3_reset(stmt);
+      sqlite3_bind_int(stmt, 1, it->second);
+      sqlite3_bind_text(stmt, 2, it->first.first.c_str(), -1, SQLITE_TRANSIENT);
+      sqlite3_bind_text(stmt, 3, it->first.second.c_str(), -1, SQLITE_TRANSIENT);
+      sqlite3_step(stmt);
+   }
+   sqlite3_finalize(stmt);
+
+   // Keep the order in which a single simulation would have recorded the snapshots
+   const char *order[] = { "start", "roi-begin", "roi-end", "stop" };
+   sqlite3_stmt *stmt_prefix, *stmt_value;
+   sqlite3_prepare_v2(db, "INSERT INTO `prefixes` (prefixid, prefixname) VALUES (?, ?);", -1, &stmt_prefix, NULL);
+   sqlite3_prepare_v2(db, "INSERT INTO `values` (prefixid, nameid, core, value) VALUES (?, ?, ?, ?);", -1, &stmt_value, NULL);
+   int prefixid = 0;
+   for(unsigned int p = 0; p < sizeof(order) / sizeof(order[0]); ++p)
+   {
+      if (merged.count(order[p]) == 0)
+         continue;
+      ++prefixid;
+      sqlite3_reset(stmt_prefix);
+      sqlite3_bind_int(stmt_prefix, 1, prefixid);
+      sqlite3_bind_text(stmt_prefix, 2, order[p], -1, SQLITE_STATIC);
+      sqlite3_step(stmt_prefix);
+      Values &values = merged[order[p]];
+      for(Values::iterator it = values.begin(); it != values.end(); ++it)
+      {
+         sqlite3_reset(stmt_value);
+         sqlite3_bind_int(stmt_value, 1, prefixid);
+         sqlite3_bind_int(stmt_value, 2, it->first.first);
+         sqlite3_bind_int(stmt_value, 3, it->first.second);
+         sqlite3_bind_int64(stmt_value, 4, it->second);
+         sqlite3_step(stmt_value);
+      }
+   }
+   sqlite3_finalize(stmt_prefix);
+   sqlite3_finalize(stmt_value);
+
+   int res = sqlite3_exec(db, "END TRANSACTION", NULL, NULL, NULL);
+   sqlite3_close(db);
+   if (res != SQLITE_OK)
+   {
+      fprintf(stderr, "[SNIPER] Cannot write %s\n", filename.c_str());
+      return false;
+   }
+
+   // Keep a copy of the configuration for reference, as a regular simulation would
+   m_cfg->saveAs(m_output_dir + "/sim.cfg");
+
+   printf("[SNIPER] Merged statistics of %lu intervals into %s\n", m_intervals.size(), filename.c_str());
+   return true;
+}
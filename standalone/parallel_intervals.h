@@ -0,0 +1,49 @@
+#ifndef __PARALLEL_INTERVALS_H
+#define __PARALLEL_INTERVALS_H
+
+#include "fixed_types.h"
+
+#include <vector>
+
+namespace config { class ConfigFile; }
+
+// Parallel-in-time simulation of a single seekable trace (traceinput/parallel_intervals).
+//
+// The trace is split into equally sized intervals, each simulated by a forked copy of this process.
+// A worker starts traceinput/parallel_warmup instructions before its interval in inst_mode_init
+// (cache-only by default) to warm up caches and predictors, simulates the interval itself as its ROI,
+// and writes its output into interval-<n>/ below the output directory. Once all workers are done,
+// their statistics are merged into a single sim.stats.sqlite3 so that roi-end minus roi-begin
+// (and stop minus start) is the sum over all intervals.
+class ParallelIntervals
+{
+   private:
+      struct Interval
+      {
+         UInt64 warmup;
+         UInt64 begin;
+         UInt64 end;
+         String output_dir;
+         int pid;
+      };
+
+      config::ConfigFile *m_cfg;
+      String m_output_dir;
+      std::vector<Interval> m_intervals;
+      int m_num_workers;
+
+      bool split();
+      int startWorker(Interval &interval);
+      // Merge the statistics of all workers into the output directory's sim.stats.sqlite3
+      bool mergeStats();
+
+   public:
+      ParallelIntervals(config::ConfigFile *cfg);
+
+      // Simulate all intervals. Returns true in the parent once all workers have completed (success is
+      // set to whether they all succeeded), and false in a forked worker, whose configuration has been
+      // updated to simulate its interval and which should continue with a normal simulation run.
+      bool run(bool &success);
+};
+
+#endif // __PARALLEL_INTERVALS_H
@@ -6,6 +6,7 @@
 #include "logmem.h"
 #include "exceptions.h"
 #include "sim_api.h"
+#include "parallel_intervals.h"
 
 int main(int argc, char* argv[])
 {
@@ -36,6 +37,19 @@ int main(int argc, char* argv[])
 
    handle_args(args, *cfg);
 
+   if (cfg->getInt("traceinput/parallel_intervals") > 1)
+   {
+      // Simulate the trace as a number of intervals in parallel worker processes.
+      // Workers return here to simulate their interval, the parent is done once all workers are.
+      ParallelIntervals parallel(cfg);
+      bool success;
+      if (parallel.run(success))
+      {
+         delete cfg;
+         return success ? 0 : 1;
+      }
+   }
+
    Simulator::setConfig(cfg, Config::STANDALONE);
 
    Simulator::allocate();
@@ -0,0 +1,32 @@
+#!/usr/bin/env python
+
+# Compare the cycle counts and ROB statistics of two runs, exit with an error unless they are identical
+
+import sys, os
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'tools'))
+import sniper_lib
+
+METRICS = ('performance_model.cycle_count', 'performance_model.elapsed_time', 'performance_model.instruction_count')
+
+def get_stats(resultsdir):
+  results = sniper_lib.get_results(resultsdir = resultsdir)['results']
+  return dict((key, value) for key, value in results.items() if key in METRICS or key.startswith('rob_timer.'))
+
+if len(sys.argv) != 3:
+  print >> sys.stderr, 'Usage: %s <resultsdir> <resultsdir>' % sys.argv[0]
+  sys.exit(2)
+
+stats_a, stats_b = get_stats(sys.argv[1]), get_stats(sys.argv[2])
+mismatches = 0
+for key in sorted(set(stats_a) | set(stats_b)):
+  if stats_a.get(key) != stats_b.get(key):
+    print '%s: %s = %s, %s = %s' % (key, sys.argv[1], stats_a.get(key), sys.argv[2], stats_b.get(key))
+    mismatches += 1
+
+if 'performance_model.cycle_count' not in stats_a:
+  print >> sys.stderr, 'No cycle counts found in %s' % sys.argv[1]
+  sys.exit(1)
+if mismatches:
+  print >> sys.stderr, '%d statistics differ' % mismatches
+  sys.exit(1)
+print 'Cycle counts match: %s' % ', '.join('%d' % c for c in stats_a['performance_model.cycle_count'])
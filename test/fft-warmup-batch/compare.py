@@ -0,0 +1,30 @@
+#!/usr/bin/env python
+
+# Compare a per-access and a batched cache-only warmup run: their L1-D statistics must be identical,
+# report the simulation speed of both
+
+import sys, os
+sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'tools'))
+import sniper_lib
+
+METRICS = ('L1-D.loads', 'L1-D.stores', 'L1-D.load-misses', 'L1-D.store-misses', 'core.instructions')
+
+if len(sys.argv) != 3:
+  print >> sys.stderr, 'Usage: %s <single resultsdir> <batch resultsdir>' % sys.argv[0]
+  sys.exit(2)
+
+results = [ sniper_lib.get_results(resultsdir = resultsdir)['results'] for resultsdir in sys.argv[1:] ]
+
+mismatches = 0
+for key in METRICS:
+  if results[0].get(key) != results[1].get(key):
+    print '%s: %s = %s, %s = %s' % (key, sys.argv[1], results[0].get(key), sys.argv[2], results[1].get(key))
+    mismatches += 1
+
+for resultsdir, res in zip(sys.argv[1:], results):
+  print '%-16s %12d instructions %8.2f s %10.2f MIPS' % (resultsdir, res['roi.instrs'], res['roi.walltime'], res['roi.ipstotal'] / 1e6)
+print 'Batched warmup speedup: %.2fx' % (results[1]['roi.ipstotal'] / results[0]['roi.ipstotal'])
+
+if mismatches:
+  print >> sys.stderr, '%d statistics differ' % mismatches
+  sys.exit(1)
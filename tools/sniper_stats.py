@@ -52,6 +52,9 @@ def SniperStats(resultsdir = '.', jobid = None):
   if jobid:
     import sniper_stats_jobid
     stats = sniper_stats_jobid.SniperStatsJobid(jobid)
+  elif os.path.exists(os.path.join(resultsdir, 'sim.stats.bin')):
+    import sniper_stats_columnar
+    stats = sniper_stats_columnar.SniperStatsColumnar(os.path.join(resultsdir, 'sim.stats.bin'), os.path.join(resultsdir, 'sim.stats.sqlite3'))
   elif os.path.exists(os.path.join(resultsdir, 'sim.stats.sqlite3')):
     import sniper_stats_sqlite
     stats = sniper_stats_sqlite.SniperStatsSqlite(os.path.join(resultsdir, 'sim.stats.sqlite3'))
@@ -0,0 +1,68 @@
+import os, struct, sniper_stats_sqlite
+
+# Reads statistics snapshots directly from sim.stats.bin (general/stats_format = columnar).
+# Metric names, snapshot names, topology and events still come from sim.stats.sqlite3.
+# Layout written by StatsManager (common/misc/stats.cc), all fields little-endian:
+#   uint64 magic
+#   records of  uint32 type = 1 (layout), uint32 count, count * (uint32 nameid, int32 index, uint32 flags)
+#          or   uint32 type = 2 (snapshot), uint32 prefixid, uint32 count, count * uint64 value
+
+COLUMNAR_MAGIC = 0x5354415453525053
+COLUMNAR_LAYOUT, COLUMNAR_SNAPSHOT = 1, 2
+COLUMNAR_ZERO_IS_DEFAULT = 1 # Flag: a zero value is the metric's default, and isn't stored in the sqlite format
+
+class SniperStatsColumnar(sniper_stats_sqlite.SniperStatsSqlite):
+  def __init__(self, filename = 'sim.stats.bin', dbfilename = 'sim.stats.sqlite3'):
+    sniper_stats_sqlite.SniperStatsSqlite.__init__(self, dbfilename)
+    self.snapshots = self.read_index(filename)
+
+  def read_index(self, filename):
+    # Map each prefixid to its layout and the file offset of its values, values are only read when needed
+    self.data = open(filename, 'rb').read()
+    magic, = struct.unpack_from('<Q', self.data, 0)
+    if magic != COLUMNAR_MAGIC:
+      raise ValueError('%s is not a statistics file' % filename)
+    snapshots = {}
+    layout = []
+    offset = 8
+    while offset + 8 <= len(self.data):
+      rtype, arg = struct.unpack_from('<II', self.data, offset)
+      offset += 8
+      if rtype == COLUMNAR_LAYOUT:
+        entries = struct.unpack_from('<' + 'IiI' * arg, self.data, offset)
+        layout = zip(entries[0::3], entries[1::3], entries[2::3])
+        offset += 12 * arg
+      elif rtype == COLUMNAR_SNAPSHOT:
+        count, = struct.unpack_from('<I', self.data, offset)
+        offset += 4
+        if offset + 8 * count > len(self.data):
+          break # Incomplete last snapshot
+        snapshots[arg] = (layout, offset, count)
+        offset += 8 * count
+      else:
+        raise ValueError('Invalid record type %d in %s' % (rtype, filename))
+    return snapshots
+
+  def read_snapshot(self, prefix, metrics = None):
+    c = self.db.cursor()
+    c.execute('select prefixid from `prefixes` where prefixname = ?', (prefix,))
+    prefixids = list(c)
+    if not prefixids or prefixids[0][0] not in self.snapshots:
+      raise ValueError('Invalid prefix %s' % prefix)
+    layout, offset, count = self.snapshots[prefixids[0][0]]
+    if metrics:
+      nameids = set([ nameid for nameid, (objectname, metricname) in self.names.items() if '%s.%s' % (objectname, metricname) in metrics ])
+    values = {}
+    for (nameid, core, flags), value in zip(layout, struct.unpack_from('<%dQ' % count, self.data, offset)):
+      if metrics and nameid not in nameids:
+        continue
+      if value == 0 and flags & COLUMNAR_ZERO_IS_DEFAULT:
+        continue
+      if nameid not in values: values[nameid] = {}
+      values[nameid][core] = value
+    return values
+
+if __name__ == '__main__':
+  stats = SniperStatsColumnar()
+  print stats.get_snapshots()
+  print stats.read_snapshot('roi-end')